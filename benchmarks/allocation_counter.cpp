@@ -0,0 +1,84 @@
+﻿#include "allocation_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+std::atomic<std::size_t> s_allocations(0);
+std::atomic<std::size_t> s_allocatedBytes(0);
+
+void* countedAllocate(std::size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+AllocationCounter::AllocationCounter() noexcept
+    : m_allocations(allocations())
+    , m_allocatedBytes(allocatedBytes())
+{
+}
+
+void AllocationCounter::report(benchmark::State& state, std::size_t operationsPerIteration) const
+{
+    const double operations = static_cast<double>(state.iterations()) * static_cast<double>(operationsPerIteration);
+
+    if (operations == 0)
+    {
+        return;
+    }
+
+    state.counters["allocs/op"] = static_cast<double>(allocations() - m_allocations) / operations;
+    state.counters["alloc_bytes/op"] = static_cast<double>(allocatedBytes() - m_allocatedBytes) / operations;
+}
+
+std::size_t AllocationCounter::allocations() noexcept
+{
+    return s_allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocationCounter::allocatedBytes() noexcept
+{
+    return s_allocatedBytes.load(std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+﻿#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+//! Counts the heap allocations made by the whole process through the replaced global operator new.
+//! Create it right before the benchmark loop and call report after it
+//! to get the allocations and the allocated bytes per operation.
+class AllocationCounter final
+{
+public:
+    AllocationCounter() noexcept;
+
+    //! adds "allocs/op" and "alloc_bytes/op" counters, one operation is one loop iteration by default
+    void report(benchmark::State& state, std::size_t operationsPerIteration = 1) const;
+
+    static std::size_t allocations() noexcept;
+    static std::size_t allocatedBytes() noexcept;
+
+private:
+    std::size_t m_allocations;
+    std::size_t m_allocatedBytes;
+};
\ No newline at end of file
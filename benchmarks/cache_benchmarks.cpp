@@ -0,0 +1,85 @@
+﻿#include <benchmark/benchmark.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "robots_txt_cache.h"
+#include "well_known_user_agent.h"
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+constexpr int s_hostCount = 10000;
+
+const std::vector<std::string>& origins()
+{
+    static const std::vector<std::string> s_origins = []
+    {
+        std::vector<std::string> result;
+
+        for (int i = 0; i < s_hostCount; ++i)
+        {
+            result.push_back("https://host" + std::to_string(i) + ".example.com:443");
+        }
+
+        return result;
+    }();
+
+    return s_origins;
+}
+
+RobotsTxtCache& filledCache()
+{
+    static RobotsTxtCache s_cache = []
+    {
+        RobotsTxtCache cache;
+
+        for (const std::string& origin : origins())
+        {
+            cache.insert(origin, "User-agent: *\nDisallow: /private\nAllow: /private/public\n");
+        }
+
+        return cache;
+    }();
+
+    return s_cache;
+}
+
+}
+
+static void BM_CacheFind(benchmark::State& state)
+{
+    const RobotsTxtCache& cache = filledCache();
+    const std::vector<std::string>& hosts = origins();
+    std::size_t index = static_cast<std::size_t>(state.thread_index()) * 7919;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cache.find(hosts[index++ % hosts.size()]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CacheFind)->ThreadRange(1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))->UseRealTime();
+
+static void BM_CacheFindAndCheck(benchmark::State& state)
+{
+    const RobotsTxtCache& cache = filledCache();
+    const std::vector<std::string>& hosts = origins();
+    std::size_t index = static_cast<std::size_t>(state.thread_index()) * 7919;
+
+    for (auto _ : state)
+    {
+        const RobotsTxtCache::RulesPointer rules = cache.find(hosts[index++ % hosts.size()]);
+        benchmark::DoNotOptimize(rules->isPathAllowed("/private/page.html", WellKnownUserAgent::GoogleBot));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CacheFindAndCheck)->ThreadRange(1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))->UseRealTime();
\ No newline at end of file
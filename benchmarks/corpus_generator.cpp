@@ -0,0 +1,160 @@
+﻿#include "corpus_generator.h"
+
+CorpusGenerator::CorpusGenerator(std::uint32_t seed)
+    : m_random(seed)
+{
+    const char* const syllables[] = { "ka", "ro", "bo", "te", "xt", "pa", "ge", "li", "st", "mu", "de", "on" };
+
+    for (const char* first : syllables)
+    {
+        for (const char* second : syllables)
+        {
+            m_words.push_back(std::string(first) + second);
+        }
+    }
+}
+
+std::string CorpusGenerator::robotsTxt(std::size_t ruleCount, RuleKind kind)
+{
+    std::string result = "# synthetic robots.txt\nSitemap: https://www.example.com/sitemap.xml\n\n";
+    const std::size_t googleRuleCount = ruleCount / 4;
+
+    result += "User-agent: *\nCrawl-delay: 1.5\n";
+
+    for (std::size_t i = 0; i < ruleCount - googleRuleCount; ++i)
+    {
+        result += (random(4) == 0 ? "Allow: " : "Disallow: ") + rule(kind);
+        result += random(8) == 0 ? " # commentary\n" : "\n";
+    }
+
+    result += "\nUser-agent: Googlebot\nClean-param: ref /" + word() + "/\r\n";
+
+    for (std::size_t i = 0; i < googleRuleCount; ++i)
+    {
+        result += (random(4) == 0 ? "Allow: " : "Disallow: ") + rule(kind) + "\r\n";
+    }
+
+    return result;
+}
+
+std::vector<std::string> CorpusGenerator::paths(std::size_t count)
+{
+    const char* const extensions[] = { "", ".html", ".php", ".jpg", "/" };
+    std::vector<std::string> result;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::string path;
+        const std::size_t depth = 1 + random(4);
+
+        for (std::size_t level = 0; level < depth; ++level)
+        {
+            path += '/';
+            path += word();
+        }
+
+        path += extensions[random(5)];
+
+        if (random(3) == 0)
+        {
+            path += '?' + word() + '=' + std::to_string(random(100));
+        }
+
+        result.push_back(std::move(path));
+    }
+
+    return result;
+}
+
+std::string CorpusGenerator::adversarialRobotsTxt(AdversarialKind kind)
+{
+    std::string result = "User-agent: *\n";
+
+    // several rules of growing size, every position of the path is a candidate for each of them
+    // and the candidate fails only in the middle of the rule
+    for (std::size_t size = 16; size <= 1024; size *= 4)
+    {
+        result += "Disallow: /*";
+
+        switch (kind)
+        {
+            case AdversarialKind::ManyWildcards:
+            {
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    result += "a*";
+                }
+
+                result += "b$";
+                break;
+            }
+            case AdversarialKind::LongNearMiss:
+            {
+                result += std::string(size / 2, 'a') + 'b' + std::string(size / 2, 'a');
+                break;
+            }
+            default:
+            {
+                std::string half;
+
+                for (std::size_t i = 0; i < size / 4; ++i)
+                {
+                    half += "ab";
+                }
+
+                result += half + "cb" + half;
+                break;
+            }
+        }
+
+        result += '\n';
+    }
+
+    return result;
+}
+
+std::string CorpusGenerator::adversarialPath(std::size_t length, AdversarialKind kind)
+{
+    std::string result = "/";
+
+    while (result.size() < length)
+    {
+        result += kind == AdversarialKind::Periodic && result.size() % 2 == 0 ? 'b' : 'a';
+    }
+
+    return result;
+}
+
+const std::string& CorpusGenerator::word()
+{
+    return m_words[random(m_words.size())];
+}
+
+std::string CorpusGenerator::rule(RuleKind kind)
+{
+    if (kind == RuleKind::Mixed)
+    {
+        kind = static_cast<RuleKind>(random(3));
+    }
+
+    switch (kind)
+    {
+        case RuleKind::Literal:
+        {
+            return '/' + word() + (random(2) ? '/' + word() + '/' : std::string());
+        }
+        case RuleKind::Wildcard:
+        {
+            return random(2) ? '/' + word() + "/*/" + word() : "/*" + word() + "*?" + word() + '=';
+        }
+        default:
+        {
+            return '/' + word() + "/*." + (random(2) ? "html" : "php") + '$';
+        }
+    }
+}
+
+std::size_t CorpusGenerator::random(std::size_t bound)
+{
+    return static_cast<std::size_t>(m_random()) % bound;
+}
\ No newline at end of file
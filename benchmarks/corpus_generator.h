@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+//! Deterministic generator of synthetic robots.txt files and URL paths.
+//! The same seed produces the same corpus on every platform: only the raw std::mt19937 output is used.
+//! Rules and paths are built from one small vocabulary, so a good share of the paths is matched by the rules.
+class CorpusGenerator final
+{
+public:
+    enum class RuleKind
+    {
+        Literal,     // /word/word/
+        Wildcard,    // /word/*/word or /*word*?word=
+        EndAnchored, // /word/*.word$
+        Mixed        // all of the above in equal shares
+    };
+
+    //! worst cases of the wildcard matching: every rule almost matches the adversarial paths
+    enum class AdversarialKind
+    {
+        ManyWildcards, // /*a*a*...*a*b$, exponential for the backtracking matchers
+        LongNearMiss,  // /*aaa...abaaa...a, quadratic for the substring search verifying every candidate
+        Periodic       // /*abab...cbabab...ab, the same with a periodic segment
+    };
+
+    explicit CorpusGenerator(std::uint32_t seed = 2018);
+
+    //! returns a robots.txt with a group for all robots and a group for Googlebot sharing ruleCount Allow/Disallow rules
+    //! Commentaries, empty rows, Crawl-delay, Clean-param and Sitemap directives are interleaved like in the real files
+    std::string robotsTxt(std::size_t ruleCount, RuleKind kind);
+
+    //! returns URL paths, some of them with a query
+    std::vector<std::string> paths(std::size_t count);
+
+    //! returns a robots.txt for all robots with the rules of the passed adversarial kind
+    static std::string adversarialRobotsTxt(AdversarialKind kind);
+
+    //! returns a path of the passed length which no rule of the adversarial robots.txt matches
+    static std::string adversarialPath(std::size_t length, AdversarialKind kind);
+
+private:
+    const std::string& word();
+    std::string rule(RuleKind kind);
+    std::size_t random(std::size_t bound);
+
+private:
+    std::mt19937 m_random;
+    std::vector<std::string> m_words;
+};
\ No newline at end of file
@@ -0,0 +1,476 @@
+﻿#include <benchmark/benchmark.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "allocation_counter.h"
+#include "corpus_generator.h"
+#include "meta_robots_helpers.h"
+#include "robots_txt_rules.h"
+#include "well_known_user_agent.h"
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+const std::string s_robotsTxt = R"(
+    User-agent: *
+    Disallow: /
+
+    User-agent: Googlebot
+    Disallow: /oembed
+    Disallow: /*/forks
+    Disallow: /*/*/issues/new
+    Disallow: /*/*/commits/*/*
+    Disallow: /*/*/commits/*?author
+    Disallow: /*/*/blob
+    Disallow: /search?q=*&page=
+    Disallow: /private
+    Allow: /private/public
+    Allow: /*/*/tree/master
+    Allow: /*/*/blob/master)";
+
+std::vector<std::string> makePaths()
+{
+    const std::vector<std::string> distinctPaths
+    {
+        "/",
+        "/index.php",
+        "/oembed/video",
+        "/user/repo/forks",
+        "/user/repo/issues/new",
+        "/user/repo/commits/master/file.cpp",
+        "/user/repo/commits/page.php?author=me",
+        "/user/repo/blob/master/readme.md",
+        "/user/repo/blob/develop/readme.md",
+        "/search?q=robots&page=2",
+        "/private/page.html",
+        "/private/public/page.html"
+    };
+
+    std::vector<std::string> paths;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        paths.insert(paths.end(), distinctPaths.begin(), distinctPaths.end());
+    }
+
+    return paths;
+}
+
+std::vector<std::string> makeUrls()
+{
+    std::vector<std::string> urls;
+
+    for (const std::string& path : makePaths())
+    {
+        urls.push_back("http://www.example.com" + path);
+    }
+
+    return urls;
+}
+
+}
+
+static void BM_IsUrlAllowedSingle(benchmark::State& state)
+{
+    const RobotsTxtRules rules(s_robotsTxt);
+    const std::vector<std::string> urls = makeUrls();
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& url : urls)
+        {
+            benchmark::DoNotOptimize(rules.isUrlAllowed(url, WellKnownUserAgent::GoogleBot));
+        }
+    }
+
+    allocationCounter.report(state, urls.size());
+    state.SetItemsProcessed(state.iterations() * urls.size());
+}
+
+BENCHMARK(BM_IsUrlAllowedSingle);
+
+static void BM_AreUrlsAllowedBatch(benchmark::State& state)
+{
+    const RobotsTxtRules rules(s_robotsTxt);
+    const std::vector<std::string> urls = makeUrls();
+    std::vector<bool> verdicts;
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        rules.areUrlsAllowed(urls, WellKnownUserAgent::GoogleBot, verdicts);
+        benchmark::ClobberMemory();
+    }
+
+    allocationCounter.report(state, urls.size());
+    state.SetItemsProcessed(state.iterations() * urls.size());
+}
+
+BENCHMARK(BM_AreUrlsAllowedBatch);
+
+static void BM_IsPathAllowedSingle(benchmark::State& state)
+{
+    const RobotsTxtRules rules(s_robotsTxt);
+    const std::vector<std::string> paths = makePaths();
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& path : paths)
+        {
+            benchmark::DoNotOptimize(rules.isPathAllowed(path, WellKnownUserAgent::GoogleBot));
+        }
+    }
+
+    allocationCounter.report(state, paths.size());
+    state.SetItemsProcessed(state.iterations() * paths.size());
+}
+
+BENCHMARK(BM_IsPathAllowedSingle);
+
+static void BM_ArePathsAllowedBatch(benchmark::State& state)
+{
+    const RobotsTxtRules rules(s_robotsTxt);
+    const std::vector<std::string> pathStorage = makePaths();
+    const std::vector<std::string_view> paths(pathStorage.begin(), pathStorage.end());
+    std::vector<bool> verdicts;
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        rules.arePathsAllowed(paths, WellKnownUserAgent::GoogleBot, verdicts);
+        benchmark::ClobberMemory();
+    }
+
+    allocationCounter.report(state, paths.size());
+    state.SetItemsProcessed(state.iterations() * paths.size());
+}
+
+BENCHMARK(BM_ArePathsAllowedBatch);
+
+static void BM_IsPathAllowedResolvedGroup(benchmark::State& state)
+{
+    const RobotsTxtRules rules(s_robotsTxt);
+    const UserAgentGroup group = rules.resolveGroup(WellKnownUserAgent::GoogleBot);
+    const std::vector<std::string> paths = makePaths();
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& path : paths)
+        {
+            benchmark::DoNotOptimize(rules.isPathAllowed(path, group));
+        }
+    }
+
+    allocationCounter.report(state, paths.size());
+    state.SetItemsProcessed(state.iterations() * paths.size());
+}
+
+BENCHMARK(BM_IsPathAllowedResolvedGroup);
+
+// the same checks with RobotsTxtMetrics enabled: the timestamps, the object counters and the striped global histograms
+static void BM_IsPathAllowedWithMetrics(benchmark::State& state)
+{
+    const RobotsTxtRules rules(s_robotsTxt);
+    const UserAgentGroup group = rules.resolveGroup(WellKnownUserAgent::GoogleBot);
+    const std::vector<std::string> paths = makePaths();
+
+    RobotsTxtMetrics::setEnabled(true);
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& path : paths)
+        {
+            benchmark::DoNotOptimize(rules.isPathAllowed(path, group));
+        }
+    }
+
+    allocationCounter.report(state, paths.size());
+    state.SetItemsProcessed(state.iterations() * paths.size());
+
+    RobotsTxtMetrics::setEnabled(false);
+    RobotsTxtMetrics::reset();
+}
+
+BENCHMARK(BM_IsPathAllowedWithMetrics);
+
+static void BM_IsPathAllowedManyLiteralRules(benchmark::State& state)
+{
+    std::string robotsTxt = "User-agent: *\n";
+
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        robotsTxt += "Disallow: /folder" + std::to_string(i) + "/\n";
+    }
+
+    const RobotsTxtRules rules(robotsTxt);
+    const UserAgentGroup group = rules.resolveGroup(WellKnownUserAgent::GoogleBot);
+    const std::vector<std::string> paths = makePaths();
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& path : paths)
+        {
+            benchmark::DoNotOptimize(rules.isPathAllowed(path, group));
+        }
+    }
+
+    allocationCounter.report(state, paths.size());
+    state.SetItemsProcessed(state.iterations() * paths.size());
+}
+
+BENCHMARK(BM_IsPathAllowedManyLiteralRules)->Range(8, 8 << 10);
+
+// the paths of a typical site mostly match no rule and are decided by the group prefilter,
+// the "*" group of s_robotsTxt disallows everything and is decided without looking at the rules at all
+static void BM_IsPathAllowedPrefiltered(benchmark::State& state)
+{
+    const RobotsTxtRules rules(
+        "User-agent: Yandex\n"
+        "Disallow: /wp-admin/\n"
+        "Allow: /wp-admin/admin-ajax.php\n"
+        "Disallow: /cgi-bin/\n"
+        "Disallow: /search\n"
+        "Disallow: /cart\n"
+        "Disallow: /checkout\n"
+        "Disallow: /account/\n"
+        "Disallow: /tag/*/feed\n"
+        "\n" + s_robotsTxt
+    );
+
+    const UserAgentGroup group = rules.resolveGroup(state.range(0) ? WellKnownUserAgent::AllRobots : WellKnownUserAgent::YandexBot);
+    const std::vector<std::string> paths = makePaths();
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& path : paths)
+        {
+            benchmark::DoNotOptimize(rules.isPathAllowed(path, group));
+        }
+    }
+
+    allocationCounter.report(state, paths.size());
+    state.SetItemsProcessed(state.iterations() * paths.size());
+}
+
+BENCHMARK(BM_IsPathAllowedPrefiltered)->Arg(0)->Arg(1);
+
+static void BM_IsUrlAllowedCorpus(benchmark::State& state, CorpusGenerator::RuleKind kind)
+{
+    CorpusGenerator generator;
+
+    const RobotsTxtRules rules(generator.robotsTxt(static_cast<std::size_t>(state.range(0)), kind));
+    std::vector<std::string> urls;
+
+    for (const std::string& path : generator.paths(256))
+    {
+        urls.push_back("https://www.example.com" + path);
+    }
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& url : urls)
+        {
+            benchmark::DoNotOptimize(rules.isUrlAllowed(url, WellKnownUserAgent::YandexBot));
+        }
+    }
+
+    allocationCounter.report(state, urls.size());
+    state.SetItemsProcessed(state.iterations() * urls.size());
+}
+
+BENCHMARK_CAPTURE(BM_IsUrlAllowedCorpus, Literal, CorpusGenerator::RuleKind::Literal)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK_CAPTURE(BM_IsUrlAllowedCorpus, Wildcard, CorpusGenerator::RuleKind::Wildcard)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK_CAPTURE(BM_IsUrlAllowedCorpus, EndAnchored, CorpusGenerator::RuleKind::EndAnchored)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK_CAPTURE(BM_IsUrlAllowedCorpus, Mixed, CorpusGenerator::RuleKind::Mixed)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_IsPathAllowedAdversarial(benchmark::State& state, CorpusGenerator::AdversarialKind kind)
+{
+    // the time per path must grow linearly with the path length: the bytes per second stay flat
+    const RobotsTxtRules rules(CorpusGenerator::adversarialRobotsTxt(kind));
+    const UserAgentGroup group = rules.resolveGroup(WellKnownUserAgent::GoogleBot);
+    const std::string path = CorpusGenerator::adversarialPath(static_cast<std::size_t>(state.range(0)), kind);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(rules.isPathAllowed(path, group));
+    }
+
+    state.SetBytesProcessed(state.iterations() * path.size());
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_IsPathAllowedAdversarial, ManyWildcards, CorpusGenerator::AdversarialKind::ManyWildcards)->RangeMultiplier(8)->Range(64, 256 << 10);
+BENCHMARK_CAPTURE(BM_IsPathAllowedAdversarial, LongNearMiss, CorpusGenerator::AdversarialKind::LongNearMiss)->RangeMultiplier(8)->Range(64, 256 << 10);
+BENCHMARK_CAPTURE(BM_IsPathAllowedAdversarial, Periodic, CorpusGenerator::AdversarialKind::Periodic)->RangeMultiplier(8)->Range(64, 256 << 10);
+
+namespace
+{
+
+// the sites often copy the same rules for several robots
+std::string makeSharedRulesRobotsTxt(std::size_t ruleCount)
+{
+    CorpusGenerator generator;
+    const std::string robotsTxt = generator.robotsTxt(ruleCount, CorpusGenerator::RuleKind::Mixed);
+    const std::string rules = robotsTxt.substr(robotsTxt.find("User-agent: *\n") + std::string("User-agent: *\n").size());
+
+    return robotsTxt + "\nUser-agent: Yandex\n" + rules + "\nUser-agent: msnbot\n" + rules;
+}
+
+std::vector<std::string> makeCorpusUrls()
+{
+    CorpusGenerator generator;
+    std::vector<std::string> urls;
+
+    for (const std::string& path : generator.paths(256))
+    {
+        urls.push_back("https://www.example.com" + path);
+    }
+
+    return urls;
+}
+
+}
+
+static void BM_IsUrlAllowedEveryUserAgent(benchmark::State& state)
+{
+    const RobotsTxtRules rules(makeSharedRulesRobotsTxt(static_cast<std::size_t>(state.range(0))));
+    const std::vector<WellKnownUserAgent> userAgents = MetaRobotsHelpers::wellKnownUserAgents();
+    const std::vector<std::string> urls = makeCorpusUrls();
+
+    for (auto _ : state)
+    {
+        for (const std::string& url : urls)
+        {
+            for (WellKnownUserAgent userAgent : userAgents)
+            {
+                benchmark::DoNotOptimize(rules.isUrlAllowed(url, userAgent));
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * urls.size());
+}
+
+BENCHMARK(BM_IsUrlAllowedEveryUserAgent)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_UrlVerdicts(benchmark::State& state)
+{
+    const RobotsTxtRules rules(makeSharedRulesRobotsTxt(static_cast<std::size_t>(state.range(0))));
+    const std::vector<std::string> urls = makeCorpusUrls();
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& url : urls)
+        {
+            benchmark::DoNotOptimize(rules.urlVerdicts(url));
+        }
+    }
+
+    allocationCounter.report(state, urls.size());
+    state.SetItemsProcessed(state.iterations() * urls.size());
+}
+
+BENCHMARK(BM_UrlVerdicts)->RangeMultiplier(10)->Range(10, 1000);
+
+static void BM_Canonicalize(benchmark::State& state)
+{
+    const RobotsTxtRules rules(R"(
+        User-agent: Yandex
+        Disallow: /private
+        Clean-param: ref /some_dir/get_book.pl
+        Clean-param: sid&sort /forum/*.php
+        Clean-param: utm_source&utm_medium&utm_campaign)");
+
+    const UserAgentGroup group = rules.resolveGroup(WellKnownUserAgent::YandexBot);
+
+    // half of the URLs have the ignored parameters
+    const std::vector<std::string> urls
+    {
+        "https://www.example.com/some_dir/get_book.pl?ref=site_1&book_id=123",
+        "https://www.example.com/some_dir/get_book.pl?book_id=123",
+        "https://www.example.com/forum/showthread.php?s=1&t=2&sid=3&sort=4",
+        "https://www.example.com/forum/showthread.php?t=2",
+        "https://www.example.com/catalog/page?utm_source=mail&utm_medium=email&id=7",
+        "https://www.example.com/catalog/page?id=7",
+        "https://www.example.com/",
+        "https://www.example.com/catalog/?page=2&utm_campaign=spring"
+    };
+
+    std::string buffer;
+    buffer.reserve(256);
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& url : urls)
+        {
+            benchmark::DoNotOptimize(rules.canonicalize(url, group, buffer));
+        }
+    }
+
+    allocationCounter.report(state, urls.size());
+    state.SetItemsProcessed(state.iterations() * urls.size());
+}
+
+BENCHMARK(BM_Canonicalize);
+
+static void BM_ResolveGroupFromHeader(benchmark::State& state)
+{
+    // the sites often list dozens of unwanted robots besides the well known ones
+    std::string robotsTxt = "User-agent: *\nDisallow: /private\n";
+
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        robotsTxt += "\nUser-agent: SomeBot" + std::to_string(i) + "\nDisallow: /\n";
+    }
+
+    robotsTxt += "\nUser-agent: OurBot\nDisallow: /search\n";
+
+    const RobotsTxtRules rules(robotsTxt);
+
+    const std::vector<std::string> headers
+    {
+        "Mozilla/5.0 (compatible; OurBot/2.1; +https://our.site/bot)",
+        "Mozilla/5.0 (compatible; Googlebot/2.1; +http://www.google.com/bot.html)",
+        "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36",
+        "SomeBot7/1.0"
+    };
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& header : headers)
+        {
+            benchmark::DoNotOptimize(rules.isPathAllowed("/search?q=1", rules.resolveGroupFromHeader(header)));
+        }
+    }
+
+    allocationCounter.report(state, headers.size());
+    state.SetItemsProcessed(state.iterations() * headers.size());
+}
+
+BENCHMARK(BM_ResolveGroupFromHeader)->Arg(0)->Arg(100)->Arg(10000);
\ No newline at end of file
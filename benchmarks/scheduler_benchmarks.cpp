@@ -0,0 +1,51 @@
+﻿#include <benchmark/benchmark.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "politeness_scheduler.h"
+
+using namespace cpprobotparser;
+using namespace std::chrono_literals;
+
+static void BM_SchedulerReadyHosts(benchmark::State& state)
+{
+    const int hostCount = static_cast<int>(state.range(0));
+    PolitenessScheduler::Clock::time_point time{};
+
+    PolitenessScheduler::Settings settings;
+    settings.now = [&time] { return time; };
+
+    PolitenessScheduler scheduler(settings);
+    std::vector<std::string> hosts;
+
+    for (int i = 0; i < hostCount; ++i)
+    {
+        const std::string host = "https://host" + std::to_string(i) + ".example.com:443";
+
+        // the delays are spread over 1..64 seconds, so the hosts are spread over the whole wheel
+        scheduler.setDelay(host, std::chrono::seconds(1 + i % 64));
+        scheduler.schedule(host);
+    }
+
+    for (auto _ : state)
+    {
+        // a fetch worker polls every 10ms and reschedules every returned host
+        time += 10ms;
+        hosts.clear();
+        scheduler.readyHosts(hosts, 1024);
+
+        for (const std::string& host : hosts)
+        {
+            scheduler.schedule(host);
+        }
+
+        state.counters["hosts"] += static_cast<double>(hosts.size());
+    }
+
+    state.counters["hosts"] = benchmark::Counter(state.counters["hosts"], benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_SchedulerReadyHosts)->RangeMultiplier(10)->Range(1000, 1000000);
\ No newline at end of file
@@ -0,0 +1,284 @@
+﻿#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+#include "allocation_counter.h"
+#include "ascii_kernels.h"
+#include "corpus_generator.h"
+#include "string_helpers.h"
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+std::string joinedPaths(const std::string& separator)
+{
+    std::string result;
+
+    for (const std::string& path : CorpusGenerator().paths(64))
+    {
+        result += "  " + path + " ";
+        result += separator;
+    }
+
+    return result;
+}
+
+//! The previous implementation of StringHelpers::toLower: locale dependent and byte by byte
+std::string legacyToLower(const std::string& source)
+{
+    std::string result;
+    std::transform(source.begin(), source.end(), std::inserter(result, result.end()), [](char ch)
+    {
+        return static_cast<char>(std::tolower(ch));
+    });
+
+    return result;
+}
+
+//! Switches the kernels to the instruction set passed as the benchmark argument and restores them afterwards
+class InstructionSetScope final
+{
+public:
+    explicit InstructionSetScope(benchmark::State& state)
+        : m_previousInstructionSet(AsciiKernels::instructionSet())
+    {
+        const auto instructionSet = static_cast<AsciiKernels::InstructionSet>(state.range(0));
+
+        if (!AsciiKernels::setInstructionSet(instructionSet))
+        {
+            state.SkipWithError("the instruction set is not supported by the CPU");
+        }
+
+        state.SetLabel(instructionSet == AsciiKernels::InstructionSet::Avx2 ? "avx2" :
+            instructionSet == AsciiKernels::InstructionSet::Sse2 ? "sse2" : "scalar");
+    }
+
+    ~InstructionSetScope()
+    {
+        AsciiKernels::setInstructionSet(m_previousInstructionSet);
+    }
+
+private:
+    AsciiKernels::InstructionSet m_previousInstructionSet;
+};
+
+void instructionSets(benchmark::internal::Benchmark* benchmark)
+{
+    for (AsciiKernels::InstructionSet instructionSet : { AsciiKernels::InstructionSet::Scalar, AsciiKernels::InstructionSet::Sse2, AsciiKernels::InstructionSet::Avx2 })
+    {
+        benchmark->Arg(static_cast<int>(instructionSet));
+    }
+}
+
+}
+
+static void BM_SplitByString(benchmark::State& state)
+{
+    const std::string source = joinedPaths("\n");
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StringHelpers::split(source, "\n", StringHelpers::SkipEmptyParts));
+    }
+
+    allocationCounter.report(state);
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_SplitByString);
+
+static void BM_SplitByRegex(benchmark::State& state)
+{
+    const std::string source = joinedPaths("\r\n");
+    const std::regex rowDelimeter("\\n|\\r\\n|\\n\\r|\\r");
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StringHelpers::split(source, rowDelimeter, StringHelpers::SkipEmptyParts));
+    }
+
+    allocationCounter.report(state);
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_SplitByRegex);
+
+static void BM_ToLower(benchmark::State& state)
+{
+    const std::string source = joinedPaths("\n") + "/UPPER/Case/Path.HTML";
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StringHelpers::toLower(source));
+    }
+
+    allocationCounter.report(state);
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_ToLower);
+
+static void BM_LegacyToLower(benchmark::State& state)
+{
+    const std::string source = joinedPaths("\n") + "/UPPER/Case/Path.HTML";
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(legacyToLower(source));
+    }
+
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_LegacyToLower);
+
+static void BM_AsciiToLowerInPlace(benchmark::State& state)
+{
+    const InstructionSetScope instructionSetScope(state);
+    std::string source = joinedPaths("\n") + "/UPPER/Case/Path.HTML";
+
+    for (auto _ : state)
+    {
+        StringHelpers::toLower(source);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_AsciiToLowerInPlace)->Apply(instructionSets);
+
+// the typical matcher workload: a short wildcard segment searched in every URL path
+static void BM_FindLowercase(benchmark::State& state)
+{
+    const InstructionSetScope instructionSetScope(state);
+    const std::vector<std::string> paths = CorpusGenerator().paths(256);
+    const std::string segment = ".html";
+
+    std::size_t bytes = 0;
+
+    for (const std::string& path : paths)
+    {
+        bytes += path.size();
+    }
+
+    for (auto _ : state)
+    {
+        for (const std::string& path : paths)
+        {
+            benchmark::DoNotOptimize(StringHelpers::findLowercase(path, segment));
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+BENCHMARK(BM_FindLowercase)->Apply(instructionSets);
+
+// the previous matcher lowercased the path and the pattern on every check and used std::string::find
+static void BM_LegacyFind(benchmark::State& state)
+{
+    const std::vector<std::string> paths = CorpusGenerator().paths(256);
+    const std::string segment = ".html";
+
+    std::size_t bytes = 0;
+
+    for (const std::string& path : paths)
+    {
+        bytes += path.size();
+    }
+
+    for (auto _ : state)
+    {
+        for (const std::string& path : paths)
+        {
+            benchmark::DoNotOptimize(legacyToLower(path).find(legacyToLower(segment)));
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+BENCHMARK(BM_LegacyFind);
+
+// a long source with a rare match stresses the vector loop
+static void BM_FindLowercaseLongSource(benchmark::State& state)
+{
+    const InstructionSetScope instructionSetScope(state);
+    const std::string source = joinedPaths("&") + "/Needle/Found";
+    const std::string substring = "needle/found";
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StringHelpers::findLowercase(source, substring));
+    }
+
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_FindLowercaseLongSource)->Apply(instructionSets);
+
+static void BM_EqualsLowercase(benchmark::State& state)
+{
+    const InstructionSetScope instructionSetScope(state);
+    const std::string source = joinedPaths("\n") + "/UPPER/Case/Path.HTML";
+    const std::string lowercaseSource = StringHelpers::asciiLowercased(source);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StringHelpers::equalsLowercase(source, lowercaseSource));
+    }
+
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+BENCHMARK(BM_EqualsLowercase)->Apply(instructionSets);
+
+static void BM_Trimmed(benchmark::State& state)
+{
+    const std::vector<std::string> rows = StringHelpers::split(joinedPaths("\n"), "\n", StringHelpers::SkipEmptyParts);
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& row : rows)
+        {
+            benchmark::DoNotOptimize(StringHelpers::trimmed(row));
+        }
+    }
+
+    allocationCounter.report(state, rows.size());
+}
+
+BENCHMARK(BM_Trimmed);
+
+static void BM_TrimmedView(benchmark::State& state)
+{
+    const std::vector<std::string> rows = StringHelpers::split(joinedPaths("\n"), "\n", StringHelpers::SkipEmptyParts);
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        for (const std::string& row : rows)
+        {
+            benchmark::DoNotOptimize(StringHelpers::trimmedView(row));
+        }
+    }
+
+    allocationCounter.report(state, rows.size());
+}
+
+BENCHMARK(BM_TrimmedView);
\ No newline at end of file
@@ -0,0 +1,52 @@
+﻿#include <benchmark/benchmark.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "allocation_counter.h"
+#include "corpus_generator.h"
+#include "robots_txt_tokenizer.h"
+#include "robots_txt_rules.h"
+
+using namespace cpprobotparser;
+
+static void BM_Tokenize(benchmark::State& state)
+{
+    const std::string robotsTxt = CorpusGenerator().robotsTxt(static_cast<std::size_t>(state.range(0)), CorpusGenerator::RuleKind::Mixed);
+    RobotsTxtTokenizer tokenizer;
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        tokenizer.tokenize(robotsTxt);
+        benchmark::DoNotOptimize(tokenizer.isValid());
+    }
+
+    allocationCounter.report(state);
+    state.counters["memory_usage"] = static_cast<double>(tokenizer.memoryUsage());
+    state.SetBytesProcessed(state.iterations() * robotsTxt.size());
+}
+
+BENCHMARK(BM_Tokenize)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_ParseRules(benchmark::State& state)
+{
+    const std::string robotsTxt = CorpusGenerator().robotsTxt(static_cast<std::size_t>(state.range(0)), CorpusGenerator::RuleKind::Mixed);
+    RobotsTxtRules rules;
+
+    const AllocationCounter allocationCounter;
+
+    for (auto _ : state)
+    {
+        rules.parse(robotsTxt);
+        benchmark::ClobberMemory();
+    }
+
+    allocationCounter.report(state);
+    state.counters["memory_usage"] = static_cast<double>(rules.memoryUsage());
+    state.SetBytesProcessed(state.iterations() * robotsTxt.size());
+}
+
+BENCHMARK(BM_ParseRules)->RangeMultiplier(10)->Range(10, 10000);
\ No newline at end of file
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include "export_macro.h"
+
+namespace cpprobotparser
+{
+
+//! Locale independent ASCII kernels behind the StringHelpers case insensitive functions.
+//! On x86 they are vectorized with SSE2 or AVX2, the best instruction set supported by the CPU is chosen at runtime,
+//! on the other platforms the scalar implementation is used.
+class CPPROBOTPARSER_EXPORT AsciiKernels
+{
+public:
+    enum class InstructionSet
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    //! returns the instruction set used by the kernels
+    static InstructionSet instructionSet() noexcept;
+
+    //! forces the kernels to use the passed instruction set, e.g. to compare them in benchmarks
+    //! Returns false and changes nothing if the CPU doesn't support it. Not thread-safe against the running kernels.
+    static bool setInstructionSet(InstructionSet instructionSet) noexcept;
+
+    //! returns true if the CPU supports the passed instruction set
+    static bool isSupported(InstructionSet instructionSet) noexcept;
+
+    //! lowercases the ASCII letters in place, the other bytes are kept
+    static void toLower(char* data, std::size_t size) noexcept;
+
+    //! returns true if the first size bytes of the source are equal to the lowercase string case insensitively
+    static bool equalsLowercase(const char* source, const char* lowercaseString, std::size_t size) noexcept;
+
+    //! returns the position of the first case insensitive occurrence of the lowercase substring or npos
+    static std::size_t findLowercase(std::string_view source, std::string_view lowercaseSubstring) noexcept;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "robots_txt_token.h"
+#include "robots_txt_pattern.h"
+#include "robots_txt_prefix_tree.h"
+#include "robots_txt_path_prefilter.h"
+#include "directive_values.h"
+
+namespace cpprobotparser
+{
+
+//! The patterns of the compiled rules are the views of the values in the tokenizer arena of the rules
+struct CompiledRule
+{
+    CompiledRule(RobotsTxtToken tokenType, std::string_view tokenValue)
+        : type(tokenType)
+        , pattern(tokenValue)
+    {
+    }
+
+    RobotsTxtToken type;
+    RobotsTxtPattern pattern;
+};
+
+//! Clean-param directives of one user agent with the same path prefix merged into one set
+struct CompiledCleanParam
+{
+    explicit CompiledCleanParam(std::string_view pathPrefixValue)
+        : pathPrefix(pathPrefixValue)
+    {
+    }
+
+    // the paths the parameters are ignored for, the empty prefix matches every path
+    // the pattern is the view of the Clean-param value kept in cleanParams of the group
+    RobotsTxtPattern pathPrefix;
+
+    // sorted and unique, the robots.txt values are lowercased, so the names are compared case insensitively
+    std::vector<std::string> parameters;
+};
+
+//! The directives of one user agent record compiled at parse time
+struct CompiledUserAgentGroup
+{
+    // the lowercased product token of the user agent as UserAgentRegistry interns it, e.g. "googlebot" or "*"
+    std::string userAgent;
+
+    // in the precedence order: the longest patterns go first, Allow goes first among the patterns of equal length
+    std::vector<CompiledRule> rules;
+
+    // the literal rules are looked up in the tree, the rest of the rules are scanned one by one
+    RobotsTxtPrefixTree literalRules;
+    std::vector<std::size_t> wildcardRules;
+
+    // decides the allow-all and disallow-all groups and the paths no rule can match before the lookups above
+    RobotsTxtPathPrefilter prefilter;
+
+    std::vector<std::string> cleanParams;
+    std::vector<CompiledCleanParam> compiledCleanParams;
+
+    // the typed values parsed once, the malformed ones are skipped and reported as the parse diagnostics
+    std::optional<double> crawlDelay;
+    std::vector<RequestRate> requestRates;
+    std::optional<VisitTime> visitTime;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "robots_txt_token.h"
+
+namespace cpprobotparser
+{
+
+//! The time range of the Visit-time directive or of the Request-rate suffix, e.g. "0600-0845".
+//! The minutes are counted from the midnight UTC, the range wraps around the midnight if end is less than begin.
+struct VisitTime
+{
+    std::chrono::minutes begin;
+    std::chrono::minutes end;
+
+    //! returns true if the passed minute of the day (UTC) falls into the range, the end minute is included
+    bool contains(std::chrono::minutes minuteOfDay) const noexcept
+    {
+        return begin <= end ?
+            begin <= minuteOfDay && minuteOfDay <= end :
+            begin <= minuteOfDay || minuteOfDay <= end;
+    }
+
+    bool operator==(const VisitTime& other) const noexcept
+    {
+        return begin == other.begin && end == other.end;
+    }
+};
+
+//! The Request-rate directive: the number of requests allowed per period, e.g. "1/5" (seconds by default), "10/1m" or "3/1h 0600-0845"
+struct RequestRate
+{
+    std::uint32_t requests;
+    std::chrono::seconds period;
+
+    //! the time of the day the rate is applied at, absent if it's applied all day long
+    std::optional<VisitTime> visitTime;
+
+    //! returns the interval between two requests at this rate
+    std::chrono::milliseconds interval() const noexcept
+    {
+        return std::chrono::milliseconds((std::chrono::milliseconds(period).count() + requests - 1) / requests);
+    }
+
+    bool operator==(const RequestRate& other) const noexcept
+    {
+        return requests == other.requests && period == other.period && visitTime == other.visitTime;
+    }
+};
+
+//! The directive value the parser couldn't interpret, the directive is ignored
+struct ParseDiagnostic
+{
+    //! the lowercased product token of the user agent the directive belongs to, see RobotsTxtTokenizer::userAgents
+    std::string userAgent;
+
+    RobotsTxtToken token;
+
+    //! the lowercased directive value as it's written in the robots.txt
+    std::string value;
+
+    //! what is wrong with the value
+    std::string message;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+﻿#pragma once
+
+namespace cpprobotparser
+{
+
+//! Read-only memory mapping of a whole file shared by RobotsTxtStore and RobotsTxtBulkLoader.
+//! The mapping is released by the destructor, the views of the content are valid until then.
+class MappedFile final
+{
+public:
+    //! the hint for the system how the pages are read
+    enum class AccessPattern
+    {
+        Random,
+        Sequential
+    };
+
+    MappedFile() noexcept;
+
+    //! maps the file, the empty file gets the empty content
+    //! throws std::runtime_error if the file can't be opened or mapped
+    MappedFile(const std::string& filePath, AccessPattern accessPattern);
+
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view content() const noexcept;
+
+    //! Tells the system the content before the offset won't be read anymore, so its pages may leave the process memory.
+    //! The content stays valid, the released pages are read from the file again if they are touched.
+    //! Thread-safe, only the pages after the previously released offset are advised, so the calls with the growing offsets
+    //! cost as much as one call for the whole content.
+    void release(std::size_t offset) const noexcept;
+
+private:
+    void unmap() noexcept;
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+
+    // the page aligned size of the released content prefix
+    mutable std::atomic<std::size_t> m_releasedSize;
+
+#ifdef _WIN32
+    // HANDLE values, windows.h is included only by the implementation
+    void* m_file;
+    void* m_mapping;
+#endif
+};
+
+}
\ No newline at end of file
@@ -11,7 +11,7 @@ class RobotsTxtTokenizer;
 class CPPROBOTPARSER_EXPORT MetaRobotsHelpers
 {
 public:
-    static WellKnownUserAgent userAgent(const std::string& userAgentStr);
+    static WellKnownUserAgent userAgent(std::string_view userAgentStr);
     static std::string userAgentString(WellKnownUserAgent wellKnownUserAgent);
     static std::vector<WellKnownUserAgent> wellKnownUserAgents();
 };
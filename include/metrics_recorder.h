@@ -0,0 +1,151 @@
+﻿#pragma once
+
+#include "robots_txt_metrics.h"
+
+namespace cpprobotparser
+{
+
+//! Records the global metrics, it's used only by the library sources (see RobotsTxtMetrics)
+class MetricsRecorder final
+{
+public:
+    enum class Counter
+    {
+        Evaluations,
+        AllowMatches,
+        DisallowMatches,
+        NoMatches,
+        Fallbacks,
+        RulesScanned,
+        ExceptionsAvoided,
+        ParseNanoseconds,
+        CounterCount
+    };
+
+    static constexpr std::size_t counterCount = static_cast<std::size_t>(Counter::CounterCount);
+
+    //! it's the constant false if the library is built without the metrics, so all recording code is compiled out
+    static bool isEnabled() noexcept
+    {
+#ifdef CPPROBOTPARSER_METRICS
+        return s_enabled.load(std::memory_order_relaxed);
+#else
+        return false;
+#endif
+    }
+
+    static void add(Counter counter, std::uint64_t value) noexcept;
+    static void recordParse(std::uint64_t nanoseconds) noexcept;
+    static void recordEvaluation(std::uint64_t nanoseconds, std::uint64_t rulesScanned) noexcept;
+
+private:
+    friend class RobotsTxtMetrics;
+
+    static std::atomic<bool> s_enabled;
+};
+
+//! The counters of one RobotsTxtRules object, every value added to them is added to the global counters too.
+//! The object keeps its own values only after setEnabled(true): the checks of one object from many threads
+//! would contend on the cache line of its counters, so by default only the striped global counters are updated.
+//! The copies of the object get the current values. Without CPPROBOTPARSER_METRICS the class is empty.
+class ObjectCounters final
+{
+public:
+#ifdef CPPROBOTPARSER_METRICS
+    ObjectCounters() noexcept = default;
+
+    ObjectCounters(const ObjectCounters& other)
+    {
+        *this = other;
+    }
+
+    ObjectCounters& operator=(const ObjectCounters& other)
+    {
+        setEnabled(other.m_counters != nullptr);
+
+        for (std::size_t i = 0; m_counters && i < m_counters->size(); ++i)
+        {
+            (*m_counters)[i].store((*other.m_counters)[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        return *this;
+    }
+
+    //! not thread-safe, the values are dropped when the counters are disabled
+    void setEnabled(bool enabled)
+    {
+        if (!enabled)
+        {
+            m_counters.reset();
+            return;
+        }
+
+        if (!m_counters)
+        {
+            m_counters = std::make_unique<Counters>();
+
+            for (std::atomic<std::uint64_t>& counter : *m_counters)
+            {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void add(MetricsRecorder::Counter counter, std::uint64_t value = 1) const noexcept
+    {
+        if (m_counters)
+        {
+            (*m_counters)[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        MetricsRecorder::add(counter, value);
+    }
+
+    RobotsTxtCounters load() const noexcept
+    {
+        RobotsTxtCounters counters;
+
+        if (!m_counters)
+        {
+            return counters;
+        }
+
+        const auto value = [this](MetricsRecorder::Counter counter)
+        {
+            return (*m_counters)[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+        };
+
+        counters.evaluations = value(MetricsRecorder::Counter::Evaluations);
+        counters.allowMatches = value(MetricsRecorder::Counter::AllowMatches);
+        counters.disallowMatches = value(MetricsRecorder::Counter::DisallowMatches);
+        counters.noMatches = value(MetricsRecorder::Counter::NoMatches);
+        counters.fallbacks = value(MetricsRecorder::Counter::Fallbacks);
+        counters.rulesScanned = value(MetricsRecorder::Counter::RulesScanned);
+        counters.exceptionsAvoided = value(MetricsRecorder::Counter::ExceptionsAvoided);
+        counters.parseNanoseconds = value(MetricsRecorder::Counter::ParseNanoseconds);
+
+        return counters;
+    }
+
+private:
+    using Counters = std::array<std::atomic<std::uint64_t>, MetricsRecorder::counterCount>;
+
+    // the values are updated by the const methods of the rules, the pointer is set only by setEnabled
+    std::unique_ptr<Counters> m_counters;
+#else
+    void setEnabled(bool) noexcept
+    {
+    }
+
+    void add(MetricsRecorder::Counter, std::uint64_t = 1) const noexcept
+    {
+    }
+
+    RobotsTxtCounters load() const noexcept
+    {
+        return RobotsTxtCounters();
+    }
+#endif
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include "pimpl.h"
+#include "export_macro.h"
+#include "robots_txt_rules.h"
+
+namespace cpprobotparser
+{
+
+//! Thread-safe per-host politeness scheduler for the fetch workers.
+//! Every host has the delay between the fetches (see RobotsTxtRules::fetchInterval) and the time of its next allowed fetch.
+//! The hosts with URLs to fetch wait on a timing wheel, so scheduling a host and taking a ready one are O(1)
+//! regardless of the number of hosts. The hosts are split into shards each guarded by its own mutex like in RobotsTxtCache.
+//! The hosts are usually the origins (see UrlHelpers::origin), but any string may be used.
+class CPPROBOTPARSER_EXPORT PolitenessScheduler final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings
+    {
+        //! the delay for the hosts without Crawl-delay and Request-rate and the lower bound for the delays from the robots.txt
+        Clock::duration minDelay = std::chrono::seconds(1);
+
+        //! the upper bound for the delays from the robots.txt
+        Clock::duration maxDelay = std::chrono::minutes(10);
+
+        //! the resolution of the timing wheel, the host gets ready at most one tick later than allowed and never earlier
+        Clock::duration tickDuration = std::chrono::milliseconds(10);
+
+        //! the number of the wheel slots, the hosts waiting longer than wheelSize ticks are checked once per wheel turn
+        std::size_t wheelSize = 4096;
+
+        std::size_t shardCount = 16;
+
+        //! the source of the current time, Clock::now is used if it's empty
+        std::function<Clock::time_point()> now;
+    };
+
+    PolitenessScheduler();
+    explicit PolitenessScheduler(const Settings& settings);
+    PolitenessScheduler(PolitenessScheduler&& other);
+    ~PolitenessScheduler();
+
+    PolitenessScheduler& operator=(PolitenessScheduler&& other);
+
+    PolitenessScheduler(const PolitenessScheduler&) = delete;
+    PolitenessScheduler& operator=(const PolitenessScheduler&) = delete;
+
+    //! sets the delay between the fetches from the host, the unknown host is added
+    //! The time of the next fetch which is already allowed isn't moved, the new delay is applied after it
+    void setDelay(std::string_view host, Clock::duration delay);
+
+    //! the same with the delay of the robots.txt rules: the fetch interval of the group bounded by minDelay and maxDelay
+    void setDelay(std::string_view host, const RobotsTxtRules& rules, const UserAgentGroup& userAgentGroup);
+
+    //! marks the host as having URLs to fetch, it's returned by readyHosts as soon as its next fetch is allowed
+    //! The unknown host is added with minDelay, scheduling the already scheduled host does nothing
+    void schedule(std::string_view host);
+
+    //! appends up to maxHosts hosts which may be fetched now to the passed vector and returns their number
+    //! Every returned host grants one fetch: its next fetch is allowed after its delay and it's no longer scheduled,
+    //! so schedule it again if it has more URLs to fetch.
+    std::size_t readyHosts(std::vector<std::string>& hosts, std::size_t maxHosts);
+
+    //! returns the time when the next fetch from the host is allowed, the current time for the unknown host
+    Clock::time_point nextFetchTime(std::string_view host) const;
+
+    //! forgets the host including its delay and its next fetch time
+    void erase(std::string_view host);
+
+    //! returns the number of known hosts
+    std::size_t size() const;
+
+private:
+    class PolitenessSchedulerImpl;
+    Pimpl<PolitenessSchedulerImpl> m_impl;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include "pimpl.h"
+#include "export_macro.h"
+#include "robots_txt_rules.h"
+#include "robots_txt_cache.h"
+
+namespace cpprobotparser
+{
+
+//! Parses archived robots.txt files of many hosts in parallel.
+//! The input is either a WARC-like archive of concatenated records or a directory of robots.txt files.
+//! The archive is memory mapped and split into records by the calling thread without copying the content,
+//! the records are parsed by the pool of threads each taking the work from its own queue and stealing it from the others when it's idle.
+//! The reading thread waits while the number of the records not parsed yet reaches the limit,
+//! and the parsed part of the archive is released from the process memory, so the memory stays bounded on the archives of any size.
+//!
+//! The archive records are the WARC/1.0 ones: the header lines, the empty line and Content-Length bytes of the block.
+//! The "response" records with the HTTP response and the "resource" records with the bare robots.txt content are parsed,
+//! the other record types are skipped. The key of the rules is the origin of WARC-Target-URI (see UrlHelpers::origin).
+//! The 4xx responses get the empty rules allowing everything as RFC 9309 requires,
+//! the other non 2xx responses are counted as skipped because the previous rules of the host should be kept.
+//! The name of a directory file without the ".txt" extension is the host, the key of its rules is the origin of the host
+//! as for the archive records, e.g. "http://example.com:80" for "example.com.txt" (see UrlHelpers::origin).
+class CPPROBOTPARSER_EXPORT RobotsTxtBulkLoader final
+{
+public:
+    struct Settings
+    {
+        //! the number of the parsing threads, std::thread::hardware_concurrency is used if it's zero
+        std::size_t threadCount = 0;
+
+        //! the maximum number of the records split but not parsed yet
+        std::size_t maxPendingRecords = 1 << 14;
+
+        //! the limit of the parsed bytes of every file (see RobotsTxtRules::setMaxContentSize), not changed if it's zero
+        std::size_t maxContentSize = 0;
+    };
+
+    struct Statistics
+    {
+        //! the number of the parsed files and the total size of their content
+        std::size_t records = 0;
+        std::size_t bytes = 0;
+
+        //! the number of the malformed records and the responses which are not robots.txt files
+        std::size_t skippedRecords = 0;
+
+        //! the number of the directory files and subdirectories which couldn't be read, the loading goes on without them
+        std::size_t failedFiles = 0;
+
+        //! the number of the batches of records taken by the threads from the queues of the other threads
+        std::size_t stolenBatches = 0;
+    };
+
+    //! Receives the parsed rules with their key, it's called concurrently from all parsing threads.
+    //! The record number is the position of the record in the archive or of the file in the directory listing:
+    //! the threads pass the rules in any order, so of the several records of one key (e.g. the re-crawls of the host)
+    //! the one with the largest number is the latest.
+    //! The exception thrown by the consumer stops the loading and is rethrown by load.
+    using Consumer = std::function<void(const std::string& key, RobotsTxtRulesSnapshot rules, std::uint64_t recordNumber)>;
+
+    RobotsTxtBulkLoader();
+    explicit RobotsTxtBulkLoader(const Settings& settings);
+    ~RobotsTxtBulkLoader();
+
+    RobotsTxtBulkLoader(const RobotsTxtBulkLoader&) = delete;
+    RobotsTxtBulkLoader& operator=(const RobotsTxtBulkLoader&) = delete;
+
+    //! Parses every robots.txt file of the archive file or of the directory and passes the rules to the consumer.
+    //! Returns after all files are parsed, throws std::runtime_error if the archive or the directory itself can't be read,
+    //! the unreadable files of the directory are counted as failed.
+    Statistics load(const std::string& path, const Consumer& consumer) const;
+
+    //! the same as load which inserts the rules into the cache with their memory usage charged against its byte budget,
+    //! the cache gets the rules of the latest record of every key
+    Statistics load(const std::string& path, RobotsTxtCache& cache, RobotsTxtCache::Clock::duration timeToLive) const;
+
+private:
+    class RobotsTxtBulkLoaderImpl;
+    Pimpl<RobotsTxtBulkLoaderImpl> m_impl;
+};
+
+}
\ No newline at end of file
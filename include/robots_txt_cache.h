@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include "pimpl.h"
+#include "export_macro.h"
+#include "robots_txt_rules.h"
+
+namespace cpprobotparser
+{
+
+//! Thread-safe cache of the parsed robots.txt files keyed by origin ("scheme://host:port", see UrlHelpers::origin).
+//! The cache is split into shards each guarded by its own mutex, so the lookups for different hosts rarely contend.
+//! It's bounded by the number of entries and by the approximate number of bytes,
+//! the least recently used entries are evicted first and the entries older than their time to live are dropped.
+//! The rules are returned as shared pointers to immutable objects and stay valid after the entry is evicted.
+class CPPROBOTPARSER_EXPORT RobotsTxtCache final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using RulesPointer = RobotsTxtRulesSnapshot;
+
+    struct Settings
+    {
+        std::size_t maxEntries = 1 << 20;
+        std::size_t maxBytes = std::size_t(1) << 30;
+        Clock::duration timeToLive = std::chrono::hours(24);
+        std::size_t shardCount = 64;
+
+        //! the source of the current time for the expiration, Clock::now is used if it's empty
+        std::function<Clock::time_point()> now;
+    };
+
+    RobotsTxtCache();
+    explicit RobotsTxtCache(const Settings& settings);
+    RobotsTxtCache(RobotsTxtCache&& other);
+    ~RobotsTxtCache();
+
+    RobotsTxtCache& operator=(RobotsTxtCache&& other);
+
+    RobotsTxtCache(const RobotsTxtCache&) = delete;
+    RobotsTxtCache& operator=(const RobotsTxtCache&) = delete;
+
+    //! returns the rules cached for the origin or nullptr if there are none or they are expired
+    RulesPointer find(std::string_view origin) const;
+
+    //! parses the robots.txt content and caches the rules for the origin replacing the previous ones
+    //! the memory usage of the parsed rules is charged against the byte budget
+    RulesPointer insert(std::string_view origin, const std::string& robotsTxtContent);
+    RulesPointer insert(std::string_view origin, const std::string& robotsTxtContent, Clock::duration timeToLive);
+
+    //! caches already parsed rules, the approximate size of the rules is passed by the caller (see RobotsTxtRules::memoryUsage)
+    void insert(std::string_view origin, RulesPointer rules, std::size_t approximateBytes, Clock::duration timeToLive);
+
+    void erase(std::string_view origin);
+    void clear();
+
+    //! returns the number of cached entries including the expired ones which are not dropped yet
+    std::size_t size() const;
+
+    //! returns the approximate number of bytes taken by the cached entries
+    std::size_t bytes() const;
+
+private:
+    class RobotsTxtCacheImpl;
+    Pimpl<RobotsTxtCacheImpl> m_impl;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "export_macro.h"
+
+namespace cpprobotparser
+{
+
+//! The counters of the checks, kept by every RobotsTxtRules object and summed over all of them by RobotsTxtMetrics
+struct RobotsTxtCounters
+{
+    //! the checks of the URLs and the paths against the Allow/Disallow rules
+    std::uint64_t evaluations = 0;
+
+    //! the checks decided by an Allow rule, by a Disallow rule and the ones no rule matched
+    std::uint64_t allowMatches = 0;
+    std::uint64_t disallowMatches = 0;
+    std::uint64_t noMatches = 0;
+
+    //! the user agent resolutions which fell back to the "User-agent: *" group because the user agent had no own rules
+    std::uint64_t fallbacks = 0;
+
+    //! the wildcard patterns matched against the paths, the literal rules are looked up in the prefix tree at once
+    std::uint64_t rulesScanned = 0;
+
+    //! the tryCrawlDelay calls which returned nothing where crawlDelay would have thrown
+    std::uint64_t exceptionsAvoided = 0;
+
+    //! the total time of the parses including the compilation of the rules
+    std::uint64_t parseNanoseconds = 0;
+};
+
+//! Snapshot of the log-linear histogram: the values below 16 have their own buckets
+//! and every next power of two is split into 8 buckets, so the bucket bounds are within 12.5% of the values
+struct CPPROBOTPARSER_EXPORT MetricsHistogram
+{
+    struct Bucket
+    {
+        //! the inclusive bounds of the bucket values
+        std::uint64_t lowerBound;
+        std::uint64_t upperBound;
+        std::uint64_t count;
+    };
+
+    //! the non-empty buckets in the ascending order
+    std::vector<Bucket> buckets;
+
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+
+    //! adds the value to its bucket, e.g. to keep a histogram of the own measurements per thread
+    void record(std::uint64_t value);
+
+    //! adds the buckets of the other histogram, e.g. the histograms of the threads after a run
+    void merge(const MetricsHistogram& other);
+
+    //! returns the upper bound of the bucket with the quantile (0..1) of the values or zero if the histogram is empty
+    std::uint64_t quantile(double quantile) const noexcept;
+};
+
+//! Opt-in instrumentation of the parsing and the checks of all RobotsTxtRules objects.
+//! The metrics are compiled in only if the library is built with CPPROBOTPARSER_METRICS (the BUILD_WITH_METRICS option)
+//! and are recorded only after setEnabled(true), until then a check costs one relaxed atomic load more.
+//! The global counters are striped over the cache lines, so the threads checking URLs don't contend on them.
+class CPPROBOTPARSER_EXPORT RobotsTxtMetrics final
+{
+public:
+    struct Snapshot
+    {
+        RobotsTxtCounters counters;
+
+        //! the duration of every parse (RobotsTxtRules::parse or the feeds with finish) including the compilation of the rules
+        MetricsHistogram parseNanoseconds;
+
+        //! the duration of every check
+        MetricsHistogram evaluateNanoseconds;
+
+        //! the number of the wildcard patterns matched by every check
+        MetricsHistogram rulesScannedPerCheck;
+    };
+
+    //! returns true if the library is built with the metrics
+    static bool isAvailable() noexcept;
+
+    //! starts or stops recording, the metrics are disabled by default
+    static void setEnabled(bool enabled) noexcept;
+    static bool isEnabled() noexcept;
+
+    //! returns the metrics recorded by all threads, the concurrent records may be partially included
+    static Snapshot snapshot();
+
+    //! zeroes the global metrics, the counters of the RobotsTxtRules objects are kept
+    static void reset() noexcept;
+
+    //! returns the snapshot in the Prometheus text exposition format, the durations are in seconds
+    static std::string toPrometheus(const Snapshot& snapshot);
+
+    //! returns the snapshot as a JSON object with the counters and the non-empty histogram buckets
+    static std::string toJson(const Snapshot& snapshot);
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+﻿#pragma once
+
+namespace cpprobotparser
+{
+
+struct CompiledRule;
+
+//! Prefilter of the paths computed from the Allow/Disallow rules of one group at parse time.
+//! Nearly every rule starts with '/' and a couple of literal characters, so the first two characters
+//! of the path after '/' rule out most of the paths no rule can match before the prefix tree and the wildcard patterns are tried.
+//! The characters are hashed by their low five bits: the lowercase and the uppercase ASCII letters get the same hash,
+//! so the filter is case insensitive as the rules are, the other characters only share the bits with some letters.
+//! The object is trivially copyable, so it's stored in the RobotsTxtStore file as is.
+class RobotsTxtPathPrefilter final
+{
+public:
+    enum Verdict : std::uint8_t
+    {
+        VerdictUnknown,
+        VerdictAllowed,
+        VerdictDisallowed
+    };
+
+    //! passes every path, the verdicts are left to the rules
+    RobotsTxtPathPrefilter() noexcept;
+
+    //! the empty and the invalid patterns are never matched, so they are skipped
+    explicit RobotsTxtPathPrefilter(const std::vector<CompiledRule>& rules) noexcept;
+
+    //! returns false if no rule can match the path, the empty path is not passed here (it's checked as "/")
+    bool mayMatch(std::string_view path) const noexcept
+    {
+        if (!m_filtersPaths || path.size() < 2 || path[0] != '/')
+        {
+            return true;
+        }
+
+        const unsigned first = static_cast<unsigned char>(path[1]) & 31;
+
+        if (m_firstCharacters & (std::uint32_t(1) << first))
+        {
+            return true;
+        }
+
+        if (path.size() < 3)
+        {
+            return false;
+        }
+
+        const unsigned pair = (first << 5) | (static_cast<unsigned char>(path[2]) & 31);
+        return (m_characterPairs[pair >> 6] & (std::uint64_t(1) << (pair & 63))) != 0;
+    }
+
+    //! returns the verdict of the path if it doesn't depend on the rules matched or VerdictUnknown:
+    //! the rules allow everything, disallow everything or no rule can match the path
+    Verdict verdict(std::string_view path) const noexcept
+    {
+        if (m_constantVerdict == VerdictAllowed)
+        {
+            return VerdictAllowed;
+        }
+
+        if (m_constantVerdict == VerdictDisallowed && !path.empty() && path[0] == '/')
+        {
+            return VerdictDisallowed;
+        }
+
+        return mayMatch(path) ? VerdictUnknown : VerdictAllowed;
+    }
+
+private:
+    void addPattern(std::string_view pattern) noexcept;
+
+private:
+    // VerdictAllowed if no Disallow rule can match any path, VerdictDisallowed if every path starting with '/' is disallowed
+    std::uint8_t m_constantVerdict;
+
+    // false if a rule can match the paths starting with any characters, e.g. "Disallow: /*.pdf"
+    std::uint8_t m_filtersPaths;
+
+    std::uint16_t m_reserved;
+
+    // the hashes of the first characters after '/' of the rules which can match any second character, e.g. "Disallow: /a*"
+    std::uint32_t m_firstCharacters;
+
+    // the hashes of the first two characters after '/' of the rest of the rules
+    std::array<std::uint64_t, 16> m_characterPairs;
+};
+
+}
\ No newline at end of file
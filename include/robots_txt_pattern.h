@@ -0,0 +1,75 @@
+﻿#pragma once
+
+namespace cpprobotparser
+{
+
+//! Allow/Disallow pattern compiled once at parse time.
+//! The pattern is split into the literal segments between '*' wildcards,
+//! so matching a URL path is only a walk over these segments without building any strings.
+//! The pattern itself is not copied, the object keeps the view of it.
+class RobotsTxtPattern final
+{
+public:
+    enum Flag : std::uint8_t
+    {
+        // '$' is either absent or the last character, otherwise the pattern never matches
+        FlagValid = 1,
+
+        // the pattern contains '*' or '$', otherwise it's a plain prefix
+        FlagHasWildcards = 2,
+
+        FlagLeadingWildcard = 4,
+        FlagAnchoredAtEnd = 8
+    };
+
+    //! literal part between '*' wildcards: the range of the lowercased pattern, the trailing '$' is excluded
+    struct Segment
+    {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    //! the pattern must be lowercased and outlive this object, e.g. the value in the tokenizer arena
+    explicit RobotsTxtPattern(std::string_view pattern);
+
+    //! returns true if the passed path (with query) matches this pattern, the path is compared case insensitively
+    bool matches(std::string_view path) const noexcept;
+
+    //! the same as above for the pattern stored outside of this class, e.g. in a memory mapped file
+    static bool matches(
+        std::string_view pattern,
+        const Segment* segments,
+        std::size_t segmentCount,
+        std::uint8_t flags,
+        std::string_view path) noexcept;
+
+    //! returns the precedence of this pattern: its length in octets, the longest matched pattern is the most specific (RFC 9309)
+    int specificity() const noexcept;
+
+    //! returns true if the pattern has no wildcards and simply matches the paths starting with it
+    bool isLiteral() const noexcept;
+
+    //! returns the lowercased pattern
+    std::string_view pattern() const noexcept;
+
+    const std::vector<Segment>& segments() const noexcept;
+    std::uint8_t flags() const noexcept;
+
+private:
+    //! finds the lowercase segment in the path starting from the passed position in linear time
+    static std::size_t findSegment(std::string_view path, std::string_view segment, std::size_t from) noexcept;
+    static std::size_t findSegmentTwoWay(std::string_view path, std::string_view segment, std::size_t from) noexcept;
+
+    //! returns the start of the maximal suffix of the needle minus one for the passed character order and its period
+    static std::ptrdiff_t maximalSuffix(const char* needle, std::ptrdiff_t needleSize, std::ptrdiff_t& period, bool reversedOrder) noexcept;
+
+    //! the segments not longer than a vector register are searched with the vectorized kernels
+    static constexpr std::size_t s_shortSegmentLength = 16;
+
+    std::string_view m_pattern;
+    std::vector<Segment> m_segments;
+    int m_specificity;
+    std::uint8_t m_flags;
+};
+
+}
\ No newline at end of file
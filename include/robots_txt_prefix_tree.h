@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include "string_helpers.h"
+
+namespace cpprobotparser
+{
+
+//! Radix tree over the lowercased literal Allow/Disallow patterns (the ones without '*' and '$').
+//! One walk down the path finds the best of all patterns which are prefixes of the path,
+//! so the cost of a check doesn't depend on the number of literal rules.
+class RobotsTxtPrefixTree final
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    struct Entry
+    {
+        // the lowercased literal pattern, a view of the labels the tree is built with
+        std::string_view pattern;
+
+        // the index of the rule in the caller's rule list
+        std::size_t ruleIndex;
+
+        // the rule with the highest priority wins, on equal priority the one with the lowest index does
+        int priority;
+    };
+
+    struct Match
+    {
+        // npos if no pattern is a prefix of the path
+        std::size_t ruleIndex;
+        int priority;
+    };
+
+    //! Node of the flattened tree, it has the fixed size layout without pointers
+    //! so the tree can be stored in a file and walked in place
+    struct Node
+    {
+        // the edge label leading to this node is labels[labelOffset, labelOffset + labelLength)
+        std::uint32_t labelOffset;
+        std::uint32_t labelLength;
+
+        // the children are nodes[firstChild, firstChild + childCount) sorted by the first label character
+        std::uint32_t firstChild;
+        std::uint32_t childCount;
+
+        // the best rule which pattern ends at this node, nodeNoRule if there is no such rule
+        std::uint32_t ruleIndex;
+        std::int32_t priority;
+    };
+
+    static constexpr std::uint32_t nodeNoRule = static_cast<std::uint32_t>(-1);
+
+    RobotsTxtPrefixTree();
+
+    //! The labels are not copied: the nodes refer to the ranges of the patterns in the passed labels,
+    //! e.g. in the arena of the tokenized values, so the labels must contain every pattern and outlive the tree
+    RobotsTxtPrefixTree(std::vector<Entry> entries, std::string_view labels);
+
+    //! returns the best rule which pattern is a prefix of the path, the path is compared case insensitively
+    Match bestMatch(std::string_view path) const noexcept;
+
+    //! the same as above for the tree stored outside of this class, nodes[0] is the root
+    static Match bestMatch(const Node* nodes, std::string_view labels, std::string_view path) noexcept;
+
+    //! calls visitor(ruleIndex, priority) for every pattern which is a prefix of the path, from the shortest to the longest
+    template <typename Visitor>
+    static void forEachMatch(const Node* nodes, std::string_view labels, std::string_view path, Visitor&& visitor) noexcept;
+
+    //! returns true if the rule with the passed priority and index wins over the passed match
+    static bool isBetter(int priority, std::size_t ruleIndex, const Match& match) noexcept;
+
+    const std::vector<Node>& nodes() const noexcept;
+    std::string_view labels() const noexcept;
+
+private:
+    // m_nodes[0] is the root with the empty label
+    std::vector<Node> m_nodes;
+    std::string_view m_labels;
+};
+
+template <typename Visitor>
+void RobotsTxtPrefixTree::forEachMatch(const Node* nodes, std::string_view labels, std::string_view path, Visitor&& visitor) noexcept
+{
+    const Node* node = &nodes[0];
+    std::size_t position = 0;
+
+    if (node->ruleIndex != nodeNoRule)
+    {
+        visitor(static_cast<std::size_t>(node->ruleIndex), static_cast<int>(node->priority));
+    }
+
+    while (position < path.size())
+    {
+        const char ch = StringHelpers::asciiToLower(path[position]);
+        const Node* child = nullptr;
+
+        for (std::uint32_t i = node->firstChild; i < node->firstChild + node->childCount; ++i)
+        {
+            if (labels[nodes[i].labelOffset] == ch)
+            {
+                child = &nodes[i];
+                break;
+            }
+        }
+
+        if (!child)
+        {
+            break;
+        }
+
+        const std::string_view label = labels.substr(child->labelOffset, child->labelLength);
+
+        if (!StringHelpers::startsWithLowercase(path.substr(position), label))
+        {
+            break;
+        }
+
+        position += label.size();
+        node = child;
+
+        if (node->ruleIndex != nodeNoRule)
+        {
+            visitor(static_cast<std::size_t>(node->ruleIndex), static_cast<int>(node->priority));
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -1,12 +1,23 @@
 ﻿#pragma once
 
+#include <chrono>
 #include "pimpl.h"
 #include "export_macro.h"
 #include "well_known_user_agent.h"
+#include "user_agent_group.h"
+#include "user_agent_verdicts.h"
+#include "directive_values.h"
+#include "user_agent_registry.h"
+#include "robots_txt_metrics.h"
 
 namespace cpprobotparser
 {
 
+//! Thread-safety: all const methods may be called concurrently from any number of threads,
+//! they don't modify the rules. While RobotsTxtMetrics are enabled the checks only add to the atomic counters:
+//! the global ones striped over the cache lines and the counters of this object if setCountersEnabled(true) was called.
+//! parse(), setCountersEnabled() and the assignments are not thread-safe: they must not run while the object is read.
+//! To refresh the rules read by other threads publish a new object through RobotsTxtRulesHolder instead.
 class CPPROBOTPARSER_EXPORT RobotsTxtRules final
 {
 public:
@@ -19,22 +30,109 @@ public:
     RobotsTxtRules& operator=(const RobotsTxtRules& other);
     RobotsTxtRules& operator=(RobotsTxtRules&& other);
 
-    //! Parses the robots.txt content
+    //! Parses the robots.txt content replacing the previously parsed rules
+    //! The handles returned by resolveGroup before become invalid
     void parse(const std::string& robotsTxtContent);
 
+    //! Parses the robots.txt content incrementally, e.g. right from the socket buffers.
+    //! Pass the chunks as they arrive and call finish after the last one, the rules are available after finish.
+    //! The first chunk drops the rules of the previous content, every URL is allowed until finish.
+    //! See RobotsTxtTokenizer::feed for the details.
+    void feed(std::string_view chunk);
+    void finish();
+
+    //! Limits the number of parsed bytes, the rest of the content is ignored (see RobotsTxtTokenizer::setMaxContentSize)
+    void setMaxContentSize(std::size_t maxContentSize) noexcept;
+
+    //! returns true if the last parsed content exceeded the max content size
+    bool isTruncated() const noexcept;
+
+    //! Returns the handle to the rules applied for the specified user agent.
+    //! Resolve the user agent once and pass the handle to the methods below
+    //! to skip looking up the user agent on every call.
+    //! The user agent names are looked up by their product tokens case insensitively, e.g. "OurBot/2.1" as "ourbot".
+    UserAgentGroup resolveGroup(WellKnownUserAgent userAgent) const;
+    UserAgentGroup resolveGroup(const std::string& userAgent) const;
+
+    //! Returns the handle to the rules for the full User-Agent request header,
+    //! e.g. "Mozilla/5.0 (compatible; OurBot/2.1; +https://our.site/bot)" resolves the "User-agent: OurBot" record.
+    //! The product tokens of the header are matched without building any strings, see UserAgentRegistry::match.
+    UserAgentGroup resolveGroupFromHeader(std::string_view userAgentHeader) const noexcept;
+
+    //! returns the product tokens of all User-agent records which have directives, the names are compared case insensitively
+    const UserAgentRegistry& userAgents() const noexcept;
+
     //! Returns true if passed URL is allowed to crawl for the specified user agent
     //! Note: if you test some URL for example for GoogleBot user agent but robots.txt content
     //! does not contain any rules for Google then it will analyze rules for all robots (rules under this user agent: *)
     bool isUrlAllowed(const std::string& url, WellKnownUserAgent userAgent) const;
     bool isUrlAllowed(const std::string& url, const std::string& userAgent) const;
+    bool isUrlAllowed(const std::string& url, const UserAgentGroup& userAgentGroup) const;
+
+    //! The same as isUrlAllowed but takes only the path with query of the URL (e.g. "/catalog/page?id=1")
+    //! The passed bytes are matched as is: nothing is decoded and no temporary strings are built
+    bool isPathAllowed(std::string_view pathAndQuery, WellKnownUserAgent userAgent) const;
+    bool isPathAllowed(std::string_view pathAndQuery, const std::string& userAgent) const;
+    bool isPathAllowed(std::string_view pathAndQuery, const UserAgentGroup& userAgentGroup) const;
+
+    //! Batch versions of isUrlAllowed and isPathAllowed to check many URLs against the same user agent.
+    //! The rules of the user agent are resolved once for the whole batch.
+    //! The verdict for the i-th URL is written to verdicts[i], verdicts are resized to the number of passed URLs.
+    void areUrlsAllowed(const std::vector<std::string>& urls, WellKnownUserAgent userAgent, std::vector<bool>& verdicts) const;
+    void areUrlsAllowed(const std::vector<std::string>& urls, const std::string& userAgent, std::vector<bool>& verdicts) const;
+    void areUrlsAllowed(const std::vector<std::string>& urls, const UserAgentGroup& userAgentGroup, std::vector<bool>& verdicts) const;
+    void arePathsAllowed(const std::vector<std::string_view>& pathsAndQueries, WellKnownUserAgent userAgent, std::vector<bool>& verdicts) const;
+    void arePathsAllowed(const std::vector<std::string_view>& pathsAndQueries, const std::string& userAgent, std::vector<bool>& verdicts) const;
+    void arePathsAllowed(const std::vector<std::string_view>& pathsAndQueries, const UserAgentGroup& userAgentGroup, std::vector<bool>& verdicts) const;
+
+    //! Returns which of the well known user agents (see MetaRobotsHelpers::wellKnownUserAgents) may crawl the URL.
+    //! The URL is parsed once and the rules shared by several user agents are matched once,
+    //! so it's cheaper than calling isUrlAllowed for every user agent.
+    UserAgentVerdicts urlVerdicts(const std::string& url) const;
+    UserAgentVerdicts pathVerdicts(std::string_view pathAndQuery) const;
 
     //! Returns the seconds to delay between requests for the specified user agent
+    //! Throws std::runtime_error if there is no valid Crawl-delay, tryCrawlDelay reports it without the exception
     double crawlDelay(WellKnownUserAgent userAgent) const;
     double crawlDelay(const std::string& userAgent) const;
+    double crawlDelay(const UserAgentGroup& userAgentGroup) const;
+
+    //! Returns the first valid Crawl-delay of the specified user agent in seconds or nothing if there is no such one.
+    //! The value is valid if it starts with a non-negative number, the rest is ignored, e.g. "2.5s" is 2.5 seconds.
+    //! All directive values are parsed once by parse(), the malformed ones are skipped and reported by parseDiagnostics.
+    std::optional<double> tryCrawlDelay(WellKnownUserAgent userAgent) const;
+    std::optional<double> tryCrawlDelay(const std::string& userAgent) const;
+    std::optional<double> tryCrawlDelay(const UserAgentGroup& userAgentGroup) const noexcept;
+
+    //! Returns the valid Request-rate values of the specified user agent in the order of appearance
+    std::vector<RequestRate> requestRates(WellKnownUserAgent userAgent) const;
+    std::vector<RequestRate> requestRates(const std::string& userAgent) const;
+    const std::vector<RequestRate>& requestRates(const UserAgentGroup& userAgentGroup) const noexcept;
+
+    //! Returns the first valid Visit-time of the specified user agent or nothing if the host may be visited at any time
+    std::optional<VisitTime> visitTime(WellKnownUserAgent userAgent) const;
+    std::optional<VisitTime> visitTime(const std::string& userAgent) const;
+    std::optional<VisitTime> visitTime(const UserAgentGroup& userAgentGroup) const noexcept;
+
+    //! Returns the minimal interval between the requests to the host for the specified user agent:
+    //! the larger of Crawl-delay and the period of Request-rate divided by its number of requests.
+    //! The absent values give zero.
+    std::chrono::milliseconds fetchInterval(WellKnownUserAgent userAgent) const;
+    std::chrono::milliseconds fetchInterval(const std::string& userAgent) const;
+    std::chrono::milliseconds fetchInterval(const UserAgentGroup& userAgentGroup) const noexcept;
 
     //! Returns the set of Clean-param tokens for the specified user agent
     std::vector<std::string> cleanParam(WellKnownUserAgent userAgent) const;
     std::vector<std::string> cleanParam(const std::string& userAgent) const;
+    const std::vector<std::string>& cleanParam(const UserAgentGroup& userAgentGroup) const;
+
+    //! Returns the URL without the query parameters ignored by the Clean-param directives of the specified user agent,
+    //! e.g. "Clean-param: ref&sid /catalog/" turns "/catalog/page?ref=1&id=2" into "/catalog/page?id=2".
+    //! The parameter names are compared case insensitively, the rest of the URL is kept as is.
+    //! If nothing is removed the passed URL itself is returned without any allocation, otherwise the result is built in the passed buffer, so both of them must outlive the returned view.
+    std::string_view canonicalize(std::string_view url, WellKnownUserAgent userAgent, std::string& buffer) const;
+    std::string_view canonicalize(std::string_view url, const std::string& userAgent, std::string& buffer) const;
+    std::string_view canonicalize(std::string_view url, const UserAgentGroup& userAgentGroup, std::string& buffer) const;
 
     //! returns true if passed user agent is found in the robots.txt, otherwise returns false
     bool hasRulesFor(WellKnownUserAgent userAgent) const;
@@ -43,9 +141,32 @@ public:
     //! returns the URL to the sitemap if it exists in the robots.txt file
     const std::string& sitemapUrl() const noexcept;
 
+    //! returns the directive values of the last parsed content which were ignored as malformed
+    const std::vector<ParseDiagnostic>& parseDiagnostics() const noexcept;
+
+    //! returns the approximate number of bytes taken by this object: the parsed directives and the compiled rules
+    std::size_t memoryUsage() const noexcept;
+
+    //! Keeps the counters of the checks and the parses of this object, they are disabled by default
+    //! because the threads checking one object would contend on its counters. The counters are compiled in
+    //! only with the metrics (see RobotsTxtMetrics) and are dropped when disabled.
+    void setCountersEnabled(bool enabled);
+
+    //! returns the counters of this object, they are updated only while RobotsTxtMetrics and the counters of the object are enabled
+    RobotsTxtCounters counters() const noexcept;
+
+private:
+    friend class RobotsTxtStoreWriter;
+
+    // visits the compiled groups of the user agents keyed by the user agent name
+    void forEachGroup(const std::function<void(const std::string&, const CompiledUserAgentGroup&)>& visitor) const;
+
 private:
     class RobotsTxtRulesImpl;
     Pimpl<RobotsTxtRulesImpl> m_impl;
 };
 
+//! Immutable parsed rules shared between threads
+using RobotsTxtRulesSnapshot = std::shared_ptr<const RobotsTxtRules>;
+
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include "pimpl.h"
+#include "export_macro.h"
+#include "robots_txt_rules.h"
+
+namespace cpprobotparser
+{
+
+//! Publishes the parsed rules of one robots.txt to the reader threads.
+//! Readers take the current snapshot and check URLs against it without any lock held,
+//! a reload parses the new content aside and then atomically swaps the snapshot.
+//! Taking and swapping the snapshot are std::atomic_load and std::atomic_exchange of the shared_ptr,
+//! which libstdc++, libc++ and MSVC implement with a lock held only to copy the pointer and to update its reference count,
+//! so a reader may briefly wait for another reader or for the swap but never for the parsing of a reload.
+//! The readers which took the previous snapshot keep using it until they release it,
+//! the old snapshot is destroyed together with the last reference to it.
+//! All methods are thread-safe.
+class CPPROBOTPARSER_EXPORT RobotsTxtRulesHolder final
+{
+public:
+    //! holds the empty rules which allow every URL
+    RobotsTxtRulesHolder();
+    explicit RobotsTxtRulesHolder(RobotsTxtRulesSnapshot snapshot);
+    ~RobotsTxtRulesHolder();
+
+    RobotsTxtRulesHolder(const RobotsTxtRulesHolder&) = delete;
+    RobotsTxtRulesHolder& operator=(const RobotsTxtRulesHolder&) = delete;
+
+    //! returns the current snapshot, it's never nullptr
+    RobotsTxtRulesSnapshot snapshot() const;
+
+    //! parses the content into a new snapshot and publishes it, returns the published snapshot
+    RobotsTxtRulesSnapshot reload(const std::string& robotsTxtContent);
+
+    //! publishes the already parsed rules, nullptr is replaced with the empty rules
+    void publish(RobotsTxtRulesSnapshot snapshot);
+
+private:
+    class RobotsTxtRulesHolderImpl;
+    Pimpl<RobotsTxtRulesHolderImpl> m_impl;
+};
+
+}
\ No newline at end of file
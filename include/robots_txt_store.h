@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include "pimpl.h"
+#include "export_macro.h"
+#include "well_known_user_agent.h"
+#include "robots_txt_rules.h"
+
+namespace cpprobotparser
+{
+
+//! Writes the compiled Allow/Disallow rules of many origins into one binary file read by RobotsTxtStore.
+//! The file layout has only offsets and fixed size fields, so the reader maps it into memory
+//! and checks URLs right against the mapped pages without any deserialization.
+//! Crawl-delay, Clean-param and Sitemap values are not stored.
+class CPPROBOTPARSER_EXPORT RobotsTxtStoreWriter final
+{
+public:
+    RobotsTxtStoreWriter();
+    ~RobotsTxtStoreWriter();
+
+    RobotsTxtStoreWriter(const RobotsTxtStoreWriter&) = delete;
+    RobotsTxtStoreWriter& operator=(const RobotsTxtStoreWriter&) = delete;
+
+    //! adds the rules of the origin ("scheme://host:port", see UrlHelpers::origin)
+    //! The rules added later for the same origin replace the previous ones.
+    void add(std::string_view origin, const RobotsTxtRules& rules);
+
+    //! returns the number of the added origins
+    std::size_t size() const noexcept;
+
+    //! writes the store file, throws std::runtime_error if the file can't be written
+    void write(const std::string& filePath) const;
+
+private:
+    class RobotsTxtStoreWriterImpl;
+    Pimpl<RobotsTxtStoreWriterImpl> m_impl;
+};
+
+//! View of the rules of one origin inside the mapped store file.
+//! The view is valid while the RobotsTxtStore it was found in is alive.
+//! The verdicts are the same as the ones of RobotsTxtRules the origin was added with.
+class CPPROBOTPARSER_EXPORT RobotsTxtStoredRules final
+{
+public:
+    //! creates the view which allows every URL
+    RobotsTxtStoredRules() noexcept;
+
+    //! returns true if the rules were found in the store
+    explicit operator bool() const noexcept;
+
+    bool isUrlAllowed(const std::string& url, WellKnownUserAgent userAgent) const;
+    bool isUrlAllowed(const std::string& url, const std::string& userAgent) const;
+
+    //! the same as isUrlAllowed for the path with query of the URL, e.g. "/search?q=1"
+    bool isPathAllowed(std::string_view pathAndQuery, WellKnownUserAgent userAgent) const;
+    bool isPathAllowed(std::string_view pathAndQuery, const std::string& userAgent) const noexcept;
+
+private:
+    friend class RobotsTxtStore;
+
+    explicit RobotsTxtStoredRules(const char* hostRecord) noexcept;
+
+private:
+    // the beginning of the origin record in the mapped file, all offsets of the record are relative to it
+    const char* m_hostRecord;
+};
+
+//! Read-only store of the rules written by RobotsTxtStoreWriter.
+//! The file is memory mapped, so opening is instant and the pages are loaded lazily by the first lookups.
+//! All const methods may be called concurrently from any number of threads.
+class CPPROBOTPARSER_EXPORT RobotsTxtStore final
+{
+public:
+    //! maps the store file, throws std::runtime_error if the file can't be mapped or has the unsupported format
+    explicit RobotsTxtStore(const std::string& filePath);
+    RobotsTxtStore(RobotsTxtStore&& other);
+    ~RobotsTxtStore();
+
+    RobotsTxtStore& operator=(RobotsTxtStore&& other);
+
+    RobotsTxtStore(const RobotsTxtStore&) = delete;
+    RobotsTxtStore& operator=(const RobotsTxtStore&) = delete;
+
+    //! returns the rules of the origin or the empty view if the origin is not stored
+    RobotsTxtStoredRules find(std::string_view origin) const noexcept;
+
+    //! returns the number of the stored origins
+    std::size_t size() const noexcept;
+
+private:
+    class RobotsTxtStoreImpl;
+    Pimpl<RobotsTxtStoreImpl> m_impl;
+};
+
+}
\ No newline at end of file
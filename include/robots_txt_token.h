@@ -14,7 +14,11 @@ enum class RobotsTxtToken
     TokenCleanParam,
     TokenCommentary,
     TokenStringDelimeter,
-    TokenUnknown
+    TokenUnknown,
+
+    // the later directives are appended, so the values of the existing ones don't change
+    TokenRequestRate,
+    TokenVisitTime
 };
 
 }
\ No newline at end of file
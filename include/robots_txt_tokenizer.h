@@ -4,6 +4,7 @@
 #include "export_macro.h"
 #include "robots_txt_token.h"
 #include "well_known_user_agent.h"
+#include "user_agent_registry.h"
 
 namespace cpprobotparser
 {
@@ -15,7 +16,7 @@ class CPPROBOTPARSER_EXPORT RobotsTxtTokenizer final
 {
 public:
     RobotsTxtTokenizer();
-    RobotsTxtTokenizer(const std::string& robotsTxtContent);
+    RobotsTxtTokenizer(std::string_view robotsTxtContent);
     RobotsTxtTokenizer(const RobotsTxtTokenizer& other);
     RobotsTxtTokenizer(RobotsTxtTokenizer&& other);
     ~RobotsTxtTokenizer();
@@ -26,8 +27,25 @@ public:
     //! returns true if no error occurred, otherwise returns false
     bool isValid() const noexcept;
 
-    //! parse the passed robots.txt content
-    void tokenize(const std::string& robotsTxtContent);
+    //! parse the passed robots.txt content, the result of the previous call is dropped
+    //! The content is scanned once, only the stored values are copied out of it
+    void tokenize(std::string_view robotsTxtContent);
+
+    //! Incremental parsing: pass the content chunk by chunk as it arrives and call finish after the last one.
+    //! Rows may be split between chunks at any byte, CR, LF and their combinations are accepted as row delimeters.
+    //! The first feed after finish (or after construction) starts parsing a new content.
+    void feed(std::string_view chunk);
+    void finish();
+
+    //! RFC 9309 requires parsing at least this number of bytes of the robots.txt
+    static constexpr std::size_t rfc9309MaxContentSize = 500 * 1024;
+
+    //! the bytes after the limit are ignored keeping the rows parsed before it, the row crossing the limit is dropped
+    //! There is no limit by default
+    void setMaxContentSize(std::size_t maxContentSize) noexcept;
+
+    //! returns true if the last parsed content exceeded the max content size
+    bool isTruncated() const noexcept;
 
     //! returns true if passed user agent is found in the robots.txt, otherwise returns false
     bool hasUserAgentRecord(WellKnownUserAgent userAgentType) const;
@@ -37,12 +55,28 @@ public:
     std::vector<std::string> tokenValues(WellKnownUserAgent userAgentType, RobotsTxtToken token) const;
     std::vector<std::string> tokenValues(const std::string& userAgent, RobotsTxtToken token) const;
 
+    //! returns the lowercased product tokens of the user agents which have directives, every User-agent record is kept,
+    //! e.g. "ourbot" for "User-agent: OurBot/2.1" and "*" for "User-agent: robots"
+    const UserAgentRegistry& userAgents() const noexcept;
+
+    //! visits all directives in the order of appearance: the id of the user agent in userAgents(), the token and the lowercased value
+    //! The values are the views of directiveValues()
+    void forEachDirective(const std::function<void(std::uint32_t, RobotsTxtToken, std::string_view)>& visitor) const;
+
+    //! returns the lowercased values of all directives stored one after another,
+    //! the view stays valid until the next content is parsed or this object is assigned or destroyed
+    std::string_view directiveValues() const noexcept;
+
     //! returns the URL to the sitemap if it exists in the robots.txt file
     const std::string& sitemapUrl() const noexcept;
 
     //! returns the URL to the original host mirror if it exists in the robots.txt file
     const std::string& originalHostMirrorUrl() const noexcept;
 
+    //! returns the approximate number of bytes taken by the parsed directives including this object
+    //! All directive values are kept in one arena, so the footprint grows with the content size, not with the row count
+    std::size_t memoryUsage() const noexcept;
+
 private:
     class RobotsTxtTokenizerImpl;
     Pimpl<RobotsTxtTokenizerImpl> m_impl;
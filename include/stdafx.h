@@ -4,8 +4,11 @@
 // C/C++
 //
 #include <cstdlib>
+#include <cstdint>
 #include <vector>
+#include <array>
 #include <deque>
+#include <list>
 #include <queue>
 #include <map>
 #include <set>
@@ -17,6 +20,11 @@
 #include <future>
 #include <chrono>
 #include <string>
+#include <cstring>
+#include <cmath>
+#include <string_view>
+#include <optional>
+#include <charconv>
 #include <type_traits>
 #include <typeinfo>
 #include <atomic>
@@ -30,4 +38,5 @@
 #include <fstream>
 #include <regex>
 #include <cctype>
+#include <algorithm>
 #include <iostream>
\ No newline at end of file
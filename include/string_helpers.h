@@ -20,6 +20,7 @@ public:
 
     using StringList = std::vector<std::string>;
 
+    //! ASCII-only, locale independent
     static void toLower(std::string& source);
     static std::string toLower(const std::string& source);
 
@@ -42,6 +43,18 @@ public:
     static bool startsWith(const std::string& source, const std::string& substring, CaseSensitivity cs = CaseSensitive);
     static bool endsWith(const std::string& source, const std::string& substring, CaseSensitivity cs = CaseSensitive);
 
+    //! ASCII-only, locale independent helpers vectorized by AsciiKernels.
+    //! The substring must be already lowercased, the source is compared case insensitively without copying.
+    static char asciiToLower(char ch) noexcept;
+    static bool startsWithLowercase(std::string_view source, std::string_view lowercaseSubstring) noexcept;
+    static bool endsWithLowercase(std::string_view source, std::string_view lowercaseSubstring) noexcept;
+    static std::size_t findLowercase(std::string_view source, std::string_view lowercaseSubstring, std::size_t from = 0) noexcept;
+    static bool equalsLowercase(std::string_view source, std::string_view lowercaseString) noexcept;
+    static std::string asciiLowercased(std::string_view source);
+
+    //! returns the view without leading and trailing whitespaces
+    static std::string_view trimmedView(std::string_view source) noexcept;
+
 private:
     static StringList splitHelper(
         const std::string& source,
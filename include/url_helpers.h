@@ -0,0 +1,24 @@
+﻿#pragma once
+
+namespace cpprobotparser
+{
+
+class UrlHelpers
+{
+public:
+    //! returns the raw path with query of the passed URL as a view into it, the fragment is dropped
+    //! Nothing is decoded or normalized. If the URL has no scheme it starts with the authority as for origin, e.g. "example.com/a",
+    //! unless it starts with '/' or '?' and is the path with query itself.
+    static std::string_view pathAndQuery(std::string_view url) noexcept;
+
+    //! returns the path with query of the URL which is matched against the robots.txt rules
+    //! An empty path followed by a query is completed with '/' in the passed buffer and the view into the buffer is returned.
+    static std::string_view rulesPath(std::string_view url, std::string& buffer);
+
+    //! returns the origin of the passed URL in the form "scheme://host:port"
+    //! The scheme and the host are lowercased, the user info is dropped and the default port is added for http and https.
+    //! If the URL has no scheme it's treated as http.
+    static std::string origin(std::string_view url);
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "export_macro.h"
+
+namespace cpprobotparser
+{
+
+class RobotsTxtRules;
+struct CompiledUserAgentGroup;
+
+//! Lightweight handle to the rules of one user agent resolved by RobotsTxtRules::resolveGroup.
+//! The fallback to the rules for all robots is already applied, so using the handle
+//! does neither a user agent lookup nor a string conversion.
+//! The handle is valid while the RobotsTxtRules object it was resolved from is alive and is not parsed again.
+class CPPROBOTPARSER_EXPORT UserAgentGroup final
+{
+public:
+    //! creates the handle which allows every URL and has no directives
+    UserAgentGroup() noexcept;
+
+    //! returns true if the user agent has own record in the robots.txt
+    bool hasOwnRecord() const noexcept;
+
+private:
+    friend class RobotsTxtRules;
+
+    UserAgentGroup(const CompiledUserAgentGroup* ownGroup, const CompiledUserAgentGroup* rulesGroup) noexcept;
+
+private:
+    // the record of the user agent itself, Crawl-delay and Clean-param are taken from it
+    const CompiledUserAgentGroup* m_ownGroup;
+
+    // the record which Allow/Disallow rules are applied for the user agent
+    const CompiledUserAgentGroup* m_rulesGroup;
+};
+
+}
\ No newline at end of file
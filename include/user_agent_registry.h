@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include "pimpl.h"
+#include "export_macro.h"
+
+namespace cpprobotparser
+{
+
+//! Interns the product tokens of the User-agent records into compact ids.
+//! The ids are assigned in the order of the first intern call starting from zero,
+//! the tokens are kept lowercased and compared case insensitively as RFC 9309 requires.
+//! The lookups neither allocate nor build temporary strings.
+class CPPROBOTPARSER_EXPORT UserAgentRegistry final
+{
+public:
+    static constexpr std::uint32_t npos = static_cast<std::uint32_t>(-1);
+
+    UserAgentRegistry();
+    UserAgentRegistry(const UserAgentRegistry& other);
+    UserAgentRegistry(UserAgentRegistry&& other);
+    ~UserAgentRegistry();
+
+    UserAgentRegistry& operator=(const UserAgentRegistry& other);
+    UserAgentRegistry& operator=(UserAgentRegistry&& other);
+
+    //! returns the id of the product token, the new token gets the next id
+    std::uint32_t intern(std::string_view productToken);
+
+    //! returns the id of the product token or npos if it isn't interned
+    std::uint32_t find(std::string_view productToken) const noexcept;
+
+    //! Returns the id of the best record for the full User-Agent request header or npos if there is no such record,
+    //! e.g. "Mozilla/5.0 (compatible; OurBot/2.1; +https://our.site/bot)" is matched to "ourbot".
+    //! Every product token of the header is looked up, the versions after '/' are skipped.
+    //! The token without the record falls back to its prefix before '-', e.g. "googlebot-image" to "googlebot".
+    //! The longest matched token wins, on equal length the first one does.
+    std::uint32_t match(std::string_view userAgentHeader) const noexcept;
+
+    //! returns the lowercased product token of the id
+    const std::string& name(std::uint32_t id) const;
+
+    //! returns the number of the interned tokens
+    std::size_t size() const noexcept;
+
+    void clear() noexcept;
+
+    //! returns the approximate number of bytes taken by this object
+    std::size_t memoryUsage() const noexcept;
+
+    //! returns the product token of the User-agent record value, e.g. "OurBot" for "OurBot/2.1"
+    static std::string_view productToken(std::string_view userAgentValue) noexcept;
+
+private:
+    class UserAgentRegistryImpl;
+    Pimpl<UserAgentRegistryImpl> m_impl;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "export_macro.h"
+#include "well_known_user_agent.h"
+
+namespace cpprobotparser
+{
+
+//! Crawl verdicts of every well known user agent for one URL returned by RobotsTxtRules::urlVerdicts.
+//! The bit with the number of the WellKnownUserAgent enum value is set if the user agent may crawl the URL.
+//! WellKnownUserAgent::Unknown has no rules and its bit is never set.
+class CPPROBOTPARSER_EXPORT UserAgentVerdicts final
+{
+public:
+    //! creates the verdicts which allow nothing
+    UserAgentVerdicts() noexcept;
+    explicit UserAgentVerdicts(std::uint32_t mask) noexcept;
+
+    //! returns true if the passed user agent may crawl the URL
+    bool isAllowed(WellKnownUserAgent userAgent) const noexcept;
+
+    //! returns the bit set of the user agents which may crawl the URL
+    std::uint32_t mask() const noexcept;
+
+    //! returns the bit of the passed user agent in the mask
+    static std::uint32_t bit(WellKnownUserAgent userAgent) noexcept;
+
+    bool operator==(const UserAgentVerdicts& other) const noexcept;
+    bool operator!=(const UserAgentVerdicts& other) const noexcept;
+
+private:
+    std::uint32_t m_mask;
+};
+
+}
\ No newline at end of file
@@ -1,4 +1,19 @@
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory>
+#include <chrono>
+#include <functional>
 #include <../include/robots_txt_rules.h>
-#include <../include/well_known_user_agent.h>
\ No newline at end of file
+#include <../include/well_known_user_agent.h>
+#include <../include/user_agent_group.h>
+#include <../include/user_agent_verdicts.h>
+#include <../include/directive_values.h>
+#include <../include/user_agent_registry.h>
+#include <../include/robots_txt_cache.h>
+#include <../include/robots_txt_rules_holder.h>
+#include <../include/robots_txt_store.h>
+#include <../include/url_helpers.h>
+#include <../include/politeness_scheduler.h>
+#include <../include/robots_txt_bulk_loader.h>
+#include <../include/robots_txt_metrics.h>
\ No newline at end of file
@@ -0,0 +1,448 @@
+﻿#include "ascii_kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPPROBOTPARSER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CPPROBOTPARSER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CPPROBOTPARSER_TARGET_SSE2 __attribute__((target("sse2")))
+#define CPPROBOTPARSER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CPPROBOTPARSER_TARGET_SSE2
+#define CPPROBOTPARSER_TARGET_AVX2
+#endif
+
+namespace
+{
+
+using namespace cpprobotparser;
+
+struct Kernels
+{
+    AsciiKernels::InstructionSet instructionSet;
+    void(*toLower)(char* data, std::size_t size);
+    bool(*equalsLowercase)(const char* source, const char* lowercaseString, std::size_t size);
+    std::size_t(*findLowercase)(const char* source, std::size_t sourceSize, const char* lowercaseSubstring, std::size_t substringSize);
+};
+
+char asciiToLower(char ch) noexcept
+{
+    return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+//
+// Scalar kernels, they also process the tails shorter than a vector register
+//
+
+void toLowerScalar(char* data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        data[i] = asciiToLower(data[i]);
+    }
+}
+
+bool equalsLowercaseScalar(const char* source, const char* lowercaseString, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (asciiToLower(source[i]) != lowercaseString[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// searches the substring starting at the positions [from, sourceSize - substringSize], the substring is not empty
+template <bool(*EqualsLowercase)(const char*, const char*, std::size_t)>
+std::size_t findLowercaseScalar(const char* source, std::size_t sourceSize, const char* lowercaseSubstring, std::size_t substringSize, std::size_t from)
+{
+    const char first = lowercaseSubstring[0];
+
+    for (std::size_t i = from; i + substringSize <= sourceSize; ++i)
+    {
+        if (asciiToLower(source[i]) == first && EqualsLowercase(source + i + 1, lowercaseSubstring + 1, substringSize - 1))
+        {
+            return i;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+std::size_t findLowercaseScalar(const char* source, std::size_t sourceSize, const char* lowercaseSubstring, std::size_t substringSize)
+{
+    return findLowercaseScalar<equalsLowercaseScalar>(source, sourceSize, lowercaseSubstring, substringSize, 0);
+}
+
+#ifdef CPPROBOTPARSER_X86
+
+int countTrailingZeros(std::uint32_t mask) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+//
+// SSE2 kernels
+//
+
+CPPROBOTPARSER_TARGET_SSE2 __m128i toLowerSse2(__m128i chars)
+{
+    // the bytes above 0x7F are negative and never fall into the range
+    const __m128i isUpper = _mm_and_si128(
+        _mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1))
+    );
+
+    return _mm_or_si128(chars, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+}
+
+CPPROBOTPARSER_TARGET_SSE2 void toLowerSse2(char* data, std::size_t size)
+{
+    std::size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), toLowerSse2(chars));
+    }
+
+    toLowerScalar(data + i, size - i);
+}
+
+CPPROBOTPARSER_TARGET_SSE2 bool equalsLowercaseSse2(const char* source, const char* lowercaseString, std::size_t size)
+{
+    std::size_t i = 0;
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i sourceChars = toLowerSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        const __m128i lowercaseChars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lowercaseString + i));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(sourceChars, lowercaseChars)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+
+    return equalsLowercaseScalar(source + i, lowercaseString + i, size - i);
+}
+
+// compares 16 candidate positions at once by the first and the last characters of the substring
+// and verifies only the positions where both of them match
+CPPROBOTPARSER_TARGET_SSE2 std::size_t findLowercaseSse2(const char* source, std::size_t sourceSize, const char* lowercaseSubstring, std::size_t substringSize)
+{
+    const __m128i first = _mm_set1_epi8(lowercaseSubstring[0]);
+    const __m128i last = _mm_set1_epi8(lowercaseSubstring[substringSize - 1]);
+    std::size_t i = 0;
+
+    for (; i + substringSize - 1 + 16 <= sourceSize; i += 16)
+    {
+        const __m128i firstChars = toLowerSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        const __m128i lastChars = toLowerSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + substringSize - 1)));
+
+        std::uint32_t candidates = static_cast<std::uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(firstChars, first), _mm_cmpeq_epi8(lastChars, last))
+        ));
+
+        while (candidates != 0)
+        {
+            const std::size_t position = i + countTrailingZeros(candidates);
+
+            if (equalsLowercaseSse2(source + position, lowercaseSubstring, substringSize))
+            {
+                return position;
+            }
+
+            candidates &= candidates - 1;
+        }
+    }
+
+    return findLowercaseScalar<equalsLowercaseSse2>(source, sourceSize, lowercaseSubstring, substringSize, i);
+}
+
+//
+// AVX2 kernels, the tails are processed with the VEX encoded 128-bit operations
+// to avoid the penalty of switching to the legacy SSE encoded code
+//
+
+CPPROBOTPARSER_TARGET_AVX2 __m256i toLowerAvx2(__m256i chars)
+{
+    const __m256i isUpper = _mm256_and_si256(
+        _mm256_cmpgt_epi8(chars, _mm256_set1_epi8('A' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), chars)
+    );
+
+    return _mm256_or_si256(chars, _mm256_and_si256(isUpper, _mm256_set1_epi8(0x20)));
+}
+
+CPPROBOTPARSER_TARGET_AVX2 __m128i toLowerAvx2(__m128i chars)
+{
+    const __m128i isUpper = _mm_and_si128(
+        _mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1))
+    );
+
+    return _mm_or_si128(chars, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+}
+
+CPPROBOTPARSER_TARGET_AVX2 void toLowerAvx2(char* data, std::size_t size)
+{
+    std::size_t i = 0;
+
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), toLowerAvx2(chars));
+    }
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), toLowerAvx2(chars));
+    }
+
+    for (; i < size; ++i)
+    {
+        data[i] = asciiToLower(data[i]);
+    }
+}
+
+CPPROBOTPARSER_TARGET_AVX2 bool equalsLowercaseAvx2(const char* source, const char* lowercaseString, std::size_t size)
+{
+    std::size_t i = 0;
+
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i sourceChars = toLowerAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+        const __m256i lowercaseChars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lowercaseString + i));
+
+        if (static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(sourceChars, lowercaseChars))) != 0xFFFFFFFF)
+        {
+            return false;
+        }
+    }
+
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i sourceChars = toLowerAvx2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        const __m128i lowercaseChars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lowercaseString + i));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(sourceChars, lowercaseChars)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+
+    for (; i < size; ++i)
+    {
+        if (asciiToLower(source[i]) != lowercaseString[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+CPPROBOTPARSER_TARGET_AVX2 std::size_t findLowercaseAvx2(const char* source, std::size_t sourceSize, const char* lowercaseSubstring, std::size_t substringSize)
+{
+    const __m256i first = _mm256_set1_epi8(lowercaseSubstring[0]);
+    const __m256i last = _mm256_set1_epi8(lowercaseSubstring[substringSize - 1]);
+    std::size_t i = 0;
+
+    for (; i + substringSize - 1 + 32 <= sourceSize; i += 32)
+    {
+        const __m256i firstChars = toLowerAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+        const __m256i lastChars = toLowerAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + substringSize - 1)));
+
+        std::uint32_t candidates = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(firstChars, first), _mm256_cmpeq_epi8(lastChars, last))
+        ));
+
+        while (candidates != 0)
+        {
+            const std::size_t position = i + countTrailingZeros(candidates);
+
+            if (equalsLowercaseAvx2(source + position, lowercaseSubstring, substringSize))
+            {
+                return position;
+            }
+
+            candidates &= candidates - 1;
+        }
+    }
+
+    // the typical URL path is shorter than 32 candidate positions
+    for (; i + substringSize - 1 + 16 <= sourceSize; i += 16)
+    {
+        const __m128i firstChars = toLowerAvx2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        const __m128i lastChars = toLowerAvx2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + substringSize - 1)));
+
+        std::uint32_t candidates = static_cast<std::uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(firstChars, _mm256_castsi256_si128(first)), _mm_cmpeq_epi8(lastChars, _mm256_castsi256_si128(last)))
+        ));
+
+        while (candidates != 0)
+        {
+            const std::size_t position = i + countTrailingZeros(candidates);
+
+            if (equalsLowercaseAvx2(source + position, lowercaseSubstring, substringSize))
+            {
+                return position;
+            }
+
+            candidates &= candidates - 1;
+        }
+    }
+
+    return findLowercaseScalar<equalsLowercaseAvx2>(source, sourceSize, lowercaseSubstring, substringSize, i);
+}
+
+#endif
+
+const Kernels s_scalarKernels{ AsciiKernels::InstructionSet::Scalar, toLowerScalar, equalsLowercaseScalar, findLowercaseScalar };
+
+#ifdef CPPROBOTPARSER_X86
+const Kernels s_sse2Kernels{ AsciiKernels::InstructionSet::Sse2, toLowerSse2, equalsLowercaseSse2, findLowercaseSse2 };
+const Kernels s_avx2Kernels{ AsciiKernels::InstructionSet::Avx2, toLowerAvx2, equalsLowercaseAvx2, findLowercaseAvx2 };
+#endif
+
+bool isCpuSupported(AsciiKernels::InstructionSet instructionSet) noexcept
+{
+    if (instructionSet == AsciiKernels::InstructionSet::Scalar)
+    {
+        return true;
+    }
+
+#if defined(CPPROBOTPARSER_X86) && defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 1);
+
+    if (instructionSet == AsciiKernels::InstructionSet::Sse2)
+    {
+        return (info[3] & (1 << 26)) != 0;
+    }
+
+    // AVX2 also requires the OS to save the YMM registers
+    const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+
+    return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#elif defined(CPPROBOTPARSER_X86)
+    __builtin_cpu_init();
+
+    return instructionSet == AsciiKernels::InstructionSet::Sse2 ?
+        __builtin_cpu_supports("sse2") != 0 :
+        __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+const Kernels* kernelsFor(AsciiKernels::InstructionSet instructionSet) noexcept
+{
+#ifdef CPPROBOTPARSER_X86
+    switch (instructionSet)
+    {
+        case AsciiKernels::InstructionSet::Avx2: return &s_avx2Kernels;
+        case AsciiKernels::InstructionSet::Sse2: return &s_sse2Kernels;
+        default: break;
+    }
+#endif
+
+    (void)instructionSet;
+    return &s_scalarKernels;
+}
+
+std::atomic<const Kernels*> s_activeKernels{ nullptr };
+
+const Kernels& activeKernels() noexcept
+{
+    const Kernels* kernels = s_activeKernels.load(std::memory_order_relaxed);
+
+    if (kernels)
+    {
+        return *kernels;
+    }
+
+    // every thread racing here detects the same kernels
+    for (AsciiKernels::InstructionSet instructionSet : { AsciiKernels::InstructionSet::Avx2, AsciiKernels::InstructionSet::Sse2 })
+    {
+        if (isCpuSupported(instructionSet))
+        {
+            kernels = kernelsFor(instructionSet);
+            break;
+        }
+    }
+
+    kernels = kernels ? kernels : &s_scalarKernels;
+    s_activeKernels.store(kernels, std::memory_order_relaxed);
+
+    return *kernels;
+}
+
+}
+
+namespace cpprobotparser
+{
+
+AsciiKernels::InstructionSet AsciiKernels::instructionSet() noexcept
+{
+    return activeKernels().instructionSet;
+}
+
+bool AsciiKernels::setInstructionSet(InstructionSet instructionSet) noexcept
+{
+    if (!isSupported(instructionSet))
+    {
+        return false;
+    }
+
+    s_activeKernels.store(kernelsFor(instructionSet), std::memory_order_relaxed);
+    return true;
+}
+
+bool AsciiKernels::isSupported(InstructionSet instructionSet) noexcept
+{
+    return isCpuSupported(instructionSet);
+}
+
+void AsciiKernels::toLower(char* data, std::size_t size) noexcept
+{
+    activeKernels().toLower(data, size);
+}
+
+bool AsciiKernels::equalsLowercase(const char* source, const char* lowercaseString, std::size_t size) noexcept
+{
+    return activeKernels().equalsLowercase(source, lowercaseString, size);
+}
+
+std::size_t AsciiKernels::findLowercase(std::string_view source, std::string_view lowercaseSubstring) noexcept
+{
+    if (lowercaseSubstring.empty())
+    {
+        return 0;
+    }
+
+    if (lowercaseSubstring.size() > source.size())
+    {
+        return std::string_view::npos;
+    }
+
+    return activeKernels().findLowercase(source.data(), source.size(), lowercaseSubstring.data(), lowercaseSubstring.size());
+}
+
+}
\ No newline at end of file
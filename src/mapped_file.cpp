@@ -0,0 +1,186 @@
+﻿#include "mapped_file.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cpprobotparser
+{
+
+MappedFile::MappedFile() noexcept
+    : m_data(nullptr)
+    , m_size(0)
+    , m_releasedSize(0)
+#ifdef _WIN32
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::MappedFile(const std::string& filePath, AccessPattern accessPattern)
+    : MappedFile()
+{
+#ifdef _WIN32
+    (void)accessPattern;
+
+    m_file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    LARGE_INTEGER fileSize{};
+
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &fileSize))
+    {
+        unmap();
+        throw std::runtime_error("Cannot open the file: " + filePath);
+    }
+
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+
+    if (m_size == 0)
+    {
+        return;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    m_data = m_mapping ? static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+    if (!m_data)
+    {
+        unmap();
+        throw std::runtime_error("Cannot map the file: " + filePath);
+    }
+#else
+    const int file = ::open(filePath.c_str(), O_RDONLY);
+    struct stat fileStat{};
+
+    if (file == -1 || fstat(file, &fileStat) == -1)
+    {
+        if (file != -1)
+        {
+            close(file);
+        }
+
+        throw std::runtime_error("Cannot open the file: " + filePath);
+    }
+
+    const std::size_t size = static_cast<std::size_t>(fileStat.st_size);
+
+    if (size == 0)
+    {
+        close(file);
+        return;
+    }
+
+    // the mapping keeps the file referenced after the descriptor is closed
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error("Cannot map the file: " + filePath);
+    }
+
+    madvise(data, size, accessPattern == AccessPattern::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+    m_data = static_cast<const char*>(data);
+    m_size = size;
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : MappedFile()
+{
+    *this = std::move(other);
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == std::addressof(other))
+    {
+        return *this;
+    }
+
+    unmap();
+
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    m_releasedSize.store(other.m_releasedSize.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+
+#ifdef _WIN32
+    std::swap(m_file, other.m_file);
+    std::swap(m_mapping, other.m_mapping);
+#endif
+
+    return *this;
+}
+
+std::string_view MappedFile::content() const noexcept
+{
+    return m_data ? std::string_view(m_data, m_size) : std::string_view();
+}
+
+void MappedFile::release(std::size_t offset) const noexcept
+{
+#ifdef _WIN32
+    // the pages of the view are trimmed by the system under the memory pressure
+    (void)offset;
+#else
+    const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t releasedSize = std::min(offset, m_size) / pageSize * pageSize;
+    std::size_t previousSize = m_releasedSize.load(std::memory_order_relaxed);
+
+    // the concurrent callers claim the disjoint ranges
+    while (previousSize < releasedSize && !m_releasedSize.compare_exchange_weak(previousSize, releasedSize, std::memory_order_relaxed))
+    {
+    }
+
+    if (m_data && previousSize < releasedSize)
+    {
+        // the pages of the read-only file mapping are dropped and read from the file again on the next access
+        madvise(const_cast<char*>(m_data) + previousSize, releasedSize - previousSize, MADV_DONTNEED);
+    }
+#endif
+}
+
+void MappedFile::unmap() noexcept
+{
+#ifdef _WIN32
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+#else
+    if (m_data)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_releasedSize.store(0, std::memory_order_relaxed);
+}
+
+}
\ No newline at end of file
@@ -9,16 +9,6 @@ namespace cpprobotparser
 namespace
 {
 
-const std::map<std::string, WellKnownUserAgent> s_userAgent =
-{
-    { "googlebot", WellKnownUserAgent::GoogleBot },
-    { "yandex", WellKnownUserAgent::YandexBot },
-    { "mail.ru", WellKnownUserAgent::MailRuBot },
-    { "msnbot", WellKnownUserAgent::MsnBot },
-    { "slurp", WellKnownUserAgent::YahooBot },
-    { "*", WellKnownUserAgent::AllRobots }
-};
-
 const std::map<WellKnownUserAgent, std::string> s_userAgentByType =
 {
     { WellKnownUserAgent::GoogleBot, "googlebot" },
@@ -31,19 +21,24 @@ const std::map<WellKnownUserAgent, std::string> s_userAgentByType =
 
 }
 
-WellKnownUserAgent MetaRobotsHelpers::userAgent(const std::string& userAgentStr)
+WellKnownUserAgent MetaRobotsHelpers::userAgent(std::string_view userAgentStr)
 {
-    const std::string userAgentValidated = StringHelpers::trimmed(StringHelpers::toLower(userAgentStr));
-    const std::string fixedUserAgentStr = userAgentValidated == "robots" ? std::string("*") : userAgentValidated;
+    const std::string_view userAgentValidated = StringHelpers::trimmedView(userAgentStr);
 
-    const auto userAgentIterator = s_userAgent.find(fixedUserAgentStr);
+    if (StringHelpers::equalsLowercase(userAgentValidated, "robots"))
+    {
+        return WellKnownUserAgent::AllRobots;
+    }
 
-    if (userAgentIterator == s_userAgent.end())
+    for (const auto& [userAgentType, userAgentString] : s_userAgentByType)
     {
-        return WellKnownUserAgent::Unknown;
+        if (StringHelpers::equalsLowercase(userAgentValidated, userAgentString))
+        {
+            return userAgentType;
+        }
     }
 
-    return userAgentIterator->second;
+    return WellKnownUserAgent::Unknown;
 }
 
 std::string MetaRobotsHelpers::userAgentString(WellKnownUserAgent wellKnownUserAgent)
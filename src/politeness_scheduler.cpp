@@ -0,0 +1,429 @@
+﻿#include "politeness_scheduler.h"
+
+namespace cpprobotparser
+{
+
+class PolitenessScheduler::PolitenessSchedulerImpl final
+{
+private:
+    static constexpr std::uint32_t s_noEntry = std::numeric_limits<std::uint32_t>::max();
+
+    enum class HostState : std::uint8_t
+    {
+        // no URLs to fetch
+        Idle,
+
+        // in the list of the wheel slot of its next fetch tick
+        Waiting,
+
+        // in the ready queue
+        Ready,
+
+        // erased while in the ready queue, the entry is freed when it's taken from the queue
+        Erased,
+
+        // in the free list
+        Free
+    };
+
+    struct HostEntry
+    {
+        std::string host;
+        Clock::duration delay;
+        Clock::time_point nextFetchTime;
+
+        // the first tick when the fetch is allowed: the next fetch time rounded up to the tick
+        std::int64_t nextFetchTick;
+
+        // the doubly linked list of the wheel slot
+        std::uint32_t previous;
+        std::uint32_t next;
+
+        HostState state;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+
+        // the deque keeps the entries in place, so the index keys stay valid while the entries are added
+        std::deque<HostEntry> entries;
+        std::vector<std::uint32_t> freeEntries;
+        std::unordered_map<std::string_view, std::uint32_t> index;
+
+        // the heads of the slot lists, the host waits in the slot of nextFetchTick % wheelSize
+        std::vector<std::uint32_t> wheel;
+
+        // the ticks before this one are already processed
+        std::int64_t currentTick = 0;
+
+        std::deque<std::uint32_t> readyEntries;
+    };
+
+public:
+    PolitenessSchedulerImpl()
+    {
+        configure(Settings());
+    }
+
+    void configure(const Settings& settings)
+    {
+        m_settings = settings;
+        m_settings.shardCount = std::max<std::size_t>(m_settings.shardCount, 1);
+        m_settings.wheelSize = std::max<std::size_t>(m_settings.wheelSize, 1);
+        m_settings.tickDuration = std::max<Clock::duration>(m_settings.tickDuration, Clock::duration(1));
+        m_settings.maxDelay = std::max(m_settings.maxDelay, m_settings.minDelay);
+
+        m_epoch = now();
+        m_nextShard = 0;
+        m_shards.clear();
+
+        for (std::size_t i = 0; i < m_settings.shardCount; ++i)
+        {
+            m_shards.push_back(std::make_unique<Shard>());
+            m_shards.back()->wheel.assign(m_settings.wheelSize, s_noEntry);
+        }
+    }
+
+    void setDelay(std::string_view host, Clock::duration delay)
+    {
+        Shard& shard = shardFor(host);
+        const Clock::time_point currentTime = now();
+
+        std::lock_guard<std::mutex> locker(shard.mutex);
+
+        shard.entries[findOrAdd(shard, host, currentTime)].delay = delay;
+    }
+
+    Clock::duration delayFor(const RobotsTxtRules& rules, const UserAgentGroup& userAgentGroup) const noexcept
+    {
+        const Clock::duration fetchInterval = std::chrono::duration_cast<Clock::duration>(rules.fetchInterval(userAgentGroup));
+
+        return std::clamp(fetchInterval, m_settings.minDelay, m_settings.maxDelay);
+    }
+
+    void schedule(std::string_view host)
+    {
+        Shard& shard = shardFor(host);
+        const Clock::time_point currentTime = now();
+
+        std::lock_guard<std::mutex> locker(shard.mutex);
+
+        const std::uint32_t entryIndex = findOrAdd(shard, host, currentTime);
+        HostEntry& entry = shard.entries[entryIndex];
+
+        if (entry.state != HostState::Idle)
+        {
+            return;
+        }
+
+        if (entry.nextFetchTick < shard.currentTick)
+        {
+            // the tick is already processed
+            entry.state = HostState::Ready;
+            shard.readyEntries.push_back(entryIndex);
+            return;
+        }
+
+        entry.state = HostState::Waiting;
+        link(shard, entryIndex);
+    }
+
+    std::size_t readyHosts(std::vector<std::string>& hosts, std::size_t maxHosts)
+    {
+        const Clock::time_point currentTime = now();
+        const std::int64_t currentTick = elapsedTicks(currentTime);
+        const std::size_t firstShard = m_nextShard.fetch_add(1, std::memory_order_relaxed);
+        std::size_t count = 0;
+
+        // the shards are visited starting from the next one on every call, so no shard starves with small batches
+        for (std::size_t i = 0; i < m_shards.size() && count < maxHosts; ++i)
+        {
+            Shard& shard = *m_shards[(firstShard + i) % m_shards.size()];
+            std::lock_guard<std::mutex> locker(shard.mutex);
+
+            advance(shard, currentTick);
+
+            while (!shard.readyEntries.empty() && count < maxHosts)
+            {
+                const std::uint32_t entryIndex = shard.readyEntries.front();
+                shard.readyEntries.pop_front();
+
+                HostEntry& entry = shard.entries[entryIndex];
+
+                if (entry.state == HostState::Erased)
+                {
+                    free(shard, entryIndex);
+                    continue;
+                }
+
+                entry.state = HostState::Idle;
+                setNextFetchTime(entry, currentTime + entry.delay);
+                hosts.push_back(entry.host);
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    Clock::time_point nextFetchTime(std::string_view host) const
+    {
+        Shard& shard = shardFor(host);
+        const Clock::time_point currentTime = now();
+
+        std::lock_guard<std::mutex> locker(shard.mutex);
+
+        const auto indexIterator = shard.index.find(host);
+
+        return indexIterator == shard.index.end() ?
+            currentTime :
+            std::max(currentTime, shard.entries[indexIterator->second].nextFetchTime);
+    }
+
+    void erase(std::string_view host)
+    {
+        Shard& shard = shardFor(host);
+        std::lock_guard<std::mutex> locker(shard.mutex);
+
+        const auto indexIterator = shard.index.find(host);
+
+        if (indexIterator == shard.index.end())
+        {
+            return;
+        }
+
+        const std::uint32_t entryIndex = indexIterator->second;
+        HostEntry& entry = shard.entries[entryIndex];
+
+        shard.index.erase(indexIterator);
+
+        if (entry.state == HostState::Ready)
+        {
+            // the ready queue isn't searched, the entry is dropped when it's taken from the queue
+            entry.state = HostState::Erased;
+            return;
+        }
+
+        if (entry.state == HostState::Waiting)
+        {
+            unlink(shard, entryIndex);
+        }
+
+        free(shard, entryIndex);
+    }
+
+    std::size_t size() const
+    {
+        std::size_t result = 0;
+
+        for (const std::unique_ptr<Shard>& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> locker(shard->mutex);
+            result += shard->index.size();
+        }
+
+        return result;
+    }
+
+private:
+    Shard& shardFor(std::string_view host) const noexcept
+    {
+        return *m_shards[std::hash<std::string_view>()(host) % m_shards.size()];
+    }
+
+    Clock::time_point now() const
+    {
+        return m_settings.now ? m_settings.now() : Clock::now();
+    }
+
+    // the whole ticks passed since the epoch
+    std::int64_t elapsedTicks(Clock::time_point timePoint) const noexcept
+    {
+        return timePoint <= m_epoch ? 0 : (timePoint - m_epoch) / m_settings.tickDuration;
+    }
+
+    void setNextFetchTime(HostEntry& entry, Clock::time_point nextFetchTime) const noexcept
+    {
+        const std::int64_t ticks = elapsedTicks(nextFetchTime);
+
+        entry.nextFetchTime = nextFetchTime;
+        entry.nextFetchTick = m_epoch + ticks * m_settings.tickDuration < nextFetchTime ? ticks + 1 : ticks;
+    }
+
+    // the shard must be locked by the caller
+    std::uint32_t findOrAdd(Shard& shard, std::string_view host, Clock::time_point currentTime)
+    {
+        const auto indexIterator = shard.index.find(host);
+
+        if (indexIterator != shard.index.end())
+        {
+            return indexIterator->second;
+        }
+
+        std::uint32_t entryIndex = 0;
+
+        if (shard.freeEntries.empty())
+        {
+            entryIndex = static_cast<std::uint32_t>(shard.entries.size());
+            shard.entries.emplace_back();
+        }
+        else
+        {
+            entryIndex = shard.freeEntries.back();
+            shard.freeEntries.pop_back();
+        }
+
+        HostEntry& entry = shard.entries[entryIndex];
+        entry.host.assign(host.data(), host.size());
+        entry.delay = m_settings.minDelay;
+        entry.previous = s_noEntry;
+        entry.next = s_noEntry;
+        entry.state = HostState::Idle;
+        setNextFetchTime(entry, currentTime);
+
+        shard.index.emplace(entry.host, entryIndex);
+
+        return entryIndex;
+    }
+
+    // moves the hosts which fetch ticks are passed to the ready queue
+    // every slot is visited at most once even if the scheduler wasn't called for many wheel turns
+    void advance(Shard& shard, std::int64_t currentTick)
+    {
+        if (currentTick < shard.currentTick)
+        {
+            return;
+        }
+
+        const std::int64_t wheelSize = static_cast<std::int64_t>(m_settings.wheelSize);
+        const std::int64_t slotCount = std::min(currentTick - shard.currentTick + 1, wheelSize);
+
+        for (std::int64_t tick = shard.currentTick; tick < shard.currentTick + slotCount; ++tick)
+        {
+            std::uint32_t entryIndex = shard.wheel[static_cast<std::size_t>(tick % wheelSize)];
+
+            while (entryIndex != s_noEntry)
+            {
+                HostEntry& entry = shard.entries[entryIndex];
+                const std::uint32_t nextEntryIndex = entry.next;
+
+                // the hosts of the later wheel turns stay in the slot
+                if (entry.nextFetchTick <= currentTick)
+                {
+                    unlink(shard, entryIndex);
+                    entry.state = HostState::Ready;
+                    shard.readyEntries.push_back(entryIndex);
+                }
+
+                entryIndex = nextEntryIndex;
+            }
+        }
+
+        shard.currentTick = currentTick + 1;
+    }
+
+    void link(Shard& shard, std::uint32_t entryIndex) noexcept
+    {
+        HostEntry& entry = shard.entries[entryIndex];
+        std::uint32_t& head = shard.wheel[static_cast<std::size_t>(entry.nextFetchTick % static_cast<std::int64_t>(m_settings.wheelSize))];
+
+        entry.previous = s_noEntry;
+        entry.next = head;
+
+        if (head != s_noEntry)
+        {
+            shard.entries[head].previous = entryIndex;
+        }
+
+        head = entryIndex;
+    }
+
+    void unlink(Shard& shard, std::uint32_t entryIndex) noexcept
+    {
+        HostEntry& entry = shard.entries[entryIndex];
+
+        if (entry.previous != s_noEntry)
+        {
+            shard.entries[entry.previous].next = entry.next;
+        }
+        else
+        {
+            shard.wheel[static_cast<std::size_t>(entry.nextFetchTick % static_cast<std::int64_t>(m_settings.wheelSize))] = entry.next;
+        }
+
+        if (entry.next != s_noEntry)
+        {
+            shard.entries[entry.next].previous = entry.previous;
+        }
+
+        entry.previous = s_noEntry;
+        entry.next = s_noEntry;
+    }
+
+    static void free(Shard& shard, std::uint32_t entryIndex)
+    {
+        HostEntry& entry = shard.entries[entryIndex];
+
+        entry.state = HostState::Free;
+        entry.host.clear();
+        entry.host.shrink_to_fit();
+        shard.freeEntries.push_back(entryIndex);
+    }
+
+private:
+    Settings m_settings;
+    Clock::time_point m_epoch;
+    std::atomic<std::size_t> m_nextShard;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+PolitenessScheduler::PolitenessScheduler(const Settings& settings)
+    : PolitenessScheduler()
+{
+    m_impl->configure(settings);
+}
+
+PolitenessScheduler::PolitenessScheduler() = default;
+PolitenessScheduler::PolitenessScheduler(PolitenessScheduler&& other) = default;
+PolitenessScheduler::~PolitenessScheduler() = default;
+PolitenessScheduler& PolitenessScheduler::operator=(PolitenessScheduler&& other) = default;
+
+void PolitenessScheduler::setDelay(std::string_view host, Clock::duration delay)
+{
+    m_impl->setDelay(host, delay);
+}
+
+void PolitenessScheduler::setDelay(std::string_view host, const RobotsTxtRules& rules, const UserAgentGroup& userAgentGroup)
+{
+    m_impl->setDelay(host, m_impl->delayFor(rules, userAgentGroup));
+}
+
+void PolitenessScheduler::schedule(std::string_view host)
+{
+    m_impl->schedule(host);
+}
+
+std::size_t PolitenessScheduler::readyHosts(std::vector<std::string>& hosts, std::size_t maxHosts)
+{
+    return m_impl->readyHosts(hosts, maxHosts);
+}
+
+PolitenessScheduler::Clock::time_point PolitenessScheduler::nextFetchTime(std::string_view host) const
+{
+    return m_impl->nextFetchTime(host);
+}
+
+void PolitenessScheduler::erase(std::string_view host)
+{
+    m_impl->erase(host);
+}
+
+std::size_t PolitenessScheduler::size() const
+{
+    return m_impl->size();
+}
+
+}
\ No newline at end of file
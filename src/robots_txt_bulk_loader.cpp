@@ -0,0 +1,756 @@
+﻿#include "robots_txt_bulk_loader.h"
+#include "mapped_file.h"
+#include "string_helpers.h"
+#include "url_helpers.h"
+#include <filesystem>
+
+namespace
+{
+
+using namespace cpprobotparser;
+
+// the batch is closed when it has either many records or much content, so the stolen batches take the comparable time to parse
+constexpr std::size_t s_maxBatchRecords = 64;
+constexpr std::size_t s_maxBatchBytes = 256 * 1024;
+
+struct ArchiveRecord
+{
+    // the views into the mapped archive
+    std::string_view targetUri;
+    std::string_view content;
+};
+
+struct Batch
+{
+    std::vector<ArchiveRecord> records;
+
+    // the files of the directory are mapped by the parsing thread
+    std::vector<std::filesystem::path> filePaths;
+
+    std::size_t bytes = 0;
+
+    // the archive offset after the last record, the archive before it may be released when all previous batches are parsed
+    std::size_t endOffset = 0;
+    std::uint64_t sequenceNumber = 0;
+
+    // the number of the first record or file of the batch in the order of the input
+    std::uint64_t firstRecordNumber = 0;
+
+    std::size_t size() const noexcept
+    {
+        return records.size() + filePaths.size();
+    }
+};
+
+//! Splits the mapped WARC-like archive into the records, the record views point right into the archive
+class ArchiveReader final
+{
+public:
+    enum class Result
+    {
+        Record,
+        // the record is not a robots.txt file, e.g. "warcinfo" or "request" one
+        Ignored,
+        // the malformed record or the response which is neither 2xx nor 4xx
+        Skipped,
+        End
+    };
+
+    explicit ArchiveReader(std::string_view archive) noexcept
+        : m_archive(archive)
+        , m_offset(0)
+    {
+    }
+
+    //! returns the offset after the last read record
+    std::size_t offset() const noexcept
+    {
+        return m_offset;
+    }
+
+    Result next(ArchiveRecord& record)
+    {
+        while (m_offset < m_archive.size() && (m_archive[m_offset] == '\r' || m_archive[m_offset] == '\n'))
+        {
+            ++m_offset;
+        }
+
+        if (m_offset == m_archive.size())
+        {
+            return Result::End;
+        }
+
+        const std::string_view rest = m_archive.substr(m_offset);
+
+        if (!StringHelpers::startsWithLowercase(rest, "warc/"))
+        {
+            return resynchronize(m_offset);
+        }
+
+        const auto [headersSize, separatorSize] = headerBlockSize(rest);
+
+        if (headersSize == std::string_view::npos)
+        {
+            m_offset = m_archive.size();
+            return Result::Skipped;
+        }
+
+        std::string_view type;
+        std::string_view targetUri;
+        std::optional<std::size_t> contentLength;
+
+        forEachHeader(rest.substr(0, headersSize), [&](std::string_view name, std::string_view value)
+        {
+            if (StringHelpers::equalsLowercase(name, "warc-type"))
+            {
+                type = value;
+            }
+            else if (StringHelpers::equalsLowercase(name, "warc-target-uri"))
+            {
+                // WARC/0.18 puts the URI in the angle brackets
+                targetUri = value.size() >= 2 && value.front() == '<' && value.back() == '>' ? value.substr(1, value.size() - 2) : value;
+            }
+            else if (StringHelpers::equalsLowercase(name, "content-length"))
+            {
+                std::size_t length = 0;
+                const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+
+                if (error == std::errc() && end == value.data() + value.size())
+                {
+                    contentLength = length;
+                }
+            }
+        });
+
+        const std::size_t blockOffset = m_offset + headersSize + separatorSize;
+
+        if (!contentLength)
+        {
+            return resynchronize(blockOffset);
+        }
+
+        if (*contentLength > m_archive.size() - blockOffset)
+        {
+            // the truncated archive
+            m_offset = m_archive.size();
+            return Result::Skipped;
+        }
+
+        const std::string_view block = m_archive.substr(blockOffset, *contentLength);
+        m_offset = blockOffset + *contentLength;
+
+        if (StringHelpers::equalsLowercase(type, "resource"))
+        {
+            record = ArchiveRecord{ targetUri, block };
+            return targetUri.empty() ? Result::Skipped : Result::Record;
+        }
+
+        if (!StringHelpers::equalsLowercase(type, "response"))
+        {
+            return Result::Ignored;
+        }
+
+        if (targetUri.empty() || !StringHelpers::startsWithLowercase(block, "http/"))
+        {
+            return Result::Skipped;
+        }
+
+        const auto [responseHeadersSize, responseSeparatorSize] = headerBlockSize(block);
+        const std::size_t statusCode = statusCodeOf(block);
+
+        if (responseHeadersSize == std::string_view::npos || statusCode < 200 || statusCode >= 500 || (statusCode >= 300 && statusCode < 400))
+        {
+            return Result::Skipped;
+        }
+
+        // the unavailable robots.txt allows everything (RFC 9309, 2.3.1.3)
+        record = ArchiveRecord{
+            targetUri,
+            statusCode < 300 ? block.substr(responseHeadersSize + responseSeparatorSize) : std::string_view()
+        };
+
+        return Result::Record;
+    }
+
+private:
+    // skips the bytes up to the next line starting with "WARC/"
+    Result resynchronize(std::size_t from) noexcept
+    {
+        const std::size_t nextRecord = m_archive.find("\nWARC/", from);
+        m_offset = nextRecord == std::string_view::npos ? m_archive.size() : nextRecord + 1;
+
+        return Result::Skipped;
+    }
+
+    // returns the size of the header lines and the size of the empty line after them or npos if there is no empty line
+    // the block is the whole rest of the archive, so both line endings are looked for in one scan stopping at the first empty line,
+    // looking for each of them separately would scan the archive to its end for the one it doesn't use
+    static std::pair<std::size_t, std::size_t> headerBlockSize(std::string_view block) noexcept
+    {
+        for (std::size_t lineEnd = block.find('\n'); lineEnd != std::string_view::npos; lineEnd = block.find('\n', lineEnd + 1))
+        {
+            const std::string_view next = block.substr(lineEnd + 1, 2);
+
+            if (!next.empty() && next[0] == '\n')
+            {
+                return { lineEnd, 2 };
+            }
+
+            if (next == "\r\n" && lineEnd != 0 && block[lineEnd - 1] == '\r')
+            {
+                return { lineEnd - 1, 4 };
+            }
+        }
+
+        return { std::string_view::npos, 0 };
+    }
+
+    template <typename Function>
+    static void forEachHeader(std::string_view headers, const Function& function)
+    {
+        while (!headers.empty())
+        {
+            const std::size_t lineEnd = headers.find('\n');
+            const std::string_view line = headers.substr(0, lineEnd);
+            const std::size_t colon = line.find(':');
+
+            if (colon != std::string_view::npos)
+            {
+                function(StringHelpers::trimmedView(line.substr(0, colon)), StringHelpers::trimmedView(line.substr(colon + 1)));
+            }
+
+            headers.remove_prefix(lineEnd == std::string_view::npos ? headers.size() : lineEnd + 1);
+        }
+    }
+
+    // returns the status code of the "HTTP/1.1 200 OK" line or zero if it's malformed
+    static std::size_t statusCodeOf(std::string_view response) noexcept
+    {
+        const std::size_t codeOffset = response.find(' ');
+
+        if (codeOffset == std::string_view::npos || codeOffset + 4 > response.size())
+        {
+            return 0;
+        }
+
+        std::size_t statusCode = 0;
+        const char* codeBegin = response.data() + codeOffset + 1;
+        const auto [end, error] = std::from_chars(codeBegin, codeBegin + 3, statusCode);
+
+        return error == std::errc() && end == codeBegin + 3 ? statusCode : 0;
+    }
+
+private:
+    std::string_view m_archive;
+    std::size_t m_offset;
+};
+
+//! The threads parsing the batches. Every thread takes the batches from the front of its own queue
+//! and steals them from the back of the other queues when its own one is empty.
+//! The pushing thread waits while the number of the records not parsed yet reaches the limit.
+class ParsingPool final
+{
+public:
+    using Statistics = RobotsTxtBulkLoader::Statistics;
+    using BatchParser = std::function<void(Batch&, Statistics&)>;
+
+    ParsingPool(std::size_t threadCount, std::size_t maxPendingRecords, BatchParser batchParser, const MappedFile* archive)
+        : m_maxPendingRecords(std::max<std::size_t>(maxPendingRecords, 1))
+        , m_batchParser(std::move(batchParser))
+        , m_archive(archive)
+        , m_pendingRecords(0)
+        , m_queuedBatches(0)
+        , m_nextSequenceNumber(0)
+        , m_nextParsedSequenceNumber(0)
+        , m_nextQueue(0)
+        , m_finished(false)
+        , m_statistics(threadCount)
+    {
+        for (std::size_t i = 0; i < threadCount; ++i)
+        {
+            m_queues.push_back(std::make_unique<Queue>());
+        }
+
+        try
+        {
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                m_threads.emplace_back(&ParsingPool::run, this, i);
+            }
+        }
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    ~ParsingPool()
+    {
+        stop();
+    }
+
+    //! waits for the room for the batch and queues it, returns false if the parsing has failed and no more batches are needed
+    bool push(Batch&& batch)
+    {
+        Queue* queue = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            // the batch larger than the limit is still accepted when nothing is pending
+            m_spaceAvailable.wait(lock, [this]
+            {
+                return m_pendingRecords < m_maxPendingRecords || m_error;
+            });
+
+            if (m_error)
+            {
+                return false;
+            }
+
+            m_pendingRecords += batch.size();
+            batch.sequenceNumber = m_nextSequenceNumber++;
+            queue = m_queues[m_nextQueue++ % m_queues.size()].get();
+        }
+
+        {
+            std::lock_guard<std::mutex> queueLock(queue->mutex);
+            queue->batches.push_back(std::move(batch));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_queuedBatches;
+        }
+
+        m_batchAvailable.notify_one();
+
+        return true;
+    }
+
+    //! waits until all queued batches are parsed and returns the statistics of all threads
+    //! rethrows the first exception thrown by the batch parser
+    Statistics finish()
+    {
+        stop();
+
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+
+        Statistics result;
+
+        for (const Statistics& statistics : m_statistics)
+        {
+            result.records += statistics.records;
+            result.bytes += statistics.bytes;
+            result.skippedRecords += statistics.skippedRecords;
+            result.failedFiles += statistics.failedFiles;
+            result.stolenBatches += statistics.stolenBatches;
+        }
+
+        return result;
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Batch> batches;
+    };
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished = true;
+        }
+
+        m_batchAvailable.notify_all();
+
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+
+        m_threads.clear();
+    }
+
+    void run(std::size_t threadIndex)
+    {
+        Statistics& statistics = m_statistics[threadIndex];
+        Batch batch;
+
+        while (take(threadIndex, batch, statistics))
+        {
+            try
+            {
+                // the rest of the batches are dropped after the failure
+                if (!hasFailed())
+                {
+                    m_batchParser(batch, statistics);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                if (!m_error)
+                {
+                    m_error = std::current_exception();
+                }
+            }
+
+            complete(batch);
+        }
+    }
+
+    bool take(std::size_t threadIndex, Batch& batch, Statistics& statistics)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_batchAvailable.wait(lock, [this]
+            {
+                return m_queuedBatches != 0 || m_finished;
+            });
+
+            if (m_queuedBatches == 0)
+            {
+                return false;
+            }
+
+            // one of the queues has the batch reserved for this thread
+            --m_queuedBatches;
+        }
+
+        for (;;)
+        {
+            for (std::size_t i = 0; i < m_queues.size(); ++i)
+            {
+                Queue& queue = *m_queues[(threadIndex + i) % m_queues.size()];
+                std::lock_guard<std::mutex> queueLock(queue.mutex);
+
+                if (queue.batches.empty())
+                {
+                    continue;
+                }
+
+                // the owner takes the oldest batch, so the archive before it is released soon,
+                // the thief takes the latest one from the other end of the queue
+                if (i == 0)
+                {
+                    batch = std::move(queue.batches.front());
+                    queue.batches.pop_front();
+                }
+                else
+                {
+                    batch = std::move(queue.batches.back());
+                    queue.batches.pop_back();
+                    ++statistics.stolenBatches;
+                }
+
+                return true;
+            }
+        }
+    }
+
+    void complete(const Batch& batch)
+    {
+        std::size_t releasedOffset = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_pendingRecords -= batch.size();
+
+            if (m_archive)
+            {
+                m_parsedBatchEndOffsets.emplace(batch.sequenceNumber, batch.endOffset);
+
+                // the archive is released up to the end of the longest run of the parsed batches
+                while (!m_parsedBatchEndOffsets.empty() && m_parsedBatchEndOffsets.begin()->first == m_nextParsedSequenceNumber)
+                {
+                    releasedOffset = m_parsedBatchEndOffsets.begin()->second;
+                    m_parsedBatchEndOffsets.erase(m_parsedBatchEndOffsets.begin());
+                    ++m_nextParsedSequenceNumber;
+                }
+            }
+        }
+
+        m_spaceAvailable.notify_one();
+
+        if (releasedOffset != 0)
+        {
+            m_archive->release(releasedOffset);
+        }
+    }
+
+    bool hasFailed()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_error != nullptr;
+    }
+
+private:
+    const std::size_t m_maxPendingRecords;
+    const BatchParser m_batchParser;
+    const MappedFile* m_archive;
+
+    std::mutex m_mutex;
+    std::condition_variable m_batchAvailable;
+    std::condition_variable m_spaceAvailable;
+
+    std::size_t m_pendingRecords;
+    std::size_t m_queuedBatches;
+    std::uint64_t m_nextSequenceNumber;
+    std::uint64_t m_nextParsedSequenceNumber;
+    std::map<std::uint64_t, std::size_t> m_parsedBatchEndOffsets;
+    std::size_t m_nextQueue;
+    bool m_finished;
+    std::exception_ptr m_error;
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<Statistics> m_statistics;
+    std::vector<std::thread> m_threads;
+};
+
+}
+
+namespace cpprobotparser
+{
+
+class RobotsTxtBulkLoader::RobotsTxtBulkLoaderImpl final
+{
+public:
+    void configure(const Settings& settings)
+    {
+        m_settings = settings;
+    }
+
+    Statistics load(const std::string& path, const Consumer& consumer) const
+    {
+        std::error_code error;
+
+        return std::filesystem::is_directory(path, error) ? loadDirectory(path, consumer) : loadArchive(path, consumer);
+    }
+
+private:
+    Statistics loadArchive(const std::string& filePath, const Consumer& consumer) const
+    {
+        const MappedFile archive(filePath, MappedFile::AccessPattern::Sequential);
+
+        ParsingPool pool(threadCount(), m_settings.maxPendingRecords, [this, &consumer](Batch& batch, Statistics& statistics)
+        {
+            for (std::size_t i = 0; i < batch.records.size(); ++i)
+            {
+                const ArchiveRecord& record = batch.records[i];
+
+                consumer(UrlHelpers::origin(record.targetUri), parse(record.content), batch.firstRecordNumber + i);
+
+                ++statistics.records;
+                statistics.bytes += record.content.size();
+            }
+        }, &archive);
+
+        ArchiveReader reader(archive.content());
+        ArchiveRecord record;
+        Batch batch;
+        std::uint64_t recordCount = 0;
+        std::size_t skippedRecords = 0;
+
+        for (ArchiveReader::Result result = reader.next(record); result != ArchiveReader::Result::End; result = reader.next(record))
+        {
+            if (result == ArchiveReader::Result::Skipped)
+            {
+                ++skippedRecords;
+            }
+
+            if (result != ArchiveReader::Result::Record)
+            {
+                continue;
+            }
+
+            batch.records.push_back(record);
+            batch.bytes += record.content.size();
+            ++recordCount;
+
+            if (batch.records.size() == s_maxBatchRecords || batch.bytes >= s_maxBatchBytes)
+            {
+                batch.endOffset = reader.offset();
+
+                if (!pool.push(std::move(batch)))
+                {
+                    break;
+                }
+
+                batch = Batch();
+                batch.firstRecordNumber = recordCount;
+            }
+        }
+
+        if (batch.size() != 0)
+        {
+            batch.endOffset = reader.offset();
+            pool.push(std::move(batch));
+        }
+
+        Statistics statistics = pool.finish();
+        statistics.skippedRecords += skippedRecords;
+
+        return statistics;
+    }
+
+    Statistics loadDirectory(const std::string& directoryPath, const Consumer& consumer) const
+    {
+        std::error_code error;
+        std::filesystem::recursive_directory_iterator directoryIterator(directoryPath, std::filesystem::directory_options::skip_permission_denied, error);
+
+        if (error)
+        {
+            throw std::runtime_error("Cannot read the directory " + directoryPath + ": " + error.message());
+        }
+
+        ParsingPool pool(threadCount(), m_settings.maxPendingRecords, [this, &consumer](Batch& batch, Statistics& statistics)
+        {
+            for (std::size_t i = 0; i < batch.filePaths.size(); ++i)
+            {
+                const std::filesystem::path& filePath = batch.filePaths[i];
+                MappedFile file;
+
+                try
+                {
+                    file = MappedFile(filePath.string(), MappedFile::AccessPattern::Sequential);
+                }
+                catch (const std::runtime_error&)
+                {
+                    // e.g. the file is removed or its permissions are changed after it's listed
+                    ++statistics.failedFiles;
+                    continue;
+                }
+
+                // the file name is the host, the key is its origin as for the archive records
+                const std::filesystem::path name = filePath.extension() == ".txt" ? filePath.stem() : filePath.filename();
+
+                consumer(UrlHelpers::origin(name.string()), parse(file.content()), batch.firstRecordNumber + i);
+
+                ++statistics.records;
+                statistics.bytes += file.content().size();
+            }
+        }, nullptr);
+
+        Batch batch;
+        std::uint64_t fileCount = 0;
+        std::size_t failedFiles = 0;
+
+        while (directoryIterator != std::filesystem::recursive_directory_iterator())
+        {
+            std::error_code entryError;
+
+            if (directoryIterator->is_regular_file(entryError))
+            {
+                batch.filePaths.push_back(directoryIterator->path());
+                ++fileCount;
+            }
+
+            if (batch.filePaths.size() == s_maxBatchRecords)
+            {
+                if (!pool.push(std::move(batch)))
+                {
+                    break;
+                }
+
+                batch = Batch();
+                batch.firstRecordNumber = fileCount;
+            }
+
+            directoryIterator.increment(error);
+
+            if (error)
+            {
+                // the iterator can't go on after the failure, the files listed before it are parsed
+                ++failedFiles;
+                break;
+            }
+        }
+
+        if (batch.size() != 0)
+        {
+            pool.push(std::move(batch));
+        }
+
+        Statistics statistics = pool.finish();
+        statistics.failedFiles += failedFiles;
+
+        return statistics;
+    }
+
+    RobotsTxtRulesSnapshot parse(std::string_view content) const
+    {
+        auto rules = std::make_shared<RobotsTxtRules>();
+
+        if (m_settings.maxContentSize != 0)
+        {
+            rules->setMaxContentSize(m_settings.maxContentSize);
+        }
+
+        rules->feed(content);
+        rules->finish();
+
+        return rules;
+    }
+
+    std::size_t threadCount() const noexcept
+    {
+        if (m_settings.threadCount != 0)
+        {
+            return m_settings.threadCount;
+        }
+
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+private:
+    Settings m_settings;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+RobotsTxtBulkLoader::RobotsTxtBulkLoader(const Settings& settings)
+    : RobotsTxtBulkLoader()
+{
+    m_impl->configure(settings);
+}
+
+RobotsTxtBulkLoader::RobotsTxtBulkLoader() = default;
+RobotsTxtBulkLoader::~RobotsTxtBulkLoader() = default;
+
+RobotsTxtBulkLoader::Statistics RobotsTxtBulkLoader::load(const std::string& path, const Consumer& consumer) const
+{
+    return m_impl->load(path, consumer);
+}
+
+RobotsTxtBulkLoader::Statistics RobotsTxtBulkLoader::load(const std::string& path, RobotsTxtCache& cache, RobotsTxtCache::Clock::duration timeToLive) const
+{
+    // the number of the latest record inserted for every key, the rules of the earlier records parsed later are dropped
+    std::mutex mutex;
+    std::unordered_map<std::string, std::uint64_t> latestRecordNumbers;
+
+    return m_impl->load(path, [&cache, timeToLive, &mutex, &latestRecordNumbers](const std::string& key, RobotsTxtRulesSnapshot rules, std::uint64_t recordNumber)
+    {
+        const std::size_t approximateBytes = rules->memoryUsage();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto [latestRecordNumber, isFirstRecord] = latestRecordNumbers.emplace(key, recordNumber);
+
+        if (isFirstRecord || latestRecordNumber->second < recordNumber)
+        {
+            latestRecordNumber->second = recordNumber;
+            cache.insert(key, std::move(rules), approximateBytes, timeToLive);
+        }
+    });
+}
+
+}
\ No newline at end of file
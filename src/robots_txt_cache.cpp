@@ -0,0 +1,251 @@
+﻿#include "robots_txt_cache.h"
+
+namespace cpprobotparser
+{
+
+class RobotsTxtCache::RobotsTxtCacheImpl final
+{
+private:
+    struct CacheEntry
+    {
+        std::string origin;
+        RulesPointer rules;
+        std::size_t bytes;
+        Clock::time_point expiresAt;
+    };
+
+    using CacheEntries = std::list<CacheEntry>;
+
+    struct Shard
+    {
+        std::mutex mutex;
+
+        // the most recently used entry goes first
+        CacheEntries entries;
+
+        // the keys are views into the origins owned by the entries
+        std::unordered_map<std::string_view, CacheEntries::iterator> index;
+
+        std::size_t bytes = 0;
+    };
+
+public:
+    RobotsTxtCacheImpl()
+    {
+        configure(Settings());
+    }
+
+    void configure(const Settings& settings)
+    {
+        m_settings = settings;
+        m_settings.shardCount = std::max<std::size_t>(m_settings.shardCount, 1);
+
+        // rounded up without the overflow of the unlimited values
+        m_shardMaxEntries = std::max<std::size_t>(m_settings.maxEntries / m_settings.shardCount + (m_settings.maxEntries % m_settings.shardCount != 0), 1);
+        m_shardMaxBytes = m_settings.maxBytes / m_settings.shardCount + (m_settings.maxBytes % m_settings.shardCount != 0);
+
+        m_shards.clear();
+
+        for (std::size_t i = 0; i < m_settings.shardCount; ++i)
+        {
+            m_shards.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    RulesPointer find(std::string_view origin) const
+    {
+        Shard& shard = shardFor(origin);
+        const Clock::time_point currentTime = now();
+
+        std::lock_guard<std::mutex> locker(shard.mutex);
+
+        const auto indexIterator = shard.index.find(origin);
+
+        if (indexIterator == shard.index.end())
+        {
+            return nullptr;
+        }
+
+        const CacheEntries::iterator entryIterator = indexIterator->second;
+
+        if (entryIterator->expiresAt <= currentTime)
+        {
+            erase(shard, entryIterator);
+            return nullptr;
+        }
+
+        shard.entries.splice(shard.entries.begin(), shard.entries, entryIterator);
+        return entryIterator->rules;
+    }
+
+    RulesPointer insert(std::string_view origin, const std::string& robotsTxtContent, Clock::duration timeToLive)
+    {
+        // the parsing is done outside of the shard lock
+        RulesPointer rules = std::make_shared<const RobotsTxtRules>(robotsTxtContent);
+        insert(origin, rules, rules->memoryUsage(), timeToLive);
+
+        return rules;
+    }
+
+    void insert(std::string_view origin, RulesPointer rules, std::size_t approximateBytes, Clock::duration timeToLive)
+    {
+        Shard& shard = shardFor(origin);
+        const Clock::time_point expiresAt = now() + timeToLive;
+        const std::size_t bytes = approximateBytes + origin.size() + sizeof(CacheEntry);
+
+        std::lock_guard<std::mutex> locker(shard.mutex);
+
+        const auto indexIterator = shard.index.find(origin);
+
+        if (indexIterator != shard.index.end())
+        {
+            erase(shard, indexIterator->second);
+        }
+
+        shard.entries.push_front(CacheEntry{ std::string(origin), std::move(rules), bytes, expiresAt });
+        shard.index.emplace(shard.entries.front().origin, shard.entries.begin());
+        shard.bytes += bytes;
+
+        // the newly inserted entry is kept even if it exceeds the byte budget by itself
+        while (shard.entries.size() > m_shardMaxEntries || (shard.bytes > m_shardMaxBytes && shard.entries.size() > 1))
+        {
+            erase(shard, std::prev(shard.entries.end()));
+        }
+    }
+
+    void erase(std::string_view origin)
+    {
+        Shard& shard = shardFor(origin);
+        std::lock_guard<std::mutex> locker(shard.mutex);
+
+        const auto indexIterator = shard.index.find(origin);
+
+        if (indexIterator != shard.index.end())
+        {
+            erase(shard, indexIterator->second);
+        }
+    }
+
+    void clear()
+    {
+        for (const std::unique_ptr<Shard>& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> locker(shard->mutex);
+
+            shard->index.clear();
+            shard->entries.clear();
+            shard->bytes = 0;
+        }
+    }
+
+    std::size_t size() const
+    {
+        std::size_t result = 0;
+
+        for (const std::unique_ptr<Shard>& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> locker(shard->mutex);
+            result += shard->entries.size();
+        }
+
+        return result;
+    }
+
+    std::size_t bytes() const
+    {
+        std::size_t result = 0;
+
+        for (const std::unique_ptr<Shard>& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> locker(shard->mutex);
+            result += shard->bytes;
+        }
+
+        return result;
+    }
+
+    Clock::duration timeToLive() const noexcept
+    {
+        return m_settings.timeToLive;
+    }
+
+private:
+    Shard& shardFor(std::string_view origin) const noexcept
+    {
+        return *m_shards[std::hash<std::string_view>()(origin) % m_shards.size()];
+    }
+
+    Clock::time_point now() const
+    {
+        return m_settings.now ? m_settings.now() : Clock::now();
+    }
+
+    // the shard must be locked by the caller
+    static void erase(Shard& shard, CacheEntries::iterator entryIterator)
+    {
+        shard.bytes -= entryIterator->bytes;
+        shard.index.erase(entryIterator->origin);
+        shard.entries.erase(entryIterator);
+    }
+
+private:
+    Settings m_settings;
+    std::size_t m_shardMaxEntries;
+    std::size_t m_shardMaxBytes;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+RobotsTxtCache::RobotsTxtCache(const Settings& settings)
+    : RobotsTxtCache()
+{
+    m_impl->configure(settings);
+}
+
+RobotsTxtCache::RobotsTxtCache() = default;
+RobotsTxtCache::RobotsTxtCache(RobotsTxtCache&& other) = default;
+RobotsTxtCache::~RobotsTxtCache() = default;
+RobotsTxtCache& RobotsTxtCache::operator=(RobotsTxtCache&& other) = default;
+
+RobotsTxtCache::RulesPointer RobotsTxtCache::find(std::string_view origin) const
+{
+    return m_impl->find(origin);
+}
+
+RobotsTxtCache::RulesPointer RobotsTxtCache::insert(std::string_view origin, const std::string& robotsTxtContent)
+{
+    return m_impl->insert(origin, robotsTxtContent, m_impl->timeToLive());
+}
+
+RobotsTxtCache::RulesPointer RobotsTxtCache::insert(std::string_view origin, const std::string& robotsTxtContent, Clock::duration timeToLive)
+{
+    return m_impl->insert(origin, robotsTxtContent, timeToLive);
+}
+
+void RobotsTxtCache::insert(std::string_view origin, RulesPointer rules, std::size_t approximateBytes, Clock::duration timeToLive)
+{
+    m_impl->insert(origin, std::move(rules), approximateBytes, timeToLive);
+}
+
+void RobotsTxtCache::erase(std::string_view origin)
+{
+    m_impl->erase(origin);
+}
+
+void RobotsTxtCache::clear()
+{
+    m_impl->clear();
+}
+
+std::size_t RobotsTxtCache::size() const
+{
+    return m_impl->size();
+}
+
+std::size_t RobotsTxtCache::bytes() const
+{
+    return m_impl->bytes();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,418 @@
+﻿#include "robots_txt_metrics.h"
+#include "metrics_recorder.h"
+#include <cstdio>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+
+using namespace cpprobotparser;
+
+// the values below 16 have their own buckets, every next power of two up to 2^63 has 8 buckets
+constexpr std::size_t s_linearBucketCount = 16;
+constexpr unsigned s_subBucketBits = 3;
+constexpr unsigned s_firstLogExponent = 4;
+constexpr std::size_t s_bucketCount = s_linearBucketCount + (64 - s_firstLogExponent) * (std::size_t(1) << s_subBucketBits);
+
+// the stripes are taken by the threads in turn, so the threads rarely write to the same cache lines
+constexpr std::size_t s_stripeCount = 8;
+
+unsigned highestBit(std::uint64_t value) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+std::size_t bucketIndex(std::uint64_t value) noexcept
+{
+    if (value < s_linearBucketCount)
+    {
+        return static_cast<std::size_t>(value);
+    }
+
+    const unsigned exponent = highestBit(value);
+    const std::size_t subBucket = static_cast<std::size_t>(value >> (exponent - s_subBucketBits)) & ((std::size_t(1) << s_subBucketBits) - 1);
+
+    return s_linearBucketCount + ((exponent - s_firstLogExponent) << s_subBucketBits) + subBucket;
+}
+
+MetricsHistogram::Bucket bucketBounds(std::size_t index) noexcept
+{
+    if (index < s_linearBucketCount)
+    {
+        return MetricsHistogram::Bucket{ index, index, 0 };
+    }
+
+    const unsigned exponent = static_cast<unsigned>((index - s_linearBucketCount) >> s_subBucketBits) + s_firstLogExponent;
+    const std::uint64_t subBucket = (index - s_linearBucketCount) & ((std::size_t(1) << s_subBucketBits) - 1);
+    const std::uint64_t width = std::uint64_t(1) << (exponent - s_subBucketBits);
+    const std::uint64_t lowerBound = (std::uint64_t(1) << exponent) + subBucket * width;
+
+    return MetricsHistogram::Bucket{ lowerBound, lowerBound + (width - 1), 0 };
+}
+
+struct AtomicHistogram
+{
+    std::array<std::atomic<std::uint64_t>, s_bucketCount> buckets;
+    std::atomic<std::uint64_t> sum;
+
+    void record(std::uint64_t value) noexcept
+    {
+        buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+    }
+};
+
+struct alignas(64) Stripe
+{
+    std::array<std::atomic<std::uint64_t>, MetricsRecorder::counterCount> counters;
+    AtomicHistogram parseNanoseconds;
+    AtomicHistogram evaluateNanoseconds;
+    AtomicHistogram rulesScannedPerCheck;
+};
+
+// zero initialized as the static storage
+std::array<Stripe, s_stripeCount> s_stripes;
+std::atomic<std::size_t> s_nextStripe(0);
+
+Stripe& threadStripe() noexcept
+{
+    thread_local const std::size_t stripeIndex = s_nextStripe.fetch_add(1, std::memory_order_relaxed) % s_stripeCount;
+    return s_stripes[stripeIndex];
+}
+
+MetricsHistogram histogramSnapshot(AtomicHistogram Stripe::* histogram)
+{
+    MetricsHistogram result;
+
+    for (std::size_t i = 0; i < s_bucketCount; ++i)
+    {
+        std::uint64_t count = 0;
+
+        for (const Stripe& stripe : s_stripes)
+        {
+            count += (stripe.*histogram).buckets[i].load(std::memory_order_relaxed);
+        }
+
+        if (count != 0)
+        {
+            MetricsHistogram::Bucket bucket = bucketBounds(i);
+            bucket.count = count;
+
+            result.buckets.push_back(bucket);
+            result.count += count;
+        }
+    }
+
+    for (const Stripe& stripe : s_stripes)
+    {
+        result.sum += (stripe.*histogram).sum.load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+void appendPrometheusCounter(std::string& output, const char* name, const char* help, std::uint64_t value)
+{
+    output += std::string("# HELP ") + name + ' ' + help + "\n# TYPE " + name + " counter\n" + name + ' ' + std::to_string(value) + '\n';
+}
+
+// the cumulative buckets end at 2^k - 1, the upper bounds of the log-linear buckets, so the counts are exact
+// the values are divided by the scale, e.g. the nanoseconds are exported as seconds
+void appendPrometheusHistogram(
+    std::string& output,
+    const char* name,
+    const char* help,
+    const MetricsHistogram& histogram,
+    unsigned firstExponent,
+    unsigned lastExponent,
+    double scale)
+{
+    const auto format = [](double value)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        return std::string(buffer);
+    };
+
+    output += std::string("# HELP ") + name + ' ' + help + "\n# TYPE " + name + " histogram\n";
+
+    std::size_t bucket = 0;
+    std::uint64_t cumulativeCount = 0;
+
+    for (unsigned exponent = firstExponent; exponent <= lastExponent; ++exponent)
+    {
+        const std::uint64_t upperBound = (std::uint64_t(1) << exponent) - 1;
+
+        for (; bucket < histogram.buckets.size() && histogram.buckets[bucket].upperBound <= upperBound; ++bucket)
+        {
+            cumulativeCount += histogram.buckets[bucket].count;
+        }
+
+        output += std::string(name) + "_bucket{le=\"" + format(static_cast<double>(upperBound) / scale) + "\"} " + std::to_string(cumulativeCount) + '\n';
+    }
+
+    output += std::string(name) + "_bucket{le=\"+Inf\"} " + std::to_string(histogram.count) + '\n';
+    output += std::string(name) + "_sum " + format(static_cast<double>(histogram.sum) / scale) + '\n';
+    output += std::string(name) + "_count " + std::to_string(histogram.count) + '\n';
+}
+
+void appendJsonHistogram(std::string& output, const char* name, const MetricsHistogram& histogram)
+{
+    output += std::string("\"") + name + "\":{" +
+        "\"count\":" + std::to_string(histogram.count) +
+        ",\"sum\":" + std::to_string(histogram.sum) +
+        ",\"p50\":" + std::to_string(histogram.quantile(0.5)) +
+        ",\"p99\":" + std::to_string(histogram.quantile(0.99)) +
+        ",\"p999\":" + std::to_string(histogram.quantile(0.999)) +
+        ",\"buckets\":[";
+
+    for (std::size_t i = 0; i < histogram.buckets.size(); ++i)
+    {
+        const MetricsHistogram::Bucket& bucket = histogram.buckets[i];
+
+        output += (i == 0 ? "[" : ",[") +
+            std::to_string(bucket.lowerBound) + ',' + std::to_string(bucket.upperBound) + ',' + std::to_string(bucket.count) + ']';
+    }
+
+    output += "]}";
+}
+
+}
+
+namespace cpprobotparser
+{
+
+std::atomic<bool> MetricsRecorder::s_enabled(false);
+
+void MetricsRecorder::add(Counter counter, std::uint64_t value) noexcept
+{
+    threadStripe().counters[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void MetricsRecorder::recordParse(std::uint64_t nanoseconds) noexcept
+{
+    threadStripe().parseNanoseconds.record(nanoseconds);
+}
+
+void MetricsRecorder::recordEvaluation(std::uint64_t nanoseconds, std::uint64_t rulesScanned) noexcept
+{
+    Stripe& stripe = threadStripe();
+
+    stripe.evaluateNanoseconds.record(nanoseconds);
+    stripe.rulesScannedPerCheck.record(rulesScanned);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void MetricsHistogram::record(std::uint64_t value)
+{
+    const Bucket bounds = bucketBounds(bucketIndex(value));
+
+    const auto bucket = std::lower_bound(buckets.begin(), buckets.end(), bounds.lowerBound,
+        [](const Bucket& bucket, std::uint64_t lowerBound) { return bucket.lowerBound < lowerBound; });
+
+    if (bucket != buckets.end() && bucket->lowerBound == bounds.lowerBound)
+    {
+        ++bucket->count;
+    }
+    else
+    {
+        buckets.insert(bucket, Bucket{ bounds.lowerBound, bounds.upperBound, 1 });
+    }
+
+    ++count;
+    sum += value;
+}
+
+void MetricsHistogram::merge(const MetricsHistogram& other)
+{
+    std::vector<Bucket> mergedBuckets;
+    mergedBuckets.reserve(buckets.size() + other.buckets.size());
+
+    auto bucket = buckets.begin();
+    auto otherBucket = other.buckets.begin();
+
+    while (bucket != buckets.end() || otherBucket != other.buckets.end())
+    {
+        if (otherBucket == other.buckets.end() || (bucket != buckets.end() && bucket->lowerBound < otherBucket->lowerBound))
+        {
+            mergedBuckets.push_back(*bucket++);
+        }
+        else if (bucket == buckets.end() || otherBucket->lowerBound < bucket->lowerBound)
+        {
+            mergedBuckets.push_back(*otherBucket++);
+        }
+        else
+        {
+            mergedBuckets.push_back(Bucket{ bucket->lowerBound, bucket->upperBound, bucket->count + otherBucket->count });
+            ++bucket;
+            ++otherBucket;
+        }
+    }
+
+    buckets = std::move(mergedBuckets);
+    count += other.count;
+    sum += other.sum;
+}
+
+std::uint64_t MetricsHistogram::quantile(double quantile) const noexcept
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    const double clampedQuantile = std::min(std::max(quantile, 0.0), 1.0);
+    const std::uint64_t rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(clampedQuantile * static_cast<double>(count))), 1);
+    std::uint64_t seen = 0;
+
+    for (const Bucket& bucket : buckets)
+    {
+        seen += bucket.count;
+
+        if (seen >= rank)
+        {
+            return bucket.upperBound;
+        }
+    }
+
+    return buckets.back().upperBound;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool RobotsTxtMetrics::isAvailable() noexcept
+{
+#ifdef CPPROBOTPARSER_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RobotsTxtMetrics::setEnabled(bool enabled) noexcept
+{
+    MetricsRecorder::s_enabled.store(enabled && isAvailable(), std::memory_order_relaxed);
+}
+
+bool RobotsTxtMetrics::isEnabled() noexcept
+{
+    return MetricsRecorder::isEnabled();
+}
+
+RobotsTxtMetrics::Snapshot RobotsTxtMetrics::snapshot()
+{
+    const auto stripesSum = [](MetricsRecorder::Counter counter)
+    {
+        std::uint64_t value = 0;
+
+        for (const Stripe& stripe : s_stripes)
+        {
+            value += stripe.counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+        }
+
+        return value;
+    };
+
+    Snapshot result;
+    result.counters.evaluations = stripesSum(MetricsRecorder::Counter::Evaluations);
+    result.counters.allowMatches = stripesSum(MetricsRecorder::Counter::AllowMatches);
+    result.counters.disallowMatches = stripesSum(MetricsRecorder::Counter::DisallowMatches);
+    result.counters.noMatches = stripesSum(MetricsRecorder::Counter::NoMatches);
+    result.counters.fallbacks = stripesSum(MetricsRecorder::Counter::Fallbacks);
+    result.counters.rulesScanned = stripesSum(MetricsRecorder::Counter::RulesScanned);
+    result.counters.exceptionsAvoided = stripesSum(MetricsRecorder::Counter::ExceptionsAvoided);
+    result.counters.parseNanoseconds = stripesSum(MetricsRecorder::Counter::ParseNanoseconds);
+    result.parseNanoseconds = histogramSnapshot(&Stripe::parseNanoseconds);
+    result.evaluateNanoseconds = histogramSnapshot(&Stripe::evaluateNanoseconds);
+    result.rulesScannedPerCheck = histogramSnapshot(&Stripe::rulesScannedPerCheck);
+
+    return result;
+}
+
+void RobotsTxtMetrics::reset() noexcept
+{
+    const auto resetHistogram = [](AtomicHistogram& histogram)
+    {
+        for (std::atomic<std::uint64_t>& bucket : histogram.buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+
+        histogram.sum.store(0, std::memory_order_relaxed);
+    };
+
+    for (Stripe& stripe : s_stripes)
+    {
+        for (std::atomic<std::uint64_t>& counter : stripe.counters)
+        {
+            counter.store(0, std::memory_order_relaxed);
+        }
+
+        resetHistogram(stripe.parseNanoseconds);
+        resetHistogram(stripe.evaluateNanoseconds);
+        resetHistogram(stripe.rulesScannedPerCheck);
+    }
+}
+
+std::string RobotsTxtMetrics::toPrometheus(const Snapshot& snapshot)
+{
+    const RobotsTxtCounters& counters = snapshot.counters;
+    std::string output;
+
+    appendPrometheusCounter(output, "cpprobotparser_evaluations_total", "Checks of URLs against the Allow/Disallow rules.", counters.evaluations);
+
+    output +=
+        "# HELP cpprobotparser_matches_total Checks by the kind of the rule which decided them.\n"
+        "# TYPE cpprobotparser_matches_total counter\n"
+        "cpprobotparser_matches_total{rule=\"allow\"} " + std::to_string(counters.allowMatches) + "\n"
+        "cpprobotparser_matches_total{rule=\"disallow\"} " + std::to_string(counters.disallowMatches) + "\n"
+        "cpprobotparser_matches_total{rule=\"none\"} " + std::to_string(counters.noMatches) + '\n';
+
+    appendPrometheusCounter(output, "cpprobotparser_fallbacks_total", "User agent resolutions which fell back to the * group.", counters.fallbacks);
+    appendPrometheusCounter(output, "cpprobotparser_rules_scanned_total", "Wildcard patterns matched against paths.", counters.rulesScanned);
+    appendPrometheusCounter(output, "cpprobotparser_exceptions_avoided_total", "tryCrawlDelay calls which returned nothing instead of throwing.", counters.exceptionsAvoided);
+
+    appendPrometheusHistogram(output, "cpprobotparser_parse_duration_seconds", "Duration of parsing one robots.txt file.", snapshot.parseNanoseconds, 10, 36, 1e9);
+    appendPrometheusHistogram(output, "cpprobotparser_evaluate_duration_seconds", "Duration of one check.", snapshot.evaluateNanoseconds, 4, 30, 1e9);
+    appendPrometheusHistogram(output, "cpprobotparser_rules_scanned_per_check", "Wildcard patterns matched by one check.", snapshot.rulesScannedPerCheck, 0, 16, 1);
+
+    return output;
+}
+
+std::string RobotsTxtMetrics::toJson(const Snapshot& snapshot)
+{
+    const RobotsTxtCounters& counters = snapshot.counters;
+
+    std::string output = std::string("{\"enabled\":") + (isEnabled() ? "true" : "false") +
+        ",\"counters\":{" +
+        "\"evaluations\":" + std::to_string(counters.evaluations) +
+        ",\"allow_matches\":" + std::to_string(counters.allowMatches) +
+        ",\"disallow_matches\":" + std::to_string(counters.disallowMatches) +
+        ",\"no_matches\":" + std::to_string(counters.noMatches) +
+        ",\"fallbacks\":" + std::to_string(counters.fallbacks) +
+        ",\"rules_scanned\":" + std::to_string(counters.rulesScanned) +
+        ",\"exceptions_avoided\":" + std::to_string(counters.exceptionsAvoided) +
+        ",\"parse_nanoseconds\":" + std::to_string(counters.parseNanoseconds) +
+        "},";
+
+    appendJsonHistogram(output, "parse_nanoseconds", snapshot.parseNanoseconds);
+    output += ',';
+    appendJsonHistogram(output, "evaluate_nanoseconds", snapshot.evaluateNanoseconds);
+    output += ',';
+    appendJsonHistogram(output, "rules_scanned_per_check", snapshot.rulesScannedPerCheck);
+    output += '}';
+
+    return output;
+}
+
+}
\ No newline at end of file
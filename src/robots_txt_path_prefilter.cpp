@@ -0,0 +1,83 @@
+﻿#include "robots_txt_path_prefilter.h"
+#include "compiled_user_agent_group.h"
+
+namespace cpprobotparser
+{
+
+RobotsTxtPathPrefilter::RobotsTxtPathPrefilter() noexcept
+    : m_constantVerdict(VerdictUnknown)
+    , m_filtersPaths(0)
+    , m_reserved(0)
+    , m_firstCharacters(0)
+    , m_characterPairs{}
+{
+}
+
+RobotsTxtPathPrefilter::RobotsTxtPathPrefilter(const std::vector<CompiledRule>& rules) noexcept
+    : RobotsTxtPathPrefilter()
+{
+    m_filtersPaths = 1;
+
+    bool hasAllowRules = false;
+    bool hasDisallowRules = false;
+    bool disallowsEverything = false;
+
+    for (const CompiledRule& rule : rules)
+    {
+        const std::string_view pattern = rule.pattern.pattern();
+
+        if (pattern.empty() || !(rule.pattern.flags() & RobotsTxtPattern::FlagValid))
+        {
+            continue;
+        }
+
+        const bool allow = rule.type == RobotsTxtToken::TokenAllow;
+
+        hasAllowRules = hasAllowRules || allow;
+        hasDisallowRules = hasDisallowRules || !allow;
+
+        // "Disallow: /", "Disallow: /*" and "Disallow: *" match every path starting with '/'
+        disallowsEverything = disallowsEverything ||
+            (!allow && pattern.find_first_not_of('*', pattern.front() == '/' ? 1 : 0) == std::string::npos);
+
+        addPattern(pattern);
+    }
+
+    if (!hasDisallowRules)
+    {
+        m_constantVerdict = VerdictAllowed;
+    }
+    else if (disallowsEverything && !hasAllowRules)
+    {
+        m_constantVerdict = VerdictDisallowed;
+    }
+}
+
+void RobotsTxtPathPrefilter::addPattern(std::string_view pattern) noexcept
+{
+    if (pattern.front() == '*' || (pattern.front() == '/' && (pattern.size() == 1 || pattern[1] == '*')))
+    {
+        // the pattern can match the paths starting with any characters
+        m_filtersPaths = 0;
+        return;
+    }
+
+    if (pattern.front() != '/' || pattern[1] == '$')
+    {
+        // the pattern matches only the paths which don't start with '/' or only "/", such paths are never filtered
+        return;
+    }
+
+    const unsigned first = static_cast<unsigned char>(pattern[1]) & 31;
+
+    if (pattern.size() == 2 || pattern[2] == '*' || pattern[2] == '$')
+    {
+        m_firstCharacters |= std::uint32_t(1) << first;
+        return;
+    }
+
+    const unsigned pair = (first << 5) | (static_cast<unsigned char>(pattern[2]) & 31);
+    m_characterPairs[pair >> 6] |= std::uint64_t(1) << (pair & 63);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,345 @@
+﻿#include "robots_txt_pattern.h"
+#include "string_helpers.h"
+
+namespace cpprobotparser
+{
+
+RobotsTxtPattern::RobotsTxtPattern(std::string_view pattern)
+    : m_pattern(pattern)
+    , m_specificity(static_cast<int>(pattern.size()))
+    , m_flags(0)
+{
+    const std::size_t dollarIndex = m_pattern.find('$');
+    const bool valid = dollarIndex == std::string::npos || dollarIndex == m_pattern.size() - 1;
+    const bool hasWildcards = dollarIndex != std::string::npos || m_pattern.find('*') != std::string::npos;
+    const bool anchoredAtEnd = dollarIndex != std::string::npos && valid;
+
+    m_flags |= valid ? FlagValid : 0;
+    m_flags |= hasWildcards ? FlagHasWildcards : 0;
+    m_flags |= !m_pattern.empty() && m_pattern.front() == '*' ? FlagLeadingWildcard : 0;
+    m_flags |= anchoredAtEnd ? FlagAnchoredAtEnd : 0;
+
+    if (!valid || !hasWildcards)
+    {
+        return;
+    }
+
+    const std::size_t literalSize = anchoredAtEnd ? m_pattern.size() - 1 : m_pattern.size();
+    std::size_t start = 0;
+
+    // at most one segment more than the wildcards, the anchored empty one included
+    m_segments.reserve(static_cast<std::size_t>(std::count(m_pattern.begin(), m_pattern.end(), '*')) + 1);
+
+    while (start < literalSize)
+    {
+        std::size_t end = m_pattern.find('*', start);
+        end = end == std::string::npos || end > literalSize ? literalSize : end;
+
+        if (end != start)
+        {
+            m_segments.push_back(Segment{ static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(end - start) });
+        }
+
+        start = end + 1;
+    }
+
+    if (anchoredAtEnd && (m_segments.empty() || m_segments.back().offset + m_segments.back().length != literalSize))
+    {
+        // the pattern ends with "*$", the anchored part is empty
+        m_segments.push_back(Segment{ static_cast<std::uint32_t>(literalSize), 0 });
+    }
+}
+
+bool RobotsTxtPattern::matches(std::string_view path) const noexcept
+{
+    return matches(m_pattern, m_segments.data(), m_segments.size(), m_flags, path);
+}
+
+bool RobotsTxtPattern::matches(
+    std::string_view pattern,
+    const Segment* segments,
+    std::size_t segmentCount,
+    std::uint8_t flags,
+    std::string_view path) noexcept
+{
+    if (!(flags & FlagValid))
+    {
+        return false;
+    }
+
+    if (!(flags & FlagHasWildcards))
+    {
+        return StringHelpers::startsWithLowercase(path, pattern);
+    }
+
+    // The segments are matched greedily at their leftmost positions, each search continues
+    // from the end of the previous match: a '*' between two segments accepts any gap,
+    // so the leftmost match of a segment never rules out a match of the following ones.
+    // Every path character is scanned by at most one segment search and each search is linear,
+    // hence the whole match is O(path + pattern) regardless of the number of wildcards.
+    const bool leadingWildcard = (flags & FlagLeadingWildcard) != 0;
+    const bool anchoredAtEnd = (flags & FlagAnchoredAtEnd) != 0;
+    std::size_t index = 0;
+
+    for (std::size_t i = 0; i < segmentCount; ++i)
+    {
+        const std::string_view part = pattern.substr(segments[i].offset, segments[i].length);
+        const bool anchoredAtStart = i == 0 && !leadingWildcard;
+        const bool lastAnchored = anchoredAtEnd && i == segmentCount - 1;
+
+        if (anchoredAtStart && lastAnchored)
+        {
+            return path.size() == part.size() && StringHelpers::startsWithLowercase(path, part);
+        }
+
+        if (anchoredAtStart)
+        {
+            if (!StringHelpers::startsWithLowercase(path, part))
+            {
+                return false;
+            }
+
+            index = part.size();
+            continue;
+        }
+
+        if (lastAnchored)
+        {
+            // the anchored segment must end the path without overlapping the previous matches
+            return path.size() - index >= part.size() && StringHelpers::endsWithLowercase(path, part);
+        }
+
+        const std::size_t matchedIndex = findSegment(path, part, index);
+
+        if (matchedIndex == std::string_view::npos)
+        {
+            return false;
+        }
+
+        index = matchedIndex + part.size();
+    }
+
+    return true;
+}
+
+std::size_t RobotsTxtPattern::findSegment(std::string_view path, std::string_view segment, std::size_t from) noexcept
+{
+    if (segment.size() <= s_shortSegmentLength)
+    {
+        // the vectorized search verifies a candidate with a single register compare
+        return StringHelpers::findLowercase(path, segment, from);
+    }
+
+    // The long segment is found by its last bytes with the vectorized search and the rest is verified in place.
+    // The verification isn't bounded by itself, e.g. "/aaa...ab" in "/aaa...a" is checked at every position,
+    // so when the verified bytes exceed the path size the search falls back to the Two-Way matching.
+    const std::size_t headSize = segment.size() - s_shortSegmentLength;
+    const std::string_view head = segment.substr(0, headSize);
+    const std::string_view tail = segment.substr(headSize);
+    std::size_t verificationBudget = path.size() + segment.size();
+    std::size_t position = from;
+
+    while (position <= path.size() && path.size() - position >= segment.size())
+    {
+        const std::size_t tailIndex = StringHelpers::findLowercase(path, tail, position + headSize);
+
+        if (tailIndex == std::string_view::npos)
+        {
+            return std::string_view::npos;
+        }
+
+        position = tailIndex - headSize;
+
+        if (verificationBudget < headSize)
+        {
+            return findSegmentTwoWay(path, segment, position);
+        }
+
+        verificationBudget -= headSize;
+
+        if (StringHelpers::startsWithLowercase(path.substr(position), head))
+        {
+            return position;
+        }
+
+        ++position;
+    }
+
+    return std::string_view::npos;
+}
+
+std::size_t RobotsTxtPattern::findSegmentTwoWay(std::string_view path, std::string_view segment, std::size_t from) noexcept
+{
+    if (from > path.size() || path.size() - from < segment.size())
+    {
+        return std::string_view::npos;
+    }
+
+    // Two-Way string matching (Crochemore and Perrin, 1991): the worst case is linear with constant memory
+    const char* needle = segment.data();
+    const std::ptrdiff_t needleSize = static_cast<std::ptrdiff_t>(segment.size());
+    const char* haystack = path.data() + from;
+    const std::ptrdiff_t haystackSize = static_cast<std::ptrdiff_t>(path.size() - from);
+
+    std::ptrdiff_t period = 0;
+    std::ptrdiff_t reversedPeriod = 0;
+    const std::ptrdiff_t suffix = maximalSuffix(needle, needleSize, period, false);
+    const std::ptrdiff_t reversedSuffix = maximalSuffix(needle, needleSize, reversedPeriod, true);
+
+    // the critical factorization of the needle is needle[0, split] + needle[split + 1, needleSize)
+    std::ptrdiff_t split = suffix;
+
+    if (reversedSuffix > suffix)
+    {
+        split = reversedSuffix;
+        period = reversedPeriod;
+    }
+
+    const auto matchesAt = [haystack, needle](std::ptrdiff_t position, std::ptrdiff_t needleIndex) noexcept
+    {
+        const char ch = haystack[position + needleIndex];
+        return (ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch) == needle[needleIndex];
+    };
+
+    if (std::memcmp(needle, needle + period, static_cast<std::size_t>(split + 1)) == 0)
+    {
+        // the needle is periodic, the prefix matched by the previous attempt is remembered
+        std::ptrdiff_t memory = -1;
+
+        for (std::ptrdiff_t position = 0; position <= haystackSize - needleSize;)
+        {
+            std::ptrdiff_t right = std::max(split, memory) + 1;
+
+            while (right < needleSize && matchesAt(position, right))
+            {
+                ++right;
+            }
+
+            if (right < needleSize)
+            {
+                position += right - split;
+                memory = -1;
+                continue;
+            }
+
+            std::ptrdiff_t left = split;
+
+            while (left > memory && matchesAt(position, left))
+            {
+                --left;
+            }
+
+            if (left <= memory)
+            {
+                return from + static_cast<std::size_t>(position);
+            }
+
+            position += period;
+            memory = needleSize - period - 1;
+        }
+
+        return std::string_view::npos;
+    }
+
+    period = std::max(split + 1, needleSize - split - 1) + 1;
+
+    for (std::ptrdiff_t position = 0; position <= haystackSize - needleSize;)
+    {
+        std::ptrdiff_t right = split + 1;
+
+        while (right < needleSize && matchesAt(position, right))
+        {
+            ++right;
+        }
+
+        if (right < needleSize)
+        {
+            position += right - split;
+            continue;
+        }
+
+        std::ptrdiff_t left = split;
+
+        while (left >= 0 && matchesAt(position, left))
+        {
+            --left;
+        }
+
+        if (left < 0)
+        {
+            return from + static_cast<std::size_t>(position);
+        }
+
+        position += period;
+    }
+
+    return std::string_view::npos;
+}
+
+std::ptrdiff_t RobotsTxtPattern::maximalSuffix(const char* needle, std::ptrdiff_t needleSize, std::ptrdiff_t& period, bool reversedOrder) noexcept
+{
+    std::ptrdiff_t suffix = -1;
+    std::ptrdiff_t candidate = 0;
+    std::ptrdiff_t offset = 1;
+    period = 1;
+
+    while (candidate + offset < needleSize)
+    {
+        const unsigned char a = static_cast<unsigned char>(needle[candidate + offset]);
+        const unsigned char b = static_cast<unsigned char>(needle[suffix + offset]);
+
+        if (reversedOrder ? a > b : a < b)
+        {
+            candidate += offset;
+            offset = 1;
+            period = candidate - suffix;
+        }
+        else if (a == b)
+        {
+            if (offset != period)
+            {
+                ++offset;
+            }
+            else
+            {
+                candidate += period;
+                offset = 1;
+            }
+        }
+        else
+        {
+            suffix = candidate;
+            candidate = suffix + 1;
+            offset = period = 1;
+        }
+    }
+
+    return suffix;
+}
+
+int RobotsTxtPattern::specificity() const noexcept
+{
+    return m_specificity;
+}
+
+bool RobotsTxtPattern::isLiteral() const noexcept
+{
+    return (m_flags & FlagValid) && !(m_flags & FlagHasWildcards);
+}
+
+std::string_view RobotsTxtPattern::pattern() const noexcept
+{
+    return m_pattern;
+}
+
+const std::vector<RobotsTxtPattern::Segment>& RobotsTxtPattern::segments() const noexcept
+{
+    return m_segments;
+}
+
+std::uint8_t RobotsTxtPattern::flags() const noexcept
+{
+    return m_flags;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+﻿#include "robots_txt_prefix_tree.h"
+#include "string_helpers.h"
+
+namespace cpprobotparser
+{
+
+namespace
+{
+
+//! The range of the sorted entries sharing the prefix of the node, used only while the tree is built
+struct PendingNode
+{
+    std::uint32_t nodeIndex;
+
+    // the length of the prefix
+    std::size_t depth;
+
+    // entries[first, last)
+    std::size_t first;
+    std::size_t last;
+};
+
+std::size_t commonPrefixLength(std::string_view first, std::string_view second) noexcept
+{
+    const std::size_t size = std::min(first.size(), second.size());
+    return static_cast<std::size_t>(std::mismatch(first.begin(), first.begin() + size, second.begin()).first - first.begin());
+}
+
+}
+
+RobotsTxtPrefixTree::RobotsTxtPrefixTree()
+    : m_nodes(1, Node{ 0, 0, 0, 0, nodeNoRule, 0 })
+{
+}
+
+RobotsTxtPrefixTree::RobotsTxtPrefixTree(std::vector<Entry> entries, std::string_view labels)
+    : RobotsTxtPrefixTree()
+{
+    m_labels = labels;
+
+    // the patterns with the common prefix are adjacent once sorted, so every node is a range of the entries:
+    // the patterns ending at the node go first and the edge to the node ends at the common prefix of its first and last pattern,
+    // which collapses the chains of nodes with a single child and no rule into one edge without building the uncompressed trie
+    std::sort(entries.begin(), entries.end(), [](const Entry& first, const Entry& second)
+    {
+        return first.pattern < second.pattern;
+    });
+
+    // the tree with n patterns has at most 2n nodes besides the root
+    m_nodes.reserve(entries.size() * 2 + 1);
+
+    std::vector<PendingNode> pendingNodes;
+    pendingNodes.reserve(m_nodes.capacity());
+    pendingNodes.push_back(PendingNode{ 0, 0, 0, entries.size() });
+
+    // breadth first flattening: the children of every node are placed next to each other
+    for (std::size_t pendingIndex = 0; pendingIndex < pendingNodes.size(); ++pendingIndex)
+    {
+        const PendingNode pendingNode = pendingNodes[pendingIndex];
+        std::size_t first = pendingNode.first;
+        Match match{ npos, 0 };
+
+        for (; first < pendingNode.last && entries[first].pattern.size() == pendingNode.depth; ++first)
+        {
+            if (isBetter(entries[first].priority, entries[first].ruleIndex, match))
+            {
+                match = Match{ entries[first].ruleIndex, entries[first].priority };
+            }
+        }
+
+        Node& node = m_nodes[pendingNode.nodeIndex];
+        node.ruleIndex = match.ruleIndex == npos ? nodeNoRule : static_cast<std::uint32_t>(match.ruleIndex);
+        node.priority = match.priority;
+        node.firstChild = static_cast<std::uint32_t>(m_nodes.size());
+
+        while (first < pendingNode.last)
+        {
+            const std::string_view pattern = entries[first].pattern;
+            std::size_t last = first + 1;
+
+            while (last < pendingNode.last && entries[last].pattern[pendingNode.depth] == pattern[pendingNode.depth])
+            {
+                ++last;
+            }
+
+            const std::size_t depth = commonPrefixLength(pattern, entries[last - 1].pattern);
+            const std::uint32_t labelOffset = static_cast<std::uint32_t>(pattern.data() + pendingNode.depth - labels.data());
+
+            pendingNodes.push_back(PendingNode{ static_cast<std::uint32_t>(m_nodes.size()), depth, first, last });
+            m_nodes.push_back(Node{ labelOffset, static_cast<std::uint32_t>(depth - pendingNode.depth), 0, 0, nodeNoRule, 0 });
+
+            first = last;
+        }
+
+        m_nodes[pendingNode.nodeIndex].childCount = static_cast<std::uint32_t>(m_nodes.size()) - m_nodes[pendingNode.nodeIndex].firstChild;
+    }
+}
+
+RobotsTxtPrefixTree::Match RobotsTxtPrefixTree::bestMatch(std::string_view path) const noexcept
+{
+    return bestMatch(m_nodes.data(), m_labels, path);
+}
+
+RobotsTxtPrefixTree::Match RobotsTxtPrefixTree::bestMatch(const Node* nodes, std::string_view labels, std::string_view path) noexcept
+{
+    Match best{ npos, 0 };
+
+    forEachMatch(nodes, labels, path, [&best](std::size_t ruleIndex, int priority)
+    {
+        if (isBetter(priority, ruleIndex, best))
+        {
+            best = Match{ ruleIndex, priority };
+        }
+    });
+
+    return best;
+}
+
+bool RobotsTxtPrefixTree::isBetter(int priority, std::size_t ruleIndex, const Match& match) noexcept
+{
+    if (ruleIndex == npos)
+    {
+        return false;
+    }
+
+    return match.ruleIndex == npos ||
+        priority > match.priority ||
+        (priority == match.priority && ruleIndex < match.ruleIndex);
+}
+
+const std::vector<RobotsTxtPrefixTree::Node>& RobotsTxtPrefixTree::nodes() const noexcept
+{
+    return m_nodes;
+}
+
+std::string_view RobotsTxtPrefixTree::labels() const noexcept
+{
+    return m_labels;
+}
+
+}
\ No newline at end of file
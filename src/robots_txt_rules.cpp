@@ -2,245 +2,1324 @@
 #include "robots_txt_token.h"
 #include "robots_txt_tokenizer.h"
 #include "meta_robots_helpers.h"
+#include "compiled_user_agent_group.h"
+#include "url_helpers.h"
 #include "string_helpers.h"
-#include <url.hpp>
+#include "metrics_recorder.h"
+#include <clocale>
 
 namespace cpprobotparser
 {
 
-class RobotsTxtRules::RobotsTxtRulesImpl final
+namespace
 {
-private:
-    struct TokenValue
+
+// parses the decimal number at the beginning of the value independently of the locale, the rest of the value is ignored
+std::optional<double> parseLeadingNumber(std::string_view value) noexcept
+{
+#ifdef __cpp_lib_to_chars
+    double number = 0;
+    const std::from_chars_result result = std::from_chars(value.data(), value.data() + value.size(), number);
+
+    if (result.ec != std::errc())
+    {
+        return std::nullopt;
+    }
+
+    return number;
+#else
+    // std::from_chars of double is missing before libstdc++ 11 and in libc++,
+    // std::strtod expects the decimal point of the C locale, so it parses a copy of the number with the point replaced
+    char buffer[64];
+    const std::size_t length = std::min({ value.find_first_not_of("0123456789+-.eE"), value.size(), sizeof(buffer) - 1 });
+
+    std::copy_n(value.data(), length, buffer);
+    std::replace(buffer, buffer + length, '.', *std::localeconv()->decimal_point);
+    buffer[length] = '\0';
+
+    char* end = nullptr;
+    const double number = std::strtod(buffer, &end);
+
+    if (end == buffer)
+    {
+        return std::nullopt;
+    }
+
+    return number;
+#endif
+}
+
+// orders the lowercased strings and the views compared as lowercased
+struct LowercaseLess
+{
+    bool operator()(std::string_view first, std::string_view second) const noexcept
     {
-        TokenValue(RobotsTxtToken tokenType, const std::string& tokenValue)
-            : type(tokenType)
-            , value(tokenValue)
+        const std::size_t size = std::min(first.size(), second.size());
+
+        for (std::size_t i = 0; i < size; ++i)
         {
+            const char firstChar = StringHelpers::asciiToLower(first[i]);
+            const char secondChar = StringHelpers::asciiToLower(second[i]);
+
+            if (firstChar != secondChar)
+            {
+                return static_cast<unsigned char>(firstChar) < static_cast<unsigned char>(secondChar);
+            }
         }
 
-        RobotsTxtToken type;
-        std::string value;
-    };
+        return first.size() < second.size();
+    }
+};
 
+}
+
+class RobotsTxtRules::RobotsTxtRulesImpl final
+{
 public:
+    struct ResolvedGroup
+    {
+        const CompiledUserAgentGroup* ownGroup;
+        const CompiledUserAgentGroup* rulesGroup;
+    };
+
+    RobotsTxtRulesImpl()
+        : m_feedNanoseconds(0)
+        , m_feeding(false)
+    {
+        compileGroups();
+    }
+
+    // the compiled patterns are the views of the values of the own tokenizer, so they are compiled again instead of copied
+    RobotsTxtRulesImpl(const RobotsTxtRulesImpl& other)
+        : m_tokenizer(other.m_tokenizer)
+        , m_counters(other.m_counters)
+        , m_feedNanoseconds(other.m_feedNanoseconds)
+        , m_feeding(other.m_feeding)
+    {
+        compileCopiedGroups();
+    }
+
+    RobotsTxtRulesImpl& operator=(const RobotsTxtRulesImpl& other)
+    {
+        m_tokenizer = other.m_tokenizer;
+        m_counters = other.m_counters;
+        m_feedNanoseconds = other.m_feedNanoseconds;
+        m_feeding = other.m_feeding;
+
+        compileCopiedGroups();
+
+        return *this;
+    }
+
     void parse(const std::string& robotsTxtContent)
     {
+        const std::chrono::steady_clock::time_point start = measurementStart();
+
         m_tokenizer.tokenize(robotsTxtContent);
+        m_feeding = false;
+        compileGroups();
+
+        m_feedNanoseconds = 0;
+        recordParse(start);
+    }
+
+    void feed(std::string_view chunk)
+    {
+        const std::chrono::steady_clock::time_point start = measurementStart();
+
+        if (!m_feeding)
+        {
+            // the first chunk of the new content drops the values the compiled patterns view
+            clearGroups();
+            compileVerdictIndex();
+            m_feeding = true;
+        }
+
+        m_tokenizer.feed(chunk);
+
+        // the time of the feeds is added to the time of the finish
+        m_feedNanoseconds += elapsedNanoseconds(start);
     }
 
-    bool isUrlAllowed(const std::string& url, WellKnownUserAgent userAgent) const
+    void finish()
     {
-        return isUrlAllowed(url, MetaRobotsHelpers::userAgentString(userAgent));
+        const std::chrono::steady_clock::time_point start = measurementStart();
+
+        m_tokenizer.finish();
+        m_feeding = false;
+        compileGroups();
+
+        recordParse(start);
+        m_feedNanoseconds = 0;
     }
 
-    bool isUrlAllowed(const std::string& url, const std::string& userAgent) const
+    void setMaxContentSize(std::size_t maxContentSize) noexcept
     {
-        if (!m_tokenizer.isValid())
+        m_tokenizer.setMaxContentSize(maxContentSize);
+    }
+
+    bool isTruncated() const noexcept
+    {
+        return m_tokenizer.isTruncated();
+    }
+
+    ResolvedGroup resolveGroup(WellKnownUserAgent userAgent) const
+    {
+        const std::uint32_t groupIndex = m_groupIndexByUserAgent[static_cast<std::size_t>(userAgent)];
+
+        if (groupIndex == s_unsupportedUserAgent)
+        {
+            throw std::runtime_error("Passed unknown parameter");
+        }
+
+        return countFallback(resolveGroup(groupAt(groupIndex)));
+    }
+
+    ResolvedGroup resolveGroup(const std::string& userAgent) const noexcept
+    {
+        return countFallback(resolveGroup(groupAt(m_tokenizer.userAgents().find(UserAgentRegistry::productToken(userAgent)))));
+    }
+
+    ResolvedGroup resolveGroupFromHeader(std::string_view userAgentHeader) const noexcept
+    {
+        return countFallback(resolveGroup(groupAt(m_tokenizer.userAgents().match(userAgentHeader))));
+    }
+
+    const UserAgentRegistry& userAgents() const noexcept
+    {
+        return m_tokenizer.userAgents();
+    }
+
+    bool isUrlAllowed(const std::string& url, const CompiledUserAgentGroup* rulesGroup) const
+    {
+        if (!rulesGroup)
+        {
+            recordUnmatchedChecks(1);
+            return true;
+        }
+
+        std::string buffer;
+        return evaluate(UrlHelpers::rulesPath(url, buffer), *rulesGroup);
+    }
+
+    bool isPathAllowed(std::string_view pathAndQuery, const CompiledUserAgentGroup* rulesGroup) const noexcept
+    {
+        if (!rulesGroup)
         {
+            recordUnmatchedChecks(1);
             return true;
         }
 
-        const auto makeQueryString = [](const Url::Query& query)
+        return evaluate(pathAndQuery, *rulesGroup);
+    }
+
+    void areUrlsAllowed(const std::vector<std::string>& urls, const CompiledUserAgentGroup* rulesGroup, std::vector<bool>& verdicts) const
+    {
+        verdicts.assign(urls.size(), true);
+
+        if (!rulesGroup)
+        {
+            recordUnmatchedChecks(urls.size());
+            return;
+        }
+
+        // reused by every URL with an empty path followed by a query
+        std::string buffer;
+
+        for (std::size_t i = 0; i < urls.size(); ++i)
+        {
+            verdicts[i] = evaluate(UrlHelpers::rulesPath(urls[i], buffer), *rulesGroup);
+        }
+    }
+
+    void arePathsAllowed(const std::vector<std::string_view>& pathsAndQueries, const CompiledUserAgentGroup* rulesGroup, std::vector<bool>& verdicts) const
+    {
+        verdicts.assign(pathsAndQueries.size(), true);
+
+        if (!rulesGroup)
+        {
+            recordUnmatchedChecks(pathsAndQueries.size());
+            return;
+        }
+
+        for (std::size_t i = 0; i < pathsAndQueries.size(); ++i)
+        {
+            verdicts[i] = evaluate(pathsAndQueries[i], *rulesGroup);
+        }
+    }
+
+    UserAgentVerdicts urlVerdicts(const std::string& url) const
+    {
+        std::string buffer;
+        return pathVerdicts(UrlHelpers::rulesPath(url, buffer));
+    }
+
+    // the verdicts of all well known user agents in one pass: the literal rules of all groups are looked up
+    // in one shared tree and a wildcard rule repeated in several groups is matched only once
+    UserAgentVerdicts pathVerdicts(std::string_view pathAndQuery) const
+    {
+        const std::string_view path = pathAndQuery.empty() ? std::string_view("/") : pathAndQuery;
+
+        if (path == "/robots.txt")
+        {
+            return UserAgentVerdicts(m_wellKnownUserAgentsMask);
+        }
+
+        std::uint32_t mask = m_alwaysAllowedMask;
+        std::uint32_t unresolvedSlots = 0;
+
+        // the slots decided by their prefilters need no lookups
+        for (std::size_t slot = 0; slot < m_verdictSlots.size(); ++slot)
+        {
+            const VerdictSlot& verdictSlot = m_verdictSlots[slot];
+            const RobotsTxtPathPrefilter::Verdict verdict = m_groups[verdictSlot.groupIndex].prefilter.verdict(path);
+
+            if (verdict == RobotsTxtPathPrefilter::VerdictUnknown)
+            {
+                unresolvedSlots |= std::uint32_t(1) << slot;
+            }
+            else
+            {
+                mask |= verdict == RobotsTxtPathPrefilter::VerdictAllowed ? verdictSlot.userAgentMask : 0;
+            }
+        }
+
+        if (!unresolvedSlots)
+        {
+            return UserAgentVerdicts(mask);
+        }
+
+        std::array<RobotsTxtPrefixTree::Match, s_maxVerdictSlots> literalMatches;
+        literalMatches.fill(RobotsTxtPrefixTree::Match{ RobotsTxtPrefixTree::npos, 0 });
+
+        RobotsTxtPrefixTree::forEachMatch(
+            m_sharedLiteralRules.nodes().data(),
+            m_sharedLiteralRules.labels(),
+            path,
+            [this, &literalMatches](std::size_t literalIndex, int)
+            {
+                for (std::uint32_t i = m_literalOccurrenceOffsets[literalIndex]; i < m_literalOccurrenceOffsets[literalIndex + 1]; ++i)
+                {
+                    const RuleOccurrence& occurrence = m_literalOccurrences[i];
+                    RobotsTxtPrefixTree::Match& match = literalMatches[occurrence.slot];
+
+                    if (RobotsTxtPrefixTree::isBetter(occurrence.priority, occurrence.ruleIndex, match))
+                    {
+                        match = RobotsTxtPrefixTree::Match{ occurrence.ruleIndex, occurrence.priority };
+                    }
+                }
+            }
+        );
+
+        // two bits for every distinct wildcard pattern: it's matched already and the result
+        const std::size_t memoWords = (m_wildcardPatternCount + 63) / 64;
+        std::array<std::uint64_t, s_stackMemoWords * 2> stackMemo;
+        std::vector<std::uint64_t> heapMemo;
+        std::uint64_t* evaluatedWildcards = stackMemo.data();
+
+        if (memoWords > s_stackMemoWords)
+        {
+            heapMemo.resize(memoWords * 2);
+            evaluatedWildcards = heapMemo.data();
+        }
+
+        std::uint64_t* matchedWildcards = evaluatedWildcards + memoWords;
+        std::fill_n(evaluatedWildcards, memoWords * 2, std::uint64_t(0));
+
+        for (std::size_t slot = 0; slot < m_verdictSlots.size(); ++slot)
+        {
+            if (!(unresolvedSlots & (std::uint32_t(1) << slot)))
+            {
+                continue;
+            }
+
+            const VerdictSlot& verdictSlot = m_verdictSlots[slot];
+            const CompiledUserAgentGroup& group = m_groups[verdictSlot.groupIndex];
+
+            const bool allowed = isAllowedByRules(group, literalMatches[slot], [&](std::size_t wildcardIndex)
+            {
+                const std::uint32_t patternIndex = m_wildcardPatternIndices[verdictSlot.wildcardOffset + wildcardIndex];
+                const std::size_t word = patternIndex / 64;
+                const std::uint64_t patternBit = std::uint64_t(1) << (patternIndex % 64);
+
+                if (evaluatedWildcards[word] & patternBit)
+                {
+                    return (matchedWildcards[word] & patternBit) != 0;
+                }
+
+                const bool matches = group.rules[group.wildcardRules[wildcardIndex]].pattern.matches(path);
+
+                evaluatedWildcards[word] |= patternBit;
+                matchedWildcards[word] |= matches ? patternBit : 0;
+
+                return matches;
+            });
+
+            mask |= allowed ? verdictSlot.userAgentMask : 0;
+        }
+
+        return UserAgentVerdicts(mask);
+    }
+
+    double crawlDelay(const CompiledUserAgentGroup* ownGroup) const
+    {
+        if (!ownGroup || !ownGroup->crawlDelay)
+        {
+            throw std::runtime_error("There is no valid crawl delay token for specified user agent");
+        }
+
+        return *ownGroup->crawlDelay;
+    }
+
+    std::optional<double> tryCrawlDelay(const CompiledUserAgentGroup* ownGroup) const noexcept
+    {
+        const std::optional<double> result = ownGroup ? ownGroup->crawlDelay : std::nullopt;
+
+        if (!result && MetricsRecorder::isEnabled())
+        {
+            m_counters.add(MetricsRecorder::Counter::ExceptionsAvoided);
+        }
+
+        return result;
+    }
+
+    const std::vector<RequestRate>& requestRates(const CompiledUserAgentGroup* ownGroup) const noexcept
+    {
+        static const std::vector<RequestRate> s_noRequestRates;
+        return ownGroup ? ownGroup->requestRates : s_noRequestRates;
+    }
+
+    std::optional<VisitTime> visitTime(const CompiledUserAgentGroup* ownGroup) const noexcept
+    {
+        return ownGroup ? ownGroup->visitTime : std::nullopt;
+    }
+
+    std::chrono::milliseconds fetchInterval(const CompiledUserAgentGroup* ownGroup) const noexcept
+    {
+        std::chrono::milliseconds result(0);
+
+        if (!ownGroup)
+        {
+            return result;
+        }
+
+        if (ownGroup->crawlDelay)
+        {
+            result = std::chrono::milliseconds(static_cast<std::int64_t>(std::ceil(*ownGroup->crawlDelay * 1000)));
+        }
+
+        for (const RequestRate& requestRate : ownGroup->requestRates)
+        {
+            result = std::max(result, requestRate.interval());
+        }
+
+        return result;
+    }
+
+    const std::vector<std::string>& cleanParam(const CompiledUserAgentGroup* ownGroup) const noexcept
+    {
+        static const std::vector<std::string> s_noCleanParams;
+        return ownGroup ? ownGroup->cleanParams : s_noCleanParams;
+    }
+
+    std::string_view canonicalize(std::string_view url, const CompiledUserAgentGroup* ownGroup, std::string& buffer) const
+    {
+        if (!ownGroup || ownGroup->compiledCleanParams.empty())
+        {
+            return url;
+        }
+
+        const std::size_t fragmentBegin = std::min(url.find('#'), url.size());
+        const std::size_t queryBegin = url.substr(0, fragmentBegin).find('?');
+
+        if (queryBegin == std::string_view::npos)
+        {
+            return url;
+        }
+
+        const std::string_view query = url.substr(queryBegin + 1, fragmentBegin - queryBegin - 1);
+        const std::string_view pathAndQuery = UrlHelpers::pathAndQuery(url);
+        std::string_view path = pathAndQuery.substr(0, pathAndQuery.find('?'));
+        path = path.empty() ? std::string_view("/") : path;
+
+        const std::vector<CompiledCleanParam>& cleanParams = ownGroup->compiledCleanParams;
+
+        // the path prefixes are matched only for the parameters found in their sets
+        // and the results for the first 64 prefixes are remembered
+        std::uint64_t matchedPrefixes = 0;
+        std::uint64_t unmatchedPrefixes = 0;
+
+        const auto isIgnored = [&](std::string_view parameter)
+        {
+            const std::string_view name = parameter.substr(0, parameter.find('='));
+
+            for (std::size_t i = 0; i < cleanParams.size(); ++i)
+            {
+                const std::vector<std::string>& parameters = cleanParams[i].parameters;
+
+                if (!std::binary_search(parameters.begin(), parameters.end(), name, LowercaseLess()))
+                {
+                    continue;
+                }
+
+                const std::uint64_t prefixBit = i < 64 ? std::uint64_t(1) << i : 0;
+
+                if (matchedPrefixes & prefixBit)
+                {
+                    return true;
+                }
+
+                if (unmatchedPrefixes & prefixBit)
+                {
+                    continue;
+                }
+
+                const bool matches = cleanParams[i].pathPrefix.matches(path);
+
+                matchedPrefixes |= matches ? prefixBit : 0;
+                unmatchedPrefixes |= matches ? 0 : prefixBit;
+
+                if (matches)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        };
+
+        // one pass over the parameters: the kept ones are copied only after the first ignored one is met
+        bool changed = false;
+        bool hasKeptParameters = false;
+
+        for (std::size_t position = 0; position <= query.size();)
+        {
+            const std::size_t end = std::min(query.find('&', position), query.size());
+            const std::string_view parameter = query.substr(position, end - position);
+            const bool ignored = !parameter.empty() && isIgnored(parameter);
+
+            if (ignored && !changed)
+            {
+                // the parameters before are kept without the trailing delimiters
+                const std::size_t keptSize = position == 0 ? 0 : query.find_last_not_of('&', position - 1) + 1;
+
+                changed = true;
+                hasKeptParameters = keptSize > 0;
+
+                buffer.assign(url.data(), queryBegin);
+
+                if (hasKeptParameters)
+                {
+                    buffer += '?';
+                    buffer.append(query.data(), keptSize);
+                }
+            }
+            else if (!ignored && changed && !parameter.empty())
+            {
+                buffer += hasKeptParameters ? '&' : '?';
+                buffer.append(parameter.data(), parameter.size());
+                hasKeptParameters = true;
+            }
+
+            position = end + 1;
+        }
+
+        if (!changed)
+        {
+            return url;
+        }
+
+        buffer.append(url.data() + fragmentBegin, url.size() - fragmentBegin);
+
+        return buffer;
+    }
+
+    // every user agent record in the robots.txt has its compiled group
+    bool hasRulesFor(WellKnownUserAgent userAgent) const
+    {
+        return resolveGroup(userAgent).ownGroup != nullptr;
+    }
+
+    bool hasRulesFor(const std::string& userAgent) const noexcept
+    {
+        return resolveGroup(userAgent).ownGroup != nullptr;
+    }
+
+    const std::string& sitemapUrl() const noexcept
+    {
+        return m_tokenizer.sitemapUrl();
+    }
+
+    const std::vector<ParseDiagnostic>& parseDiagnostics() const noexcept
+    {
+        return m_parseDiagnostics;
+    }
+
+    std::size_t memoryUsage() const noexcept
+    {
+        std::size_t bytes = sizeof(*this) - sizeof(m_tokenizer) + m_tokenizer.memoryUsage();
+
+        bytes += m_groups.capacity() * sizeof(CompiledUserAgentGroup);
+
+        for (const CompiledUserAgentGroup& group : m_groups)
+        {
+            bytes += group.userAgent.capacity() + groupMemoryUsage(group);
+        }
+
+        bytes +=
+            m_verdictSlots.capacity() * sizeof(VerdictSlot) +
+            m_sharedLiteralRules.nodes().capacity() * sizeof(RobotsTxtPrefixTree::Node) +
+            m_literalOccurrenceOffsets.capacity() * sizeof(std::uint32_t) +
+            m_literalOccurrences.capacity() * sizeof(RuleOccurrence) +
+            m_wildcardPatternIndices.capacity() * sizeof(std::uint32_t) +
+            m_parseDiagnostics.capacity() * sizeof(ParseDiagnostic);
+
+        for (const ParseDiagnostic& parseDiagnostic : m_parseDiagnostics)
+        {
+            bytes += parseDiagnostic.userAgent.capacity() + parseDiagnostic.value.capacity() + parseDiagnostic.message.capacity();
+        }
+
+        return bytes;
+    }
+
+    void forEachGroup(const std::function<void(const std::string&, const CompiledUserAgentGroup&)>& visitor) const
+    {
+        for (const CompiledUserAgentGroup& group : m_groups)
+        {
+            visitor(group.userAgent, group);
+        }
+    }
+
+    void setCountersEnabled(bool enabled)
+    {
+        m_counters.setEnabled(enabled);
+    }
+
+    RobotsTxtCounters counters() const noexcept
+    {
+        return m_counters.load();
+    }
+
+private:
+    // the own group of the user agent and the group which rules are applied:
+    // the own group if it has any Allow/Disallow rules, otherwise the group for all robots
+    ResolvedGroup resolveGroup(const CompiledUserAgentGroup* ownGroup) const noexcept
+    {
+        if (ownGroup && !ownGroup->rules.empty())
+        {
+            return ResolvedGroup{ ownGroup, ownGroup };
+        }
+
+        return ResolvedGroup{ ownGroup, groupAt(m_groupIndexByUserAgent[static_cast<std::size_t>(WellKnownUserAgent::AllRobots)]) };
+    }
+
+    // the resolutions requested by the callers are counted, the ones done by the compilation aren't
+    ResolvedGroup countFallback(ResolvedGroup resolvedGroup) const noexcept
+    {
+        if (resolvedGroup.rulesGroup && resolvedGroup.rulesGroup != resolvedGroup.ownGroup && MetricsRecorder::isEnabled())
+        {
+            m_counters.add(MetricsRecorder::Counter::Fallbacks);
+        }
+
+        return resolvedGroup;
+    }
+
+    const CompiledUserAgentGroup* groupAt(std::uint32_t groupIndex) const noexcept
+    {
+        return groupIndex < m_groups.size() ? &m_groups[groupIndex] : nullptr;
+    }
+
+    // every check of a path goes through here, it's measured only if the metrics are enabled
+    bool evaluate(std::string_view pathAndQuery, const CompiledUserAgentGroup& group) const noexcept
+    {
+        if (!MetricsRecorder::isEnabled())
+        {
+            return isAllowedByRules(pathAndQuery, group);
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        std::size_t rulesScanned = 0;
+        const RobotsTxtPrefixTree::Match match = bestMatch(pathAndQuery, group, rulesScanned);
+        const bool allowed = isAllowedMatch(group, match);
+
+        m_counters.add(MetricsRecorder::Counter::Evaluations);
+        m_counters.add(match.ruleIndex == RobotsTxtPrefixTree::npos ? MetricsRecorder::Counter::NoMatches :
+            allowed ? MetricsRecorder::Counter::AllowMatches : MetricsRecorder::Counter::DisallowMatches);
+        m_counters.add(MetricsRecorder::Counter::RulesScanned, rulesScanned);
+
+        MetricsRecorder::recordEvaluation(elapsedNanoseconds(start), rulesScanned);
+
+        return allowed;
+    }
+
+    // the checks of the user agents without any rules
+    void recordUnmatchedChecks(std::size_t count) const noexcept
+    {
+        if (MetricsRecorder::isEnabled())
+        {
+            m_counters.add(MetricsRecorder::Counter::Evaluations, count);
+            m_counters.add(MetricsRecorder::Counter::NoMatches, count);
+        }
+    }
+
+    void recordParse(std::chrono::steady_clock::time_point start) const noexcept
+    {
+        if (MetricsRecorder::isEnabled())
+        {
+            const std::uint64_t nanoseconds = m_feedNanoseconds + elapsedNanoseconds(start);
+
+            m_counters.add(MetricsRecorder::Counter::ParseNanoseconds, nanoseconds);
+            MetricsRecorder::recordParse(nanoseconds);
+        }
+    }
+
+    // the start of the measured operation or the empty time point if the metrics are disabled
+    static std::chrono::steady_clock::time_point measurementStart() noexcept
+    {
+        return MetricsRecorder::isEnabled() ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    }
+
+    static std::uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start) noexcept
+    {
+        if (start == std::chrono::steady_clock::time_point())
+        {
+            return 0;
+        }
+
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // RFC 9309: the most specific (the longest) matched rule wins, on equal length Allow does
+    // if URL is not matched to any pattern then we treat this as an allowed URL
+    static bool isAllowedByRules(std::string_view pathAndQuery, const CompiledUserAgentGroup& group) noexcept
+    {
+        const RobotsTxtPathPrefilter::Verdict verdict = group.prefilter.verdict(pathAndQuery);
+
+        if (verdict != RobotsTxtPathPrefilter::VerdictUnknown && pathAndQuery != "/robots.txt")
+        {
+            return verdict == RobotsTxtPathPrefilter::VerdictAllowed;
+        }
+
+        std::size_t rulesScanned = 0;
+        return isAllowedMatch(group, bestMatch(pathAndQuery, group, rulesScanned));
+    }
+
+    // returns the best matched rule or npos if no rule matches the path,
+    // the number of the wildcard patterns matched against the path is added to rulesScanned
+    static RobotsTxtPrefixTree::Match bestMatch(std::string_view pathAndQuery, const CompiledUserAgentGroup& group, std::size_t& rulesScanned) noexcept
+    {
+        const std::string_view path = pathAndQuery.empty() ? std::string_view("/") : pathAndQuery;
+
+        if (path == "/robots.txt")
+        {
+            // the robots.txt itself is implicitly allowed
+            return RobotsTxtPrefixTree::Match{ RobotsTxtPrefixTree::npos, 0 };
+        }
+
+        if (!group.prefilter.mayMatch(path))
+        {
+            return RobotsTxtPrefixTree::Match{ RobotsTxtPrefixTree::npos, 0 };
+        }
+
+        return bestMatch(group, group.literalRules.bestMatch(path), [&path, &group, &rulesScanned](std::size_t wildcardIndex)
+        {
+            ++rulesScanned;
+            return group.rules[group.wildcardRules[wildcardIndex]].pattern.matches(path);
+        });
+    }
+
+    static bool isAllowedMatch(const CompiledUserAgentGroup& group, RobotsTxtPrefixTree::Match match) noexcept
+    {
+        return match.ruleIndex == RobotsTxtPrefixTree::npos || group.rules[match.ruleIndex].type == RobotsTxtToken::TokenAllow;
+    }
+
+    // completes the verdict for the best literal match with the wildcard rules,
+    // wildcardMatches(i) returns true if the i-th wildcard rule of the group matches the path
+    template <typename WildcardMatches>
+    static bool isAllowedByRules(const CompiledUserAgentGroup& group, RobotsTxtPrefixTree::Match bestLiteralMatch, WildcardMatches&& wildcardMatches) noexcept
+    {
+        return isAllowedMatch(group, bestMatch(group, bestLiteralMatch, std::forward<WildcardMatches>(wildcardMatches)));
+    }
+
+    template <typename WildcardMatches>
+    static RobotsTxtPrefixTree::Match bestMatch(const CompiledUserAgentGroup& group, RobotsTxtPrefixTree::Match bestMatch, WildcardMatches&& wildcardMatches) noexcept
+    {
+        // the wildcard rules are in the precedence order, so the first matched one is the best of them
+        // and the scan stops as soon as the rest can't win over the literal match
+        for (std::size_t i = 0; i < group.wildcardRules.size(); ++i)
+        {
+            const std::size_t ruleIndex = group.wildcardRules[i];
+            const int specificity = group.rules[ruleIndex].pattern.specificity();
+
+            if (!RobotsTxtPrefixTree::isBetter(specificity, ruleIndex, bestMatch))
+            {
+                break;
+            }
+
+            if (wildcardMatches(i))
+            {
+                bestMatch = RobotsTxtPrefixTree::Match{ ruleIndex, specificity };
+                break;
+            }
+        }
+
+        return bestMatch;
+    }
+
+    // the patterns and the tree labels are the views of the tokenizer values, they take no memory of their own
+    static std::size_t groupMemoryUsage(const CompiledUserAgentGroup& group) noexcept
+    {
+        std::size_t bytes =
+            group.rules.capacity() * sizeof(CompiledRule) +
+            group.wildcardRules.capacity() * sizeof(std::size_t) +
+            group.literalRules.nodes().capacity() * sizeof(RobotsTxtPrefixTree::Node) +
+            group.cleanParams.capacity() * sizeof(std::string) +
+            group.requestRates.capacity() * sizeof(RequestRate) +
+            group.compiledCleanParams.capacity() * sizeof(CompiledCleanParam);
+
+        for (const CompiledRule& rule : group.rules)
+        {
+            bytes += rule.pattern.segments().capacity() * sizeof(RobotsTxtPattern::Segment);
+        }
+        for (const std::string& cleanParam : group.cleanParams)
+        {
+            bytes += cleanParam.capacity();
+        }
+        for (const CompiledCleanParam& compiledCleanParam : group.compiledCleanParams)
+        {
+            bytes += compiledCleanParam.pathPrefix.segments().capacity() * sizeof(RobotsTxtPattern::Segment) + compiledCleanParam.parameters.capacity() * sizeof(std::string);
+
+            for (const std::string& parameter : compiledCleanParam.parameters)
+            {
+                bytes += parameter.capacity();
+            }
+        }
+
+        return bytes;
+    }
+
+    // "Crawl-delay: <seconds>", the fraction of a second is allowed.
+    // It's as lenient as std::stod used before: the leading whitespace and '+' are skipped
+    // and the characters after the number are ignored, e.g. "2.5s" is 2.5 seconds and "2,5" is 2.
+    // Only the decimal numbers are accepted: the hexadecimal ones, which std::stod read, are malformed,
+    // otherwise "0x10" would be the delay of 0 seconds instead of 16
+    static std::optional<double> parseCrawlDelay(std::string_view value) noexcept
+    {
+        value.remove_prefix(std::min(value.find_first_not_of(" \t\v\f\r\n"), value.size()));
+
+        if (!value.empty() && value.front() == '+')
+        {
+            value.remove_prefix(1);
+        }
+
+        const std::string_view hexPrefix = value.substr(std::min(value.find_first_not_of("+-"), value.size()), 2);
+
+        if (hexPrefix == "0x" || hexPrefix == "0X")
+        {
+            return std::nullopt;
+        }
+
+        const std::optional<double> seconds = parseLeadingNumber(value);
+
+        if (!seconds || !(*seconds >= 0 && *seconds < s_maxIntervalSeconds))
+        {
+            return std::nullopt;
+        }
+
+        return seconds;
+    }
+
+    // "<HHMM>-<HHMM>" in UTC, e.g. "0600-0845"
+    static std::optional<VisitTime> parseVisitTime(std::string_view value) noexcept
+    {
+        const std::size_t dashPosition = value.find('-');
+
+        if (dashPosition == std::string_view::npos)
+        {
+            return std::nullopt;
+        }
+
+        const std::optional<std::chrono::minutes> begin = parseMinuteOfDay(StringHelpers::trimmedView(value.substr(0, dashPosition)));
+        const std::optional<std::chrono::minutes> end = parseMinuteOfDay(StringHelpers::trimmedView(value.substr(dashPosition + 1)));
+
+        if (!begin || !end)
+        {
+            return std::nullopt;
+        }
+
+        return VisitTime{ *begin, *end };
+    }
+
+    static std::optional<std::chrono::minutes> parseMinuteOfDay(std::string_view value) noexcept
+    {
+        unsigned time = 0;
+        const std::from_chars_result result = std::from_chars(value.data(), value.data() + value.size(), time);
+
+        if (value.size() != 4 || result.ec != std::errc() || result.ptr != value.data() + value.size() || time / 100 >= 24 || time % 100 >= 60)
+        {
+            return std::nullopt;
+        }
+
+        return std::chrono::minutes(time / 100 * 60 + time % 100);
+    }
+
+    // "<requests>/<period>[s|m|h|d] [<visit time>]", the period is in seconds by default
+    static std::optional<RequestRate> parseRequestRate(std::string_view value) noexcept
+    {
+        const char* const end = value.data() + value.size();
+
+        std::uint32_t requests = 0;
+        std::from_chars_result result = std::from_chars(value.data(), end, requests);
+
+        if (result.ec != std::errc() || requests == 0 || result.ptr == end || *result.ptr != '/')
+        {
+            return std::nullopt;
+        }
+
+        std::uint32_t period = 0;
+        result = std::from_chars(result.ptr + 1, end, period);
+
+        if (result.ec != std::errc() || period == 0)
+        {
+            return std::nullopt;
+        }
+
+        const char* position = result.ptr;
+        std::int64_t unit = 1;
+
+        if (position != end && *position != ' ' && *position != '\t')
+        {
+            unit = *position == 's' ? 1 : *position == 'm' ? 60 : *position == 'h' ? 3600 : *position == 'd' ? 86400 : 0;
+            ++position;
+        }
+
+        const std::chrono::seconds periodSeconds(period * unit);
+
+        if (unit == 0 || static_cast<double>(periodSeconds.count()) / requests >= s_maxIntervalSeconds)
+        {
+            return std::nullopt;
+        }
+
+        RequestRate requestRate{ requests, periodSeconds, std::nullopt };
+        const std::string_view visitTime = StringHelpers::trimmedView(value.substr(position - value.data()));
+
+        if (!visitTime.empty())
+        {
+            requestRate.visitTime = parseVisitTime(visitTime);
+
+            if (!requestRate.visitTime)
+            {
+                return std::nullopt;
+            }
+        }
+
+        return requestRate;
+    }
+
+    // adds the directive to the group, the malformed values are skipped and reported
+    void compileDirective(CompiledUserAgentGroup& group, RobotsTxtToken token, std::string_view value)
+    {
+        const auto report = [this, &group, token, value](const char* message)
+        {
+            m_parseDiagnostics.push_back(ParseDiagnostic{ group.userAgent, token, std::string(value), message });
+        };
+
+        switch (token)
+        {
+            case RobotsTxtToken::TokenAllow:
+            case RobotsTxtToken::TokenDisallow:
+            {
+                group.rules.emplace_back(token, value);
+                break;
+            }
+            case RobotsTxtToken::TokenCleanParam:
+            {
+                group.cleanParams.emplace_back(value);
+                break;
+            }
+            case RobotsTxtToken::TokenCrawlDelay:
+            {
+                const std::optional<double> crawlDelay = parseCrawlDelay(value);
+
+                if (!crawlDelay)
+                {
+                    report("expected a non-negative number of seconds");
+                }
+                else if (!group.crawlDelay)
+                {
+                    group.crawlDelay = crawlDelay;
+                }
+
+                break;
+            }
+            case RobotsTxtToken::TokenRequestRate:
+            {
+                const std::optional<RequestRate> requestRate = parseRequestRate(value);
+
+                if (!requestRate)
+                {
+                    report("expected <requests>/<period>[s|m|h|d] optionally followed by <HHMM>-<HHMM>");
+                }
+                else
+                {
+                    group.requestRates.push_back(*requestRate);
+                }
+
+                break;
+            }
+            case RobotsTxtToken::TokenVisitTime:
+            {
+                const std::optional<VisitTime> visitTime = parseVisitTime(value);
+
+                if (!visitTime)
+                {
+                    report("expected <HHMM>-<HHMM>");
+                }
+                else if (!group.visitTime)
+                {
+                    group.visitTime = visitTime;
+                }
+
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    // "Clean-param: p0[&p1&p2&..&pn] [path]", the directives with the same path are merged
+    static std::vector<CompiledCleanParam> compileCleanParams(const std::vector<std::string>& cleanParams)
+    {
+        std::vector<CompiledCleanParam> result;
+
+        for (const std::string& cleanParam : cleanParams)
+        {
+            const std::string_view value = StringHelpers::trimmedView(cleanParam);
+            const std::size_t parametersEnd = std::min(value.find_first_of(" \t"), value.size());
+            const std::string_view parameters = value.substr(0, parametersEnd);
+            const std::string_view pathPrefix = StringHelpers::trimmedView(value.substr(parametersEnd));
+
+            auto cleanParamIterator = std::find_if(result.begin(), result.end(), [pathPrefix](const CompiledCleanParam& compiledCleanParam)
+            {
+                return StringHelpers::equalsLowercase(pathPrefix, compiledCleanParam.pathPrefix.pattern());
+            });
+
+            if (cleanParamIterator == result.end())
+            {
+                cleanParamIterator = result.emplace(result.end(), pathPrefix);
+            }
+
+            for (std::size_t position = 0; position <= parameters.size();)
+            {
+                const std::size_t end = std::min(parameters.find('&', position), parameters.size());
+
+                if (end != position)
+                {
+                    cleanParamIterator->parameters.emplace_back(parameters.substr(position, end - position));
+                }
+
+                position = end + 1;
+            }
+        }
+
+        for (CompiledCleanParam& compiledCleanParam : result)
+        {
+            std::vector<std::string>& parameters = compiledCleanParam.parameters;
+
+            std::sort(parameters.begin(), parameters.end());
+            parameters.erase(std::unique(parameters.begin(), parameters.end()), parameters.end());
+        }
+
+        return result;
+    }
+
+    // drops the compiled groups, every URL is allowed until the groups are compiled again
+    void clearGroups()
+    {
+        m_groups.clear();
+        m_parseDiagnostics.clear();
+        m_groupIndexByUserAgent.fill(s_unsupportedUserAgent);
+
+        for (WellKnownUserAgent userAgent : MetaRobotsHelpers::wellKnownUserAgents())
+        {
+            m_groupIndexByUserAgent[static_cast<std::size_t>(userAgent)] = s_noGroup;
+        }
+    }
+
+    // the content fed partially has no rules yet
+    void compileCopiedGroups()
+    {
+        if (!m_feeding)
+        {
+            compileGroups();
+            return;
+        }
+
+        clearGroups();
+        compileVerdictIndex();
+    }
+
+    void compileGroups()
+    {
+        const std::vector<WellKnownUserAgent> wellKnownUserAgents = MetaRobotsHelpers::wellKnownUserAgents();
+
+        clearGroups();
+
+        if (!m_tokenizer.isValid())
+        {
+            // every URL is allowed
+            compileVerdictIndex();
+            return;
+        }
+
+        // the index of the group is the id of its user agent, so the user agents are resolved by one registry lookup
+        const UserAgentRegistry& userAgents = m_tokenizer.userAgents();
+        m_groups.resize(userAgents.size());
+
+        for (std::uint32_t userAgentId = 0; userAgentId < userAgents.size(); ++userAgentId)
+        {
+            m_groups[userAgentId].userAgent = userAgents.name(userAgentId);
+        }
+
+        // one pass over the directives of all user agents
+        m_tokenizer.forEachDirective([this](std::uint32_t userAgentId, RobotsTxtToken token, std::string_view value)
         {
-            std::string resultQuery;
+            compileDirective(m_groups[userAgentId], token, value);
+        });
 
-            for (const Url::KeyVal& keyVal : query)
+        for (CompiledUserAgentGroup& group : m_groups)
+        {
+            // the rule index is the precedence: the longest patterns go first and Allow goes first among the equal ones
+            std::stable_sort(group.rules.begin(), group.rules.end(), [](const CompiledRule& first, const CompiledRule& second)
             {
-                resultQuery += keyVal.key() + "=" + keyVal.val();
-            }
+                return first.pattern.specificity() > second.pattern.specificity() ||
+                    (first.pattern.specificity() == second.pattern.specificity() &&
+                        first.type == RobotsTxtToken::TokenAllow && second.type != RobotsTxtToken::TokenAllow);
+            });
 
-            return resultQuery;
-        };
+            std::vector<RobotsTxtPrefixTree::Entry> literalRules;
 
-        const Url cleanedUrl = url;
-        const Url::Query query = cleanedUrl.query();
-        const std::string urlPath = cleanedUrl.path() + (query.empty() ? std::string() : std::string("?") + makeQueryString(query));
+            for (std::size_t ruleIndex = 0; ruleIndex < group.rules.size(); ++ruleIndex)
+            {
+                const RobotsTxtPattern& pattern = group.rules[ruleIndex].pattern;
 
-        std::vector<TokenValue> tokens = allowAndDisallowTokensFor(userAgent);
+                if (pattern.pattern().empty())
+                {
+                    // an empty value matches nothing, e.g. "Disallow:" allows everything
+                    continue;
+                }
 
-        if (tokens.empty())
-        {
-            tokens = allowAndDisallowTokensFor(MetaRobotsHelpers::userAgentString(WellKnownUserAgent::AllRobots));
-        }
+                if (pattern.isLiteral())
+                {
+                    literalRules.push_back(RobotsTxtPrefixTree::Entry{ pattern.pattern(), ruleIndex, pattern.specificity() });
+                }
+                else
+                {
+                    group.wildcardRules.push_back(ruleIndex);
+                }
+            }
 
-        std::vector<std::pair<int, bool>> allowDisallowResults;
+            group.literalRules = RobotsTxtPrefixTree(std::move(literalRules), m_tokenizer.directiveValues());
+            group.prefilter = RobotsTxtPathPrefilter(group.rules);
+            group.compiledCleanParams = compileCleanParams(group.cleanParams);
+        }
 
-        for (const TokenValue& token : tokens)
+        for (WellKnownUserAgent userAgent : wellKnownUserAgents)
         {
-            const std::pair<bool, int> result = patternMatched(token.value, urlPath);
+            const std::uint32_t userAgentId = userAgents.find(MetaRobotsHelpers::userAgentString(userAgent));
 
-            if (result.first)
+            if (userAgentId != UserAgentRegistry::npos)
             {
-                const bool isAllowed = token.type == RobotsTxtToken::TokenAllow ? true : false;
-                allowDisallowResults.push_back(std::make_pair(result.second, isAllowed));
+                m_groupIndexByUserAgent[static_cast<std::size_t>(userAgent)] = userAgentId;
             }
         }
 
-        std::sort(allowDisallowResults.begin(), allowDisallowResults.end(), [](const auto& lhs, const auto& rhs)
-            {
-                return lhs.first > rhs.first;
-            });
-
-        // if URL is not matched to any pattern then we treat this as an allowed URL
-        return allowDisallowResults.empty() ? true : allowDisallowResults.front().second;
+        compileVerdictIndex();
     }
 
-    double crawlDelay(WellKnownUserAgent userAgent) const
+    // groups the well known user agents by the rules applied to them and merges the rules of all groups:
+    // the equal patterns of different groups get one entry in the shared tree or one wildcard pattern index
+    void compileVerdictIndex()
     {
-        return crawlDelay(MetaRobotsHelpers::userAgentString(userAgent));
-    }
+        m_verdictSlots.clear();
+        m_literalOccurrenceOffsets.clear();
+        m_literalOccurrences.clear();
+        m_wildcardPatternIndices.clear();
+        m_wildcardPatternCount = 0;
+        m_wellKnownUserAgentsMask = 0;
+        m_alwaysAllowedMask = 0;
 
-    double crawlDelay(const std::string& userAgent) const
-    {
-        try
+        for (WellKnownUserAgent userAgent : MetaRobotsHelpers::wellKnownUserAgents())
         {
-            const std::vector<std::string> tokenValues =
-                m_tokenizer.tokenValues(userAgent, RobotsTxtToken::TokenCrawlDelay);
+            const std::uint32_t userAgentBit = UserAgentVerdicts::bit(userAgent);
+            const CompiledUserAgentGroup* rulesGroup = resolveGroup(groupAt(m_groupIndexByUserAgent[static_cast<std::size_t>(userAgent)])).rulesGroup;
 
-            if (tokenValues.empty())
+            m_wellKnownUserAgentsMask |= userAgentBit;
+
+            if (!rulesGroup)
             {
-                throw std::runtime_error("There is no crawl delay token for specified user agent");
+                m_alwaysAllowedMask |= userAgentBit;
+                continue;
             }
 
-            return std::stod(tokenValues.front());
-        }
-        catch (const std::invalid_argument&)
-        {
-            throw std::runtime_error("Invalid crawl delay format");
-        }
-        catch (const std::out_of_range&)
-        {
-            throw std::runtime_error("The resulting double number is out of range");
-        }
-    }
+            const std::uint32_t groupIndex = static_cast<std::uint32_t>(rulesGroup - m_groups.data());
 
-    std::vector<std::string> cleanParam(WellKnownUserAgent userAgent) const
-    {
-        return m_tokenizer.tokenValues(userAgent, RobotsTxtToken::TokenCleanParam);
-    }
+            const auto slotIterator = std::find_if(m_verdictSlots.begin(), m_verdictSlots.end(), [groupIndex](const VerdictSlot& slot)
+            {
+                return slot.groupIndex == groupIndex;
+            });
 
-    std::vector<std::string> cleanParam(const std::string& userAgent) const
-    {
-        return m_tokenizer.tokenValues(userAgent, RobotsTxtToken::TokenCleanParam);
-    }
+            if (slotIterator != m_verdictSlots.end())
+            {
+                slotIterator->userAgentMask |= userAgentBit;
+                continue;
+            }
 
-    bool hasRulesFor(WellKnownUserAgent userAgent) const
-    {
-        return m_tokenizer.hasUserAgentRecord(userAgent);
-    }
+            m_verdictSlots.push_back(VerdictSlot{ groupIndex, userAgentBit, 0 });
+        }
 
-    bool hasRulesFor(const std::string& userAgent) const
-    {
-        return m_tokenizer.hasUserAgentRecord(userAgent);
-    }
+        // the rules of all slots sorted by the pattern, the equal patterns become adjacent and get one index
+        std::vector<std::pair<std::string_view, std::size_t>> wildcardPatterns;
+        std::vector<std::pair<std::string_view, RuleOccurrence>> literalPatterns;
 
-    const std::string& sitemapUrl() const noexcept
-    {
-        return m_tokenizer.sitemapUrl();
-    }
+        for (std::size_t slot = 0; slot < m_verdictSlots.size(); ++slot)
+        {
+            VerdictSlot& verdictSlot = m_verdictSlots[slot];
+            const CompiledUserAgentGroup& group = m_groups[verdictSlot.groupIndex];
 
-private:
-    // returns true if the value matches the pattern and folder nesting level
-    std::pair<bool, int> patternMatched(const std::string& pattern, const std::string& value) const
-    {
-        const std::string cannonicalPattern = StringHelpers::toLower(pattern);
-        const std::string cannonicalValue = StringHelpers::toLower(value);
+            verdictSlot.wildcardOffset = static_cast<std::uint32_t>(wildcardPatterns.size());
 
-        const std::string::size_type dollarIndex = cannonicalPattern.find("$");
-        const bool patternContainsStar = cannonicalPattern.find("*") != std::string::npos;
-        const bool patternContainsDollar = dollarIndex != std::string::npos;
+            for (const std::size_t ruleIndex : group.wildcardRules)
+            {
+                wildcardPatterns.emplace_back(group.rules[ruleIndex].pattern.pattern(), wildcardPatterns.size());
+            }
 
-        const int nestingPatternLevel = static_cast<int>(StringHelpers::split(
-            cannonicalPattern,
-            "/",
-            StringHelpers::SkipEmptyParts,
-            StringHelpers::CaseSensitive).size());
+            for (std::size_t ruleIndex = 0; ruleIndex < group.rules.size(); ++ruleIndex)
+            {
+                const RobotsTxtPattern& pattern = group.rules[ruleIndex].pattern;
 
-        if (!patternContainsStar && !patternContainsDollar)
-        {
-            return std::make_pair(StringHelpers::startsWith(cannonicalValue, cannonicalPattern), nestingPatternLevel);
+                if (!pattern.pattern().empty() && pattern.isLiteral())
+                {
+                    literalPatterns.emplace_back(pattern.pattern(), RuleOccurrence{ static_cast<std::uint32_t>(slot), ruleIndex, pattern.specificity() });
+                }
+            }
         }
 
-        if (patternContainsDollar && dollarIndex != cannonicalPattern.size() - 1)
+        std::sort(wildcardPatterns.begin(), wildcardPatterns.end());
+        m_wildcardPatternIndices.resize(wildcardPatterns.size());
+
+        for (std::size_t i = 0; i < wildcardPatterns.size(); ++i)
         {
-            // bad pattern
-            return std::make_pair(false, nestingPatternLevel);
+            m_wildcardPatternCount += i == 0 || wildcardPatterns[i].first != wildcardPatterns[i - 1].first ? 1 : 0;
+            m_wildcardPatternIndices[wildcardPatterns[i].second] = static_cast<std::uint32_t>(m_wildcardPatternCount - 1);
         }
 
-        StringHelpers::StringList parts = StringHelpers::split(
-            cannonicalPattern, "*", StringHelpers::SkipEmptyParts, StringHelpers::CaseSensitive);
+        std::sort(literalPatterns.begin(), literalPatterns.end(), [](const auto& first, const auto& second)
+        {
+            return first.first != second.first ? first.first < second.first :
+                first.second.slot != second.second.slot ? first.second.slot < second.second.slot : first.second.ruleIndex < second.second.ruleIndex;
+        });
 
-        std::string::size_type index = 0;
-        bool matched = true;
+        std::vector<RobotsTxtPrefixTree::Entry> literalEntries;
+        m_literalOccurrences.reserve(literalPatterns.size());
+        m_literalOccurrenceOffsets.push_back(0);
 
-        for (int i = 0; i < parts.size(); i++)
+        for (std::size_t i = 0; i < literalPatterns.size(); ++i)
         {
-            const bool lastPart = i == parts.size() - 1;
-            bool strongMatch = false;
+            const auto& [pattern, occurrence] = literalPatterns[i];
 
-            if (lastPart && StringHelpers::endsWith(parts[i], "$"))
+            if (i == 0 || pattern != literalPatterns[i - 1].first)
             {
-                strongMatch = true;
-                assert(!strongMatch || lastPart);
-                parts[i] = parts[i].substr(0, parts[i].size() - 1);
+                literalEntries.push_back(RobotsTxtPrefixTree::Entry{ pattern, literalEntries.size(), occurrence.priority });
             }
 
-            if (i == 0 || StringHelpers::startsWith(cannonicalPattern, "*"))
+            m_literalOccurrences.push_back(occurrence);
+
+            if (i + 1 == literalPatterns.size() || pattern != literalPatterns[i + 1].first)
             {
-                matched = strongMatch ?
-                    StringHelpers::endsWith(cannonicalValue, parts[i], StringHelpers::CaseInsensitive) :
-                    cannonicalValue.find(parts[i]) != std::string::npos;
+                m_literalOccurrenceOffsets.push_back(static_cast<std::uint32_t>(m_literalOccurrences.size()));
+            }
+        }
 
-                if (!matched)
-                {
-                    break;
-                }
+        m_sharedLiteralRules = RobotsTxtPrefixTree(std::move(literalEntries), m_tokenizer.directiveValues());
+    }
 
-                if (!strongMatch)
-                {
-                    // can return std::string::npos
-                    index = cannonicalValue.find(parts[i]) + parts[i].size();
-                }
+private:
+    static constexpr std::uint32_t s_noGroup = std::numeric_limits<std::uint32_t>::max();
 
-                continue;
-            }
+    // the longer intervals are considered malformed, it's about 11 days
+    static constexpr double s_maxIntervalSeconds = 1e6;
 
-            const std::string::size_type matchedIndex = cannonicalValue.find(parts[i], index);
-            matched = strongMatch ? matchedIndex + parts[i].size() == cannonicalPattern.size() - 1 : matchedIndex != -1;
+    // the user agent has no name, see MetaRobotsHelpers::userAgentString
+    static constexpr std::uint32_t s_unsupportedUserAgent = s_noGroup - 1;
 
-            if (!matched)
-            {
-                break;
-            }
+    RobotsTxtTokenizer m_tokenizer;
 
-            index = matchedIndex + parts[i].size();
-        }
+    // indexed by the user agent id (see RobotsTxtTokenizer::userAgents), the groups are never added after compiling, so the handles to them stay valid
+    std::vector<CompiledUserAgentGroup> m_groups;
 
-        return std::make_pair(matched, nestingPatternLevel);
-    }
+    // in the order of appearance
+    std::vector<ParseDiagnostic> m_parseDiagnostics;
+
+    // the index in m_groups for every well known user agent, s_noGroup if it has no record
+    // the groups are looked up by the enum value without building the user agent name
+    std::array<std::uint32_t, static_cast<std::size_t>(WellKnownUserAgent::AllRobots) + 1> m_groupIndexByUserAgent;
+
+    //
+    // the index for the verdicts of all well known user agents, see compileVerdictIndex
+    //
+
+    static constexpr std::size_t s_maxVerdictSlots = static_cast<std::size_t>(WellKnownUserAgent::AllRobots) + 1;
+
+    // the wildcard match results of up to 1024 distinct patterns are remembered on the stack
+    static constexpr std::size_t s_stackMemoWords = 16;
 
-    std::vector<TokenValue> allowAndDisallowTokensFor(const std::string& userAgent) const
+    // the group of rules applied to some of the well known user agents
+    struct VerdictSlot
     {
-        std::vector<std::string> allowTokens = m_tokenizer.tokenValues(userAgent, RobotsTxtToken::TokenAllow);
-        std::vector<std::string> disallowTokens = m_tokenizer.tokenValues(userAgent, RobotsTxtToken::TokenDisallow);
+        std::uint32_t groupIndex;
+        std::uint32_t userAgentMask;
 
-        std::vector<TokenValue> tokens;
+        // the wildcard pattern indices of the group rules start at m_wildcardPatternIndices[wildcardOffset]
+        std::uint32_t wildcardOffset;
+    };
 
-        for (const std::string& disallowTokenValue : allowTokens)
-        {
-            tokens.emplace_back(RobotsTxtToken::TokenAllow, disallowTokenValue);
-        }
-        for (const std::string& disallowTokenValue : disallowTokens)
-        {
-            tokens.emplace_back(RobotsTxtToken::TokenDisallow, disallowTokenValue);
-        }
+    // the literal rule of the verdict slot group
+    struct RuleOccurrence
+    {
+        std::uint32_t slot;
+        std::size_t ruleIndex;
+        int priority;
+    };
 
-        return tokens;
-    }
+    std::vector<VerdictSlot> m_verdictSlots;
 
-private:
-    RobotsTxtTokenizer m_tokenizer;
+    // the distinct literal patterns of all groups, the rule index of the tree is the index of the distinct pattern
+    // and the rules of the groups with this pattern are m_literalOccurrences[offsets[index], offsets[index + 1])
+    RobotsTxtPrefixTree m_sharedLiteralRules;
+    std::vector<std::uint32_t> m_literalOccurrenceOffsets;
+    std::vector<RuleOccurrence> m_literalOccurrences;
+
+    // the index of the distinct wildcard pattern for every wildcard rule of the verdict slot groups
+    std::vector<std::uint32_t> m_wildcardPatternIndices;
+    std::size_t m_wildcardPatternCount;
+
+    std::uint32_t m_wellKnownUserAgentsMask;
+
+    // the user agents without any rules applied
+    std::uint32_t m_alwaysAllowedMask;
+
+    // the counters of the checks are updated by the const methods, the object keeps them only if they are enabled
+    ObjectCounters m_counters;
+
+    // the time taken by the feeds since the last finish
+    std::uint64_t m_feedNanoseconds;
+
+    // the chunks of the new content are fed, the rules are compiled on finish
+    bool m_feeding;
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -263,34 +1342,222 @@ void RobotsTxtRules::parse(const std::string& robotsTxtContent)
     m_impl->parse(robotsTxtContent);
 }
 
+void RobotsTxtRules::feed(std::string_view chunk)
+{
+    m_impl->feed(chunk);
+}
+
+void RobotsTxtRules::finish()
+{
+    m_impl->finish();
+}
+
+void RobotsTxtRules::setMaxContentSize(std::size_t maxContentSize) noexcept
+{
+    m_impl->setMaxContentSize(maxContentSize);
+}
+
+bool RobotsTxtRules::isTruncated() const noexcept
+{
+    return m_impl->isTruncated();
+}
+
+UserAgentGroup RobotsTxtRules::resolveGroup(WellKnownUserAgent userAgent) const
+{
+    const RobotsTxtRulesImpl::ResolvedGroup resolvedGroup = m_impl->resolveGroup(userAgent);
+    return UserAgentGroup(resolvedGroup.ownGroup, resolvedGroup.rulesGroup);
+}
+
+UserAgentGroup RobotsTxtRules::resolveGroup(const std::string& userAgent) const
+{
+    const RobotsTxtRulesImpl::ResolvedGroup resolvedGroup = m_impl->resolveGroup(userAgent);
+    return UserAgentGroup(resolvedGroup.ownGroup, resolvedGroup.rulesGroup);
+}
+
+UserAgentGroup RobotsTxtRules::resolveGroupFromHeader(std::string_view userAgentHeader) const noexcept
+{
+    const RobotsTxtRulesImpl::ResolvedGroup resolvedGroup = m_impl->resolveGroupFromHeader(userAgentHeader);
+    return UserAgentGroup(resolvedGroup.ownGroup, resolvedGroup.rulesGroup);
+}
+
+const UserAgentRegistry& RobotsTxtRules::userAgents() const noexcept
+{
+    return m_impl->userAgents();
+}
+
 bool RobotsTxtRules::isUrlAllowed(const std::string& url, WellKnownUserAgent userAgent) const
 {
-    return m_impl->isUrlAllowed(url, userAgent);
+    return isUrlAllowed(url, resolveGroup(userAgent));
 }
 
 bool RobotsTxtRules::isUrlAllowed(const std::string& url, const std::string& userAgent) const
 {
-    return m_impl->isUrlAllowed(url, userAgent);
+    return isUrlAllowed(url, resolveGroup(userAgent));
+}
+
+bool RobotsTxtRules::isUrlAllowed(const std::string& url, const UserAgentGroup& userAgentGroup) const
+{
+    return m_impl->isUrlAllowed(url, userAgentGroup.m_rulesGroup);
+}
+
+bool RobotsTxtRules::isPathAllowed(std::string_view pathAndQuery, WellKnownUserAgent userAgent) const
+{
+    return isPathAllowed(pathAndQuery, resolveGroup(userAgent));
+}
+
+bool RobotsTxtRules::isPathAllowed(std::string_view pathAndQuery, const std::string& userAgent) const
+{
+    return isPathAllowed(pathAndQuery, resolveGroup(userAgent));
+}
+
+bool RobotsTxtRules::isPathAllowed(std::string_view pathAndQuery, const UserAgentGroup& userAgentGroup) const
+{
+    return m_impl->isPathAllowed(pathAndQuery, userAgentGroup.m_rulesGroup);
+}
+
+void RobotsTxtRules::areUrlsAllowed(const std::vector<std::string>& urls, WellKnownUserAgent userAgent, std::vector<bool>& verdicts) const
+{
+    areUrlsAllowed(urls, resolveGroup(userAgent), verdicts);
+}
+
+void RobotsTxtRules::areUrlsAllowed(const std::vector<std::string>& urls, const std::string& userAgent, std::vector<bool>& verdicts) const
+{
+    areUrlsAllowed(urls, resolveGroup(userAgent), verdicts);
+}
+
+void RobotsTxtRules::areUrlsAllowed(const std::vector<std::string>& urls, const UserAgentGroup& userAgentGroup, std::vector<bool>& verdicts) const
+{
+    m_impl->areUrlsAllowed(urls, userAgentGroup.m_rulesGroup, verdicts);
+}
+
+void RobotsTxtRules::arePathsAllowed(const std::vector<std::string_view>& pathsAndQueries, WellKnownUserAgent userAgent, std::vector<bool>& verdicts) const
+{
+    arePathsAllowed(pathsAndQueries, resolveGroup(userAgent), verdicts);
+}
+
+void RobotsTxtRules::arePathsAllowed(const std::vector<std::string_view>& pathsAndQueries, const std::string& userAgent, std::vector<bool>& verdicts) const
+{
+    arePathsAllowed(pathsAndQueries, resolveGroup(userAgent), verdicts);
+}
+
+void RobotsTxtRules::arePathsAllowed(const std::vector<std::string_view>& pathsAndQueries, const UserAgentGroup& userAgentGroup, std::vector<bool>& verdicts) const
+{
+    m_impl->arePathsAllowed(pathsAndQueries, userAgentGroup.m_rulesGroup, verdicts);
+}
+
+UserAgentVerdicts RobotsTxtRules::urlVerdicts(const std::string& url) const
+{
+    return m_impl->urlVerdicts(url);
+}
+
+UserAgentVerdicts RobotsTxtRules::pathVerdicts(std::string_view pathAndQuery) const
+{
+    return m_impl->pathVerdicts(pathAndQuery);
 }
 
 double RobotsTxtRules::crawlDelay(WellKnownUserAgent userAgent) const
 {
-    return m_impl->crawlDelay(userAgent);
+    return crawlDelay(resolveGroup(userAgent));
 }
 
 double RobotsTxtRules::crawlDelay(const std::string& userAgent) const
 {
-    return m_impl->crawlDelay(userAgent);
+    return crawlDelay(resolveGroup(userAgent));
+}
+
+double RobotsTxtRules::crawlDelay(const UserAgentGroup& userAgentGroup) const
+{
+    return m_impl->crawlDelay(userAgentGroup.m_ownGroup);
+}
+
+std::optional<double> RobotsTxtRules::tryCrawlDelay(WellKnownUserAgent userAgent) const
+{
+    return tryCrawlDelay(resolveGroup(userAgent));
+}
+
+std::optional<double> RobotsTxtRules::tryCrawlDelay(const std::string& userAgent) const
+{
+    return tryCrawlDelay(resolveGroup(userAgent));
+}
+
+std::optional<double> RobotsTxtRules::tryCrawlDelay(const UserAgentGroup& userAgentGroup) const noexcept
+{
+    return m_impl->tryCrawlDelay(userAgentGroup.m_ownGroup);
+}
+
+std::vector<RequestRate> RobotsTxtRules::requestRates(WellKnownUserAgent userAgent) const
+{
+    return requestRates(resolveGroup(userAgent));
+}
+
+std::vector<RequestRate> RobotsTxtRules::requestRates(const std::string& userAgent) const
+{
+    return requestRates(resolveGroup(userAgent));
+}
+
+const std::vector<RequestRate>& RobotsTxtRules::requestRates(const UserAgentGroup& userAgentGroup) const noexcept
+{
+    return m_impl->requestRates(userAgentGroup.m_ownGroup);
+}
+
+std::optional<VisitTime> RobotsTxtRules::visitTime(WellKnownUserAgent userAgent) const
+{
+    return visitTime(resolveGroup(userAgent));
+}
+
+std::optional<VisitTime> RobotsTxtRules::visitTime(const std::string& userAgent) const
+{
+    return visitTime(resolveGroup(userAgent));
+}
+
+std::optional<VisitTime> RobotsTxtRules::visitTime(const UserAgentGroup& userAgentGroup) const noexcept
+{
+    return m_impl->visitTime(userAgentGroup.m_ownGroup);
+}
+
+std::chrono::milliseconds RobotsTxtRules::fetchInterval(WellKnownUserAgent userAgent) const
+{
+    return fetchInterval(resolveGroup(userAgent));
+}
+
+std::chrono::milliseconds RobotsTxtRules::fetchInterval(const std::string& userAgent) const
+{
+    return fetchInterval(resolveGroup(userAgent));
+}
+
+std::chrono::milliseconds RobotsTxtRules::fetchInterval(const UserAgentGroup& userAgentGroup) const noexcept
+{
+    return m_impl->fetchInterval(userAgentGroup.m_ownGroup);
 }
 
 std::vector<std::string> RobotsTxtRules::cleanParam(WellKnownUserAgent userAgent) const
 {
-    return m_impl->cleanParam(userAgent);
+    return cleanParam(resolveGroup(userAgent));
 }
 
 std::vector<std::string> RobotsTxtRules::cleanParam(const std::string& userAgent) const
 {
-    return m_impl->cleanParam(userAgent);
+    return cleanParam(resolveGroup(userAgent));
+}
+
+const std::vector<std::string>& RobotsTxtRules::cleanParam(const UserAgentGroup& userAgentGroup) const
+{
+    return m_impl->cleanParam(userAgentGroup.m_ownGroup);
+}
+
+std::string_view RobotsTxtRules::canonicalize(std::string_view url, WellKnownUserAgent userAgent, std::string& buffer) const
+{
+    return canonicalize(url, resolveGroup(userAgent), buffer);
+}
+
+std::string_view RobotsTxtRules::canonicalize(std::string_view url, const std::string& userAgent, std::string& buffer) const
+{
+    return canonicalize(url, resolveGroup(userAgent), buffer);
+}
+
+std::string_view RobotsTxtRules::canonicalize(std::string_view url, const UserAgentGroup& userAgentGroup, std::string& buffer) const
+{
+    return m_impl->canonicalize(url, userAgentGroup.m_ownGroup, buffer);
 }
 
 bool RobotsTxtRules::hasRulesFor(WellKnownUserAgent userAgent) const
@@ -308,4 +1575,84 @@ const std::string& RobotsTxtRules::sitemapUrl() const noexcept
     return m_impl->sitemapUrl();
 }
 
+const std::vector<ParseDiagnostic>& RobotsTxtRules::parseDiagnostics() const noexcept
+{
+    return m_impl->parseDiagnostics();
+}
+
+std::size_t RobotsTxtRules::memoryUsage() const noexcept
+{
+    return sizeof(*this) + m_impl->memoryUsage();
+}
+
+void RobotsTxtRules::setCountersEnabled(bool enabled)
+{
+    m_impl->setCountersEnabled(enabled);
+}
+
+RobotsTxtCounters RobotsTxtRules::counters() const noexcept
+{
+    return m_impl->counters();
+}
+
+void RobotsTxtRules::forEachGroup(const std::function<void(const std::string&, const CompiledUserAgentGroup&)>& visitor) const
+{
+    m_impl->forEachGroup(visitor);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+UserAgentGroup::UserAgentGroup() noexcept
+    : UserAgentGroup(nullptr, nullptr)
+{
+}
+
+UserAgentGroup::UserAgentGroup(const CompiledUserAgentGroup* ownGroup, const CompiledUserAgentGroup* rulesGroup) noexcept
+    : m_ownGroup(ownGroup)
+    , m_rulesGroup(rulesGroup)
+{
+}
+
+bool UserAgentGroup::hasOwnRecord() const noexcept
+{
+    return m_ownGroup != nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+UserAgentVerdicts::UserAgentVerdicts() noexcept
+    : UserAgentVerdicts(0)
+{
+}
+
+UserAgentVerdicts::UserAgentVerdicts(std::uint32_t mask) noexcept
+    : m_mask(mask)
+{
+}
+
+bool UserAgentVerdicts::isAllowed(WellKnownUserAgent userAgent) const noexcept
+{
+    return (m_mask & bit(userAgent)) != 0;
+}
+
+std::uint32_t UserAgentVerdicts::mask() const noexcept
+{
+    return m_mask;
+}
+
+std::uint32_t UserAgentVerdicts::bit(WellKnownUserAgent userAgent) noexcept
+{
+    return std::uint32_t(1) << static_cast<std::uint32_t>(userAgent);
+}
+
+bool UserAgentVerdicts::operator==(const UserAgentVerdicts& other) const noexcept
+{
+    return m_mask == other.m_mask;
+}
+
+bool UserAgentVerdicts::operator!=(const UserAgentVerdicts& other) const noexcept
+{
+    return !(*this == other);
+}
+
 }
\ No newline at end of file
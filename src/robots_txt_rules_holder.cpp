@@ -0,0 +1,66 @@
+﻿#include "robots_txt_rules_holder.h"
+
+namespace cpprobotparser
+{
+
+class RobotsTxtRulesHolder::RobotsTxtRulesHolderImpl final
+{
+public:
+    RobotsTxtRulesHolderImpl()
+        : m_snapshot(std::make_shared<const RobotsTxtRules>())
+    {
+    }
+
+    RobotsTxtRulesSnapshot snapshot() const
+    {
+        return std::atomic_load(&m_snapshot);
+    }
+
+    void publish(RobotsTxtRulesSnapshot snapshot)
+    {
+        if (!snapshot)
+        {
+            snapshot = std::make_shared<const RobotsTxtRules>();
+        }
+
+        // the previous snapshot is only released here: it's kept until the end of the scope,
+        // so if no reader holds it, the rules are destroyed after the exchange has released its lock
+        const RobotsTxtRulesSnapshot previousSnapshot = std::atomic_exchange(&m_snapshot, std::move(snapshot));
+        static_cast<void>(previousSnapshot);
+    }
+
+private:
+    // accessed only through the atomic operations
+    RobotsTxtRulesSnapshot m_snapshot;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+RobotsTxtRulesHolder::RobotsTxtRulesHolder(RobotsTxtRulesSnapshot snapshot)
+    : RobotsTxtRulesHolder()
+{
+    publish(std::move(snapshot));
+}
+
+RobotsTxtRulesHolder::RobotsTxtRulesHolder() = default;
+RobotsTxtRulesHolder::~RobotsTxtRulesHolder() = default;
+
+RobotsTxtRulesSnapshot RobotsTxtRulesHolder::snapshot() const
+{
+    return m_impl->snapshot();
+}
+
+RobotsTxtRulesSnapshot RobotsTxtRulesHolder::reload(const std::string& robotsTxtContent)
+{
+    RobotsTxtRulesSnapshot snapshot = std::make_shared<const RobotsTxtRules>(robotsTxtContent);
+    publish(snapshot);
+
+    return snapshot;
+}
+
+void RobotsTxtRulesHolder::publish(RobotsTxtRulesSnapshot snapshot)
+{
+    m_impl->publish(std::move(snapshot));
+}
+
+}
\ No newline at end of file
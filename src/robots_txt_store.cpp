@@ -0,0 +1,688 @@
+﻿#include "robots_txt_store.h"
+#include "compiled_user_agent_group.h"
+#include "meta_robots_helpers.h"
+#include "url_helpers.h"
+#include "mapped_file.h"
+#include "user_agent_registry.h"
+#include "string_helpers.h"
+
+namespace
+{
+
+using namespace cpprobotparser;
+
+//
+// The store file layout, every structure starts at the offset aligned to 8 bytes:
+//
+// FileHeader
+// origin records: HostRecordHeader, GroupRecord[groupCount], then the arrays and strings of the groups
+// origin strings
+// HostEntry[hostCount] sorted by the origin hash and then by the origin
+//
+// The offsets of FileHeader and HostEntry are relative to the beginning of the file,
+// the offsets inside an origin record are relative to the beginning of the record.
+//
+
+constexpr char s_magic[8] = { 'C', 'P', 'P', 'R', 'O', 'B', 'O', 'T' };
+// 2: the rules are ordered and ranked by the pattern length (RFC 9309)
+// 3: the groups keep the path prefilters
+constexpr std::uint32_t s_version = 3;
+
+// written in the native byte order, the file written on the machine with the other byte order is rejected
+constexpr std::uint32_t s_byteOrderMark = 0x01020304;
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint64_t hostCount;
+    std::uint64_t hostTableOffset;
+};
+
+struct HostEntry
+{
+    std::uint64_t originHash;
+    std::uint64_t originOffset;
+    std::uint64_t hostRecordOffset;
+    std::uint32_t originLength;
+    std::uint32_t reserved;
+};
+
+struct HostRecordHeader
+{
+    std::uint32_t groupCount;
+    std::uint32_t reserved;
+};
+
+// only the groups with at least one rule are stored
+struct GroupRecord
+{
+    std::uint32_t userAgentOffset;
+    std::uint32_t userAgentLength;
+    std::uint32_t rulesOffset;
+    std::uint32_t ruleCount;
+    std::uint32_t wildcardRulesOffset;
+    std::uint32_t wildcardRuleCount;
+    std::uint32_t nodesOffset;
+    std::uint32_t nodeCount;
+    std::uint32_t labelsOffset;
+    std::uint32_t labelsLength;
+    std::uint32_t prefilterOffset;
+    std::uint32_t reserved;
+};
+
+struct RuleRecord
+{
+    std::uint32_t patternOffset;
+    std::uint32_t patternLength;
+    std::uint32_t segmentsOffset;
+    std::uint32_t segmentCount;
+    std::int32_t specificity;
+    std::uint8_t allow;
+    std::uint8_t flags;
+    std::uint16_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 32 && sizeof(HostEntry) == 32, "unexpected padding in the store file layout");
+static_assert(sizeof(HostRecordHeader) == 8 && sizeof(GroupRecord) == 48 && sizeof(RuleRecord) == 24, "unexpected padding in the store file layout");
+static_assert(sizeof(RobotsTxtPattern::Segment) == 8 && sizeof(RobotsTxtPrefixTree::Node) == 24, "unexpected padding in the store file layout");
+static_assert(sizeof(RobotsTxtPathPrefilter) == 136, "unexpected padding in the store file layout");
+
+constexpr std::size_t s_alignment = 8;
+
+// FNV-1a
+std::uint64_t originHash(std::string_view origin) noexcept
+{
+    std::uint64_t hash = 14695981039346656037ull;
+
+    for (const char ch : origin)
+    {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+void alignTo(std::string& buffer, std::size_t alignment)
+{
+    buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, '\0');
+}
+
+//! Appends the aligned values to the buffer and returns their offset
+template <typename T>
+std::uint32_t append(std::string& buffer, const T* values, std::size_t count)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be stored");
+
+    alignTo(buffer, s_alignment);
+
+    const std::size_t offset = buffer.size();
+
+    if (count != 0)
+    {
+        buffer.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+    }
+
+    if (buffer.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::runtime_error("The rules of the origin are too large to be stored");
+    }
+
+    return static_cast<std::uint32_t>(offset);
+}
+
+template <typename T>
+const T* recordAt(const char* base, std::uint64_t offset) noexcept
+{
+    return reinterpret_cast<const T*>(base + offset);
+}
+
+}
+
+namespace cpprobotparser
+{
+
+class RobotsTxtStoreWriter::RobotsTxtStoreWriterImpl final
+{
+public:
+    struct Group
+    {
+        const std::string* userAgent;
+        const CompiledUserAgentGroup* group;
+    };
+
+    void add(std::string_view origin, const std::vector<Group>& groups)
+    {
+        m_hostRecords[std::string(origin)] = hostRecord(groups);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_hostRecords.size();
+    }
+
+    void write(const std::string& filePath) const
+    {
+        std::vector<std::pair<std::uint64_t, const std::string*>> origins;
+        origins.reserve(m_hostRecords.size());
+
+        for (const auto& [origin, hostRecord] : m_hostRecords)
+        {
+            origins.emplace_back(originHash(origin), &origin);
+        }
+
+        std::sort(origins.begin(), origins.end(), [](const auto& first, const auto& second)
+        {
+            return first.first != second.first ? first.first < second.first : *first.second < *second.second;
+        });
+
+        std::string hostRecords;
+        std::string originStrings;
+        std::vector<HostEntry> hostTable;
+        hostTable.reserve(origins.size());
+
+        for (const auto& [hash, origin] : origins)
+        {
+            alignTo(hostRecords, s_alignment);
+
+            hostTable.push_back(HostEntry{ hash, originStrings.size(), hostRecords.size(), static_cast<std::uint32_t>(origin->size()), 0 });
+
+            hostRecords.append(m_hostRecords.at(*origin));
+            originStrings.append(*origin);
+        }
+
+        alignTo(hostRecords, s_alignment);
+        alignTo(originStrings, s_alignment);
+
+        const std::uint64_t hostRecordsOffset = sizeof(FileHeader);
+        const std::uint64_t originsOffset = hostRecordsOffset + hostRecords.size();
+
+        for (HostEntry& hostEntry : hostTable)
+        {
+            hostEntry.hostRecordOffset += hostRecordsOffset;
+            hostEntry.originOffset += originsOffset;
+        }
+
+        FileHeader header{};
+        std::copy(std::begin(s_magic), std::end(s_magic), header.magic);
+        header.version = s_version;
+        header.byteOrderMark = s_byteOrderMark;
+        header.hostCount = hostTable.size();
+        header.hostTableOffset = originsOffset + originStrings.size();
+
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(hostRecords.data(), static_cast<std::streamsize>(hostRecords.size()));
+        file.write(originStrings.data(), static_cast<std::streamsize>(originStrings.size()));
+        file.write(reinterpret_cast<const char*>(hostTable.data()), static_cast<std::streamsize>(hostTable.size() * sizeof(HostEntry)));
+        file.close();
+
+        if (!file)
+        {
+            throw std::runtime_error("Cannot write the robots.txt store file: " + filePath);
+        }
+    }
+
+private:
+    static std::string hostRecord(const std::vector<Group>& groups)
+    {
+        std::vector<Group> storedGroups;
+
+        std::copy_if(groups.begin(), groups.end(), std::back_inserter(storedGroups), [](const Group& group)
+        {
+            return !group.group->rules.empty();
+        });
+
+        std::string record(sizeof(HostRecordHeader) + storedGroups.size() * sizeof(GroupRecord), '\0');
+        std::vector<GroupRecord> groupRecords;
+
+        for (const Group& group : storedGroups)
+        {
+            const CompiledUserAgentGroup& compiledGroup = *group.group;
+            std::vector<RuleRecord> ruleRecords;
+
+            for (const CompiledRule& rule : compiledGroup.rules)
+            {
+                const RobotsTxtPattern& pattern = rule.pattern;
+                const std::vector<RobotsTxtPattern::Segment>& segments = pattern.segments();
+
+                ruleRecords.push_back(RuleRecord
+                {
+                    append(record, pattern.pattern().data(), pattern.pattern().size()),
+                    static_cast<std::uint32_t>(pattern.pattern().size()),
+                    append(record, segments.data(), segments.size()),
+                    static_cast<std::uint32_t>(segments.size()),
+                    pattern.specificity(),
+                    static_cast<std::uint8_t>(rule.type == RobotsTxtToken::TokenAllow ? 1 : 0),
+                    pattern.flags(),
+                    0
+                });
+            }
+
+            std::vector<std::uint32_t> wildcardRules(compiledGroup.wildcardRules.begin(), compiledGroup.wildcardRules.end());
+            std::vector<RobotsTxtPrefixTree::Node> nodes = compiledGroup.literalRules.nodes();
+            std::string labels;
+
+            // the labels of the tree are the ranges of the whole tokenized content, only the labels of the nodes are stored
+            for (RobotsTxtPrefixTree::Node& node : nodes)
+            {
+                const std::size_t labelOffset = labels.size();
+                labels.append(compiledGroup.literalRules.labels().substr(node.labelOffset, node.labelLength));
+                node.labelOffset = static_cast<std::uint32_t>(labelOffset);
+            }
+
+            GroupRecord groupRecord{};
+            groupRecord.userAgentOffset = append(record, group.userAgent->data(), group.userAgent->size());
+            groupRecord.userAgentLength = static_cast<std::uint32_t>(group.userAgent->size());
+            groupRecord.rulesOffset = append(record, ruleRecords.data(), ruleRecords.size());
+            groupRecord.ruleCount = static_cast<std::uint32_t>(ruleRecords.size());
+            groupRecord.wildcardRulesOffset = append(record, wildcardRules.data(), wildcardRules.size());
+            groupRecord.wildcardRuleCount = static_cast<std::uint32_t>(wildcardRules.size());
+            groupRecord.nodesOffset = append(record, nodes.data(), nodes.size());
+            groupRecord.nodeCount = static_cast<std::uint32_t>(nodes.size());
+            groupRecord.labelsOffset = append(record, labels.data(), labels.size());
+            groupRecord.labelsLength = static_cast<std::uint32_t>(labels.size());
+            groupRecord.prefilterOffset = append(record, &compiledGroup.prefilter, 1);
+
+            groupRecords.push_back(groupRecord);
+        }
+
+        const HostRecordHeader header{ static_cast<std::uint32_t>(groupRecords.size()), 0 };
+        std::memcpy(record.data(), &header, sizeof(header));
+
+        if (!groupRecords.empty())
+        {
+            std::memcpy(record.data() + sizeof(header), groupRecords.data(), groupRecords.size() * sizeof(GroupRecord));
+        }
+
+        return record;
+    }
+
+private:
+    std::unordered_map<std::string, std::string> m_hostRecords;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+class RobotsTxtStore::RobotsTxtStoreImpl final
+{
+public:
+    RobotsTxtStoreImpl()
+        : m_data(nullptr)
+        , m_size(0)
+        , m_header(nullptr)
+        , m_hostTable(nullptr)
+    {
+    }
+
+    void open(const std::string& filePath)
+    {
+        // the lookups touch only a few pages of the huge file
+        MappedFile file(filePath, MappedFile::AccessPattern::Random);
+
+        m_data = file.content().data();
+        m_size = file.content().size();
+
+        try
+        {
+            validate(filePath);
+        }
+        catch (...)
+        {
+            m_data = nullptr;
+            m_size = 0;
+            throw;
+        }
+
+        m_file = std::move(file);
+        m_header = recordAt<FileHeader>(m_data, 0);
+        m_hostTable = recordAt<HostEntry>(m_data, m_header->hostTableOffset);
+    }
+
+    // returns the origin record or nullptr if the origin is not stored
+    const char* find(std::string_view origin) const noexcept
+    {
+        if (!m_header)
+        {
+            return nullptr;
+        }
+
+        const std::uint64_t hash = originHash(origin);
+        const HostEntry* hostTableEnd = m_hostTable + m_header->hostCount;
+
+        const HostEntry* hostEntry = std::lower_bound(m_hostTable, hostTableEnd, hash, [](const HostEntry& entry, std::uint64_t hash)
+        {
+            return entry.originHash < hash;
+        });
+
+        for (; hostEntry != hostTableEnd && hostEntry->originHash == hash; ++hostEntry)
+        {
+            if (std::string_view(m_data + hostEntry->originOffset, hostEntry->originLength) == origin)
+            {
+                return m_data + hostEntry->hostRecordOffset;
+            }
+        }
+
+        return nullptr;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_header ? static_cast<std::size_t>(m_header->hostCount) : 0;
+    }
+
+private:
+    // every offset and length which find() and isPathAllowed() follow is checked against the file size,
+    // so a truncated or corrupted file is rejected here instead of being read out of its bounds later;
+    // the check walks all origin records once, the lookups themselves stay unchecked
+    void validate(const std::string& filePath) const
+    {
+        if (m_size < sizeof(FileHeader))
+        {
+            throw std::runtime_error("The robots.txt store file is truncated: " + filePath);
+        }
+
+        const FileHeader* header = recordAt<FileHeader>(m_data, 0);
+
+        if (!std::equal(std::begin(s_magic), std::end(s_magic), header->magic) || header->byteOrderMark != s_byteOrderMark)
+        {
+            throw std::runtime_error("The file is not a robots.txt store or has the other byte order: " + filePath);
+        }
+
+        if (header->version != s_version)
+        {
+            throw std::runtime_error("Unsupported robots.txt store version: " + filePath);
+        }
+
+        if (!contains<HostEntry>(header->hostTableOffset, header->hostCount))
+        {
+            throw std::runtime_error("The robots.txt store file is truncated: " + filePath);
+        }
+
+        const HostEntry* hostTable = recordAt<HostEntry>(m_data, header->hostTableOffset);
+
+        for (std::uint64_t i = 0; i < header->hostCount; ++i)
+        {
+            if (!contains<char>(hostTable[i].originOffset, hostTable[i].originLength) || !isValidHostRecord(hostTable[i].hostRecordOffset))
+            {
+                throw std::runtime_error("The robots.txt store file is truncated or corrupted: " + filePath);
+            }
+        }
+    }
+
+    bool isValidHostRecord(std::uint64_t recordOffset) const noexcept
+    {
+        if (!contains<HostRecordHeader>(recordOffset, 1) || recordOffset % s_alignment != 0)
+        {
+            return false;
+        }
+
+        const HostRecordHeader* header = recordAt<HostRecordHeader>(m_data, recordOffset);
+
+        if (!contains<GroupRecord>(recordOffset + sizeof(HostRecordHeader), header->groupCount))
+        {
+            return false;
+        }
+
+        const GroupRecord* groups = recordAt<GroupRecord>(m_data, recordOffset + sizeof(HostRecordHeader));
+
+        return std::all_of(groups, groups + header->groupCount, [this, recordOffset](const GroupRecord& group)
+        {
+            return isValidGroupRecord(recordOffset, group);
+        });
+    }
+
+    // the offsets inside the group record are relative to the origin record
+    bool isValidGroupRecord(std::uint64_t recordOffset, const GroupRecord& group) const noexcept
+    {
+        if (!contains<char>(recordOffset + group.userAgentOffset, group.userAgentLength) ||
+            !contains<RuleRecord>(recordOffset + group.rulesOffset, group.ruleCount) ||
+            !contains<std::uint32_t>(recordOffset + group.wildcardRulesOffset, group.wildcardRuleCount) ||
+            !contains<RobotsTxtPrefixTree::Node>(recordOffset + group.nodesOffset, group.nodeCount) ||
+            !contains<char>(recordOffset + group.labelsOffset, group.labelsLength) ||
+            !contains<RobotsTxtPathPrefilter>(recordOffset + group.prefilterOffset, 1) ||
+            group.nodeCount == 0)
+        {
+            return false;
+        }
+
+        const RuleRecord* rules = recordAt<RuleRecord>(m_data, recordOffset + group.rulesOffset);
+        const std::uint32_t* wildcardRules = recordAt<std::uint32_t>(m_data, recordOffset + group.wildcardRulesOffset);
+        const RobotsTxtPrefixTree::Node* nodes = recordAt<RobotsTxtPrefixTree::Node>(m_data, recordOffset + group.nodesOffset);
+
+        for (std::uint32_t i = 0; i < group.ruleCount; ++i)
+        {
+            const RuleRecord& rule = rules[i];
+
+            if (!contains<char>(recordOffset + rule.patternOffset, rule.patternLength) ||
+                !contains<RobotsTxtPattern::Segment>(recordOffset + rule.segmentsOffset, rule.segmentCount))
+            {
+                return false;
+            }
+
+            const RobotsTxtPattern::Segment* segments = recordAt<RobotsTxtPattern::Segment>(m_data, recordOffset + rule.segmentsOffset);
+
+            for (std::uint32_t j = 0; j < rule.segmentCount; ++j)
+            {
+                if (segments[j].offset > rule.patternLength || segments[j].length > rule.patternLength - segments[j].offset)
+                {
+                    return false;
+                }
+            }
+        }
+
+        for (std::uint32_t i = 0; i < group.wildcardRuleCount; ++i)
+        {
+            if (wildcardRules[i] >= group.ruleCount)
+            {
+                return false;
+            }
+        }
+
+        // the walk reads the first label character of every child, the root is never a child
+        for (std::uint32_t i = 0; i < group.nodeCount; ++i)
+        {
+            const RobotsTxtPrefixTree::Node& node = nodes[i];
+
+            if (node.labelOffset > group.labelsLength ||
+                node.labelLength > group.labelsLength - node.labelOffset ||
+                (i != 0 && node.labelLength == 0) ||
+                (node.ruleIndex != RobotsTxtPrefixTree::nodeNoRule && node.ruleIndex >= group.ruleCount) ||
+                (node.childCount != 0 && (node.firstChild == 0 || node.firstChild > group.nodeCount || node.childCount > group.nodeCount - node.firstChild)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // returns true if count values of type T starting at the offset lie inside the file and are aligned
+    template <typename T>
+    bool contains(std::uint64_t offset, std::uint64_t count) const noexcept
+    {
+        return offset % alignof(T) == 0 && offset <= m_size && count <= (m_size - offset) / sizeof(T);
+    }
+
+private:
+    MappedFile m_file;
+    const char* m_data;
+    std::size_t m_size;
+
+    const FileHeader* m_header;
+    const HostEntry* m_hostTable;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+RobotsTxtStoreWriter::RobotsTxtStoreWriter() = default;
+RobotsTxtStoreWriter::~RobotsTxtStoreWriter() = default;
+
+void RobotsTxtStoreWriter::add(std::string_view origin, const RobotsTxtRules& rules)
+{
+    std::vector<RobotsTxtStoreWriterImpl::Group> groups;
+
+    rules.forEachGroup([&groups](const std::string& userAgent, const CompiledUserAgentGroup& group)
+    {
+        groups.push_back(RobotsTxtStoreWriterImpl::Group{ &userAgent, &group });
+    });
+
+    m_impl->add(origin, groups);
+}
+
+std::size_t RobotsTxtStoreWriter::size() const noexcept
+{
+    return m_impl->size();
+}
+
+void RobotsTxtStoreWriter::write(const std::string& filePath) const
+{
+    m_impl->write(filePath);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+RobotsTxtStoredRules::RobotsTxtStoredRules() noexcept
+    : RobotsTxtStoredRules(nullptr)
+{
+}
+
+RobotsTxtStoredRules::RobotsTxtStoredRules(const char* hostRecord) noexcept
+    : m_hostRecord(hostRecord)
+{
+}
+
+RobotsTxtStoredRules::operator bool() const noexcept
+{
+    return m_hostRecord != nullptr;
+}
+
+bool RobotsTxtStoredRules::isUrlAllowed(const std::string& url, WellKnownUserAgent userAgent) const
+{
+    return isUrlAllowed(url, MetaRobotsHelpers::userAgentString(userAgent));
+}
+
+bool RobotsTxtStoredRules::isUrlAllowed(const std::string& url, const std::string& userAgent) const
+{
+    std::string buffer;
+    return isPathAllowed(UrlHelpers::rulesPath(url, buffer), userAgent);
+}
+
+bool RobotsTxtStoredRules::isPathAllowed(std::string_view pathAndQuery, WellKnownUserAgent userAgent) const
+{
+    return isPathAllowed(pathAndQuery, MetaRobotsHelpers::userAgentString(userAgent));
+}
+
+bool RobotsTxtStoredRules::isPathAllowed(std::string_view pathAndQuery, const std::string& userAgent) const noexcept
+{
+    if (!m_hostRecord)
+    {
+        return true;
+    }
+
+    const HostRecordHeader* header = recordAt<HostRecordHeader>(m_hostRecord, 0);
+    const GroupRecord* groups = recordAt<GroupRecord>(m_hostRecord, sizeof(HostRecordHeader));
+    const GroupRecord* rulesGroup = nullptr;
+
+    // the stored names are the lowercased product tokens, the user agent is matched as UserAgentRegistry does
+    const std::string_view productToken = UserAgentRegistry::productToken(userAgent);
+
+    // the own group if it's stored (so it has rules), otherwise the group for all robots
+    for (std::uint32_t i = 0; i < header->groupCount; ++i)
+    {
+        const std::string_view groupUserAgent(m_hostRecord + groups[i].userAgentOffset, groups[i].userAgentLength);
+
+        if (StringHelpers::equalsLowercase(productToken, groupUserAgent))
+        {
+            rulesGroup = &groups[i];
+            break;
+        }
+
+        if (groupUserAgent == "*")
+        {
+            rulesGroup = &groups[i];
+        }
+    }
+
+    if (!rulesGroup)
+    {
+        return true;
+    }
+
+    const std::string_view path = pathAndQuery.empty() ? std::string_view("/") : pathAndQuery;
+
+    if (path == "/robots.txt")
+    {
+        return true;
+    }
+
+    const RobotsTxtPathPrefilter::Verdict verdict = recordAt<RobotsTxtPathPrefilter>(m_hostRecord, rulesGroup->prefilterOffset)->verdict(path);
+
+    if (verdict != RobotsTxtPathPrefilter::VerdictUnknown)
+    {
+        return verdict == RobotsTxtPathPrefilter::VerdictAllowed;
+    }
+
+    const RuleRecord* rules = recordAt<RuleRecord>(m_hostRecord, rulesGroup->rulesOffset);
+    const std::uint32_t* wildcardRules = recordAt<std::uint32_t>(m_hostRecord, rulesGroup->wildcardRulesOffset);
+
+    // the same precedence as RobotsTxtRules applies
+    RobotsTxtPrefixTree::Match bestMatch = RobotsTxtPrefixTree::bestMatch(
+        recordAt<RobotsTxtPrefixTree::Node>(m_hostRecord, rulesGroup->nodesOffset),
+        std::string_view(m_hostRecord + rulesGroup->labelsOffset, rulesGroup->labelsLength),
+        path
+    );
+
+    for (std::uint32_t i = 0; i < rulesGroup->wildcardRuleCount; ++i)
+    {
+        const std::uint32_t ruleIndex = wildcardRules[i];
+        const RuleRecord& rule = rules[ruleIndex];
+
+        if (!RobotsTxtPrefixTree::isBetter(rule.specificity, ruleIndex, bestMatch))
+        {
+            break;
+        }
+
+        const bool matches = RobotsTxtPattern::matches(
+            std::string_view(m_hostRecord + rule.patternOffset, rule.patternLength),
+            recordAt<RobotsTxtPattern::Segment>(m_hostRecord, rule.segmentsOffset),
+            rule.segmentCount,
+            rule.flags,
+            path
+        );
+
+        if (matches)
+        {
+            bestMatch = RobotsTxtPrefixTree::Match{ ruleIndex, rule.specificity };
+            break;
+        }
+    }
+
+    return bestMatch.ruleIndex == RobotsTxtPrefixTree::npos || rules[bestMatch.ruleIndex].allow != 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+RobotsTxtStore::RobotsTxtStore(const std::string& filePath)
+{
+    m_impl->open(filePath);
+}
+
+RobotsTxtStore::RobotsTxtStore(RobotsTxtStore&& other) = default;
+RobotsTxtStore::~RobotsTxtStore() = default;
+RobotsTxtStore& RobotsTxtStore::operator=(RobotsTxtStore&& other) = default;
+
+RobotsTxtStoredRules RobotsTxtStore::find(std::string_view origin) const noexcept
+{
+    return RobotsTxtStoredRules(m_impl->find(origin));
+}
+
+std::size_t RobotsTxtStore::size() const noexcept
+{
+    return m_impl->size();
+}
+
+}
\ No newline at end of file
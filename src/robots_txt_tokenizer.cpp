@@ -3,13 +3,21 @@
 #include "string_helpers.h"
 #include "meta_robots_helpers.h"
 #include "well_known_user_agent.h"
+#include "ascii_kernels.h"
+#include "user_agent_registry.h"
 
 namespace
 {
 
 using namespace cpprobotparser;
 
-const std::map<RobotsTxtToken, std::string> s_tokenToString =
+struct TokenName
+{
+    RobotsTxtToken token;
+    std::string_view name;
+};
+
+const TokenName s_tokenNames[] =
 {
     { RobotsTxtToken::TokenUserAgent, "user-agent" },
     { RobotsTxtToken::TokenAllow, "allow" },
@@ -18,21 +26,29 @@ const std::map<RobotsTxtToken, std::string> s_tokenToString =
     { RobotsTxtToken::TokenHost, "host" },
     { RobotsTxtToken::TokenCrawlDelay, "crawl-delay" },
     { RobotsTxtToken::TokenCleanParam, "clean-param" },
-    { RobotsTxtToken::TokenCommentary, "#" },
-    { RobotsTxtToken::TokenStringDelimeter, ":" }
+    { RobotsTxtToken::TokenRequestRate, "request-rate" },
+    { RobotsTxtToken::TokenVisitTime, "visit-time" }
 };
 
-const std::map<std::string, RobotsTxtToken> s_stringToToken =
+RobotsTxtToken tokenFromString(std::string_view token) noexcept
+{
+    for (const TokenName& tokenName : s_tokenNames)
+    {
+        if (StringHelpers::equalsLowercase(token, tokenName.name))
+        {
+            return tokenName.token;
+        }
+    }
+
+    return RobotsTxtToken::TokenUnknown;
+}
+
+//! One row of the robots.txt split into the directive and its value, both are trimmed views into the content
+struct TokenizedRow
 {
-    { s_tokenToString.at(RobotsTxtToken::TokenUserAgent), RobotsTxtToken::TokenUserAgent },
-    { s_tokenToString.at(RobotsTxtToken::TokenAllow), RobotsTxtToken::TokenAllow },
-    { s_tokenToString.at(RobotsTxtToken::TokenDisallow), RobotsTxtToken::TokenDisallow },
-    { s_tokenToString.at(RobotsTxtToken::TokenSitemap), RobotsTxtToken::TokenSitemap },
-    { s_tokenToString.at(RobotsTxtToken::TokenHost), RobotsTxtToken::TokenHost },
-    { s_tokenToString.at(RobotsTxtToken::TokenCrawlDelay), RobotsTxtToken::TokenCrawlDelay },
-    { s_tokenToString.at(RobotsTxtToken::TokenCleanParam), RobotsTxtToken::TokenCleanParam },
-    { s_tokenToString.at(RobotsTxtToken::TokenCommentary), RobotsTxtToken::TokenCommentary },
-    { s_tokenToString.at(RobotsTxtToken::TokenStringDelimeter), RobotsTxtToken::TokenStringDelimeter }
+    std::string_view token;
+    std::string_view value;
+    bool hasDelimeter;
 };
 
 } // namespace
@@ -44,7 +60,17 @@ class RobotsTxtTokenizer::RobotsTxtTokenizerImpl final
 {
 public:
     RobotsTxtTokenizerImpl()
-        : m_validRobotsTxt(false)
+        : m_maxContentSize(std::numeric_limits<std::size_t>::max())
+        , m_contentSize(0)
+        , m_groupUserAgentNames(1, "*")
+        , m_currentGroup(s_noGroup)
+        , m_groupHasDirectives(true)
+        , m_firstRow(true)
+        , m_feeding(false)
+        , m_invalidFirstRow(false)
+        , m_truncated(false)
+        , m_lastRowCut(false)
+        , m_validRobotsTxt(false)
     {
     }
 
@@ -53,74 +79,119 @@ public:
         return m_validRobotsTxt;
     }
 
-    void tokenize(const std::string& robotsTxtContent)
+    void tokenize(std::string_view robotsTxtContent)
     {
-        StringHelpers::StringList rows = removeCommentaries(
-            StringHelpers::split(robotsTxtContent, std::regex("\\n|\\r\\n|\\n\\r|\\r"), StringHelpers::SkipEmptyParts));
+        m_feeding = false;
+        feed(robotsTxtContent);
+        finish();
+    }
 
-        WellKnownUserAgent userAgentType = WellKnownUserAgent::AllRobots;
+    void feed(std::string_view chunk)
+    {
+        if (!m_feeding)
+        {
+            // the first chunk of the new content, the result of the previous parsing is dropped
+            reset();
+            m_feeding = true;
+        }
 
-        for (int i = 0; i < rows.size(); ++i)
+        if (m_invalidFirstRow || m_truncated)
         {
-            std::pair<std::string, std::string> tokenizedRow = tokenizeRow(rows[i]);
+            return;
+        }
 
-            const std::string token = std::move(tokenizedRow.first);
-            const std::string tokenValue = std::move(tokenizedRow.second);
+        const std::size_t availableSize = m_maxContentSize - m_contentSize;
 
-            const bool isUserAgentToken = token == s_tokenToString.at(RobotsTxtToken::TokenUserAgent);
-            const bool isSitemapToken = token == s_tokenToString.at(RobotsTxtToken::TokenSitemap);
-            const bool isHostToken = token == s_tokenToString.at(RobotsTxtToken::TokenHost);
+        if (chunk.size() > availableSize)
+        {
+            // the row crossing the limit is dropped unless the limit falls right on its delimeter
+            m_lastRowCut = !isRowDelimeter(chunk[availableSize]);
+            m_truncated = true;
+            chunk = chunk.substr(0, availableSize);
+        }
 
-            if (!isUserAgentToken && !isSitemapToken && !isHostToken && i == 0)
-            {
-                // First token must be a user-agent or sitemap or host
-                m_validRobotsTxt = false;
-                return;
-            }
+        m_contentSize += chunk.size();
 
-            if (isUserAgentToken)
-            {
-                userAgentType = MetaRobotsHelpers::userAgent(tokenValue);
-            }
-            else
-            {
-                RobotsTxtToken tokenEnumerator = RobotsTxtToken::TokenUnknown;
-
-                try
-                {
-                    tokenEnumerator = s_stringToToken.at(token);
-                }
-                catch (const std::out_of_range&)
-                {
-                }
-
-                if (tokenEnumerator == RobotsTxtToken::TokenSitemap)
-                {
-                    m_sitemapUrl = tokenValue;
-                    continue;
-                }
-
-                if (userAgentType == WellKnownUserAgent::Unknown)
-                {
-                    continue;
-                }
-
-                Tokens& tokens = m_userAgentTokens[MetaRobotsHelpers::userAgentString(userAgentType)];
-                tokens.insert(std::make_pair(tokenEnumerator, tokenValue));
-            }
+        const std::size_t lastDelimeterPosition = chunk.find_last_of("\r\n");
+
+        if (lastDelimeterPosition == std::string_view::npos)
+        {
+            m_pendingRow.append(chunk.data(), chunk.size());
+            return;
+        }
+
+        std::size_t position = 0;
+
+        if (!m_pendingRow.empty())
+        {
+            // completes the row started in the previous chunks
+            position = chunk.find_first_of("\r\n");
+            m_pendingRow.append(chunk.data(), position);
+
+            tokenizeRows(m_pendingRow);
+            m_pendingRow.clear();
         }
 
-        m_validRobotsTxt = true;
+        tokenizeRows(chunk.substr(position, lastDelimeterPosition + 1 - position));
+
+        const std::string_view rest = chunk.substr(lastDelimeterPosition + 1);
+        m_pendingRow.assign(rest.data(), rest.size());
+    }
+
+    void finish()
+    {
+        if (!m_feeding)
+        {
+            reset();
+        }
+
+        if (!m_invalidFirstRow && !m_lastRowCut)
+        {
+            tokenizeRows(m_pendingRow);
+        }
+
+        m_pendingRow = std::string();
+        m_feeding = false;
+        m_validRobotsTxt = !m_invalidFirstRow;
+    }
+
+    void setMaxContentSize(std::size_t maxContentSize) noexcept
+    {
+        m_maxContentSize = maxContentSize;
+    }
+
+    bool isTruncated() const noexcept
+    {
+        return m_truncated;
     }
 
     bool hasUserAgentRecord(WellKnownUserAgent userAgentType) const
     {
-        return m_userAgentTokens.find(MetaRobotsHelpers::userAgentString(userAgentType)) != m_userAgentTokens.end();
+        return hasUserAgentRecord(MetaRobotsHelpers::userAgentString(userAgentType));
     }
 
     bool hasUserAgentRecord(const std::string& userAgent) const
     {
-        return m_userAgentTokens.find(userAgent) != m_userAgentTokens.end();
+        return userAgentIndex(userAgent) != s_noUserAgent;
+    }
+
+    const UserAgentRegistry& userAgents() const noexcept
+    {
+        return m_userAgents;
+    }
+
+    void forEachDirective(const std::function<void(std::uint32_t, RobotsTxtToken, std::string_view)>& visitor) const
+    {
+        for (std::size_t i = 0; i < m_directiveTokens.size(); ++i)
+        {
+            const std::string_view value = std::string_view(m_values).substr(m_valueOffsets[i], m_valueLengths[i]);
+            const std::uint32_t group = m_directiveGroups[i];
+
+            for (std::uint32_t j = m_groupUserAgentOffsets[group]; j < m_groupUserAgentOffsets[group + 1]; ++j)
+            {
+                visitor(m_groupUserAgents[j], m_directiveTokens[i], value);
+            }
+        }
     }
 
     std::vector<std::string> tokenValues(WellKnownUserAgent userAgentType, RobotsTxtToken token) const
@@ -131,24 +202,53 @@ public:
     std::vector<std::string> tokenValues(const std::string& userAgent, RobotsTxtToken token) const
     {
         std::vector<std::string> result;
+        const std::uint32_t userAgentIndex = this->userAgentIndex(userAgent);
 
-        try
+        if (userAgentIndex == s_noUserAgent)
         {
-            const Tokens& tokens = m_userAgentTokens.at(userAgent);
-            const auto rangePair = tokens.equal_range(token);
-
-            std::for_each(rangePair.first, rangePair.second, [&result](const auto& iter)
-                {
-                    result.push_back(iter.second);
-                });
+            return result;
         }
-        catch (const std::out_of_range&)
+
+        for (std::size_t i = 0; i < m_directiveTokens.size(); ++i)
         {
-        } // do nothing
+            if (m_directiveTokens[i] == token && groupHasUserAgent(m_directiveGroups[i], userAgentIndex))
+            {
+                result.emplace_back(m_values, m_valueOffsets[i], m_valueLengths[i]);
+            }
+        }
 
         return result;
     }
 
+    std::size_t memoryUsage() const noexcept
+    {
+        std::size_t bytes = sizeof(*this) +
+            m_sitemapUrl.capacity() +
+            m_originalHostMirrorUrl.capacity() +
+            m_pendingRow.capacity() +
+            m_values.capacity() +
+            m_groupUserAgentNames.capacity() * sizeof(std::string) +
+            m_userAgents.memoryUsage() - sizeof(m_userAgents) +
+            m_groupUserAgents.capacity() * sizeof(std::uint32_t) +
+            m_groupUserAgentOffsets.capacity() * sizeof(std::uint32_t) +
+            m_directiveGroups.capacity() * sizeof(std::uint32_t) +
+            m_directiveTokens.capacity() * sizeof(RobotsTxtToken) +
+            m_valueOffsets.capacity() * sizeof(std::uint32_t) +
+            m_valueLengths.capacity() * sizeof(std::uint32_t);
+
+        for (const std::string& name : m_groupUserAgentNames)
+        {
+            bytes += name.capacity();
+        }
+
+        return bytes;
+    }
+
+    std::string_view directiveValues() const noexcept
+    {
+        return m_values;
+    }
+
     const std::string& sitemapUrl() const noexcept
     {
         return m_sitemapUrl;
@@ -160,57 +260,254 @@ public:
     }
 
 private:
-    StringHelpers::StringList removeCommentaries(const StringHelpers::StringList& strings) const
+    static bool isRowDelimeter(char ch) noexcept
+    {
+        return ch == '\n' || ch == '\r';
+    }
+
+    void reset()
+    {
+        m_sitemapUrl.clear();
+        m_originalHostMirrorUrl.clear();
+        m_userAgents.clear();
+        m_groupUserAgents.clear();
+        m_groupUserAgentOffsets.assign(1, 0);
+        m_directiveGroups.clear();
+        m_directiveTokens.clear();
+        m_valueOffsets.clear();
+        m_valueLengths.clear();
+        m_values.clear();
+        m_pendingRow.clear();
+        m_contentSize = 0;
+        m_groupUserAgentNames.assign(1, "*");
+        m_currentGroup = s_noGroup;
+        m_groupHasDirectives = true;
+        m_firstRow = true;
+        m_feeding = false;
+        m_invalidFirstRow = false;
+        m_truncated = false;
+        m_lastRowCut = false;
+        m_validRobotsTxt = false;
+    }
+
+    std::uint32_t userAgentIndex(const std::string& userAgent) const noexcept
+    {
+        return m_userAgents.find(userAgent);
+    }
+
+    bool groupHasUserAgent(std::uint32_t group, std::uint32_t userAgentIndex) const noexcept
+    {
+        const auto first = m_groupUserAgents.begin() + m_groupUserAgentOffsets[group];
+        const auto last = m_groupUserAgents.begin() + m_groupUserAgentOffsets[group + 1];
+
+        return std::find(first, last, userAgentIndex) != last;
+    }
+
+    // the well known user agents get their usual names (e.g. "robots" becomes "*"), the rest keep the lowercased product token
+    // the empty name is returned if the value has no product token
+    static std::string userAgentName(std::string_view userAgentValue)
     {
-        StringHelpers::StringList resultStrings;
+        const std::string_view productToken = UserAgentRegistry::productToken(userAgentValue);
+        const WellKnownUserAgent userAgentType = MetaRobotsHelpers::userAgent(productToken);
 
-        for (const std::string& string : strings)
+        return userAgentType == WellKnownUserAgent::Unknown ?
+            StringHelpers::asciiLowercased(productToken) :
+            MetaRobotsHelpers::userAgentString(userAgentType);
+    }
+
+    // the User-agent row either starts the new group or adds one more user agent to the group of the previous rows
+    void addGroupUserAgent(std::string_view userAgentValue)
+    {
+        if (m_groupHasDirectives)
+        {
+            m_groupUserAgentNames.clear();
+            m_currentGroup = s_noGroup;
+            m_groupHasDirectives = false;
+        }
+
+        std::string name = userAgentName(userAgentValue);
+
+        if (!name.empty() && std::find(m_groupUserAgentNames.begin(), m_groupUserAgentNames.end(), name) == m_groupUserAgentNames.end())
+        {
+            m_groupUserAgentNames.push_back(std::move(name));
+        }
+    }
+
+    // the lowercased value is appended to the arena and described by one row of the directive table,
+    // the directive belongs to every user agent of the current group (RFC 9309 2.1)
+    void addDirective(RobotsTxtToken token, std::string_view value)
+    {
+        m_groupHasDirectives = true;
+
+        if (m_groupUserAgentNames.empty())
         {
-            const std::string validatedString = StringHelpers::removeAllFrom(string, "#");
+            // the group has no user agent with the product token
+            return;
+        }
 
-            if (validatedString.empty())
+        if (m_currentGroup == s_noGroup)
+        {
+            // the user agents get their ids only if they have directives
+            for (const std::string& name : m_groupUserAgentNames)
             {
-                continue;
+                m_groupUserAgents.push_back(m_userAgents.intern(name));
             }
 
-            resultStrings.push_back(validatedString);
+            m_currentGroup = static_cast<std::uint32_t>(m_groupUserAgentOffsets.size() - 1);
+            m_groupUserAgentOffsets.push_back(static_cast<std::uint32_t>(m_groupUserAgents.size()));
         }
 
-        return resultStrings;
+        const std::size_t offset = m_values.size();
+
+        m_values.append(value.data(), value.size());
+        AsciiKernels::toLower(m_values.data() + offset, value.size());
+
+        m_directiveGroups.push_back(m_currentGroup);
+        m_directiveTokens.push_back(token);
+        m_valueOffsets.push_back(static_cast<std::uint32_t>(offset));
+        m_valueLengths.push_back(static_cast<std::uint32_t>(value.size()));
     }
 
-    std::pair<std::string, std::string> tokenizeRow(const std::string& row) const
+    // tokenizes the complete rows, the state of the current group is kept between calls
+    void tokenizeRows(std::string_view rows)
     {
-        const size_t tokenPartStringDelimeterPosition =
-            row.find(s_tokenToString.at(RobotsTxtToken::TokenStringDelimeter));
+        std::size_t position = 0;
 
-        if (tokenPartStringDelimeterPosition == std::string::npos)
+        while (position < rows.size())
         {
-            // invalid row
-            return std::make_pair(std::string(), std::string());
+            const TokenizedRow row = nextRow(rows, position);
+
+            if (row.token.empty() && !row.hasDelimeter)
+            {
+                // empty or commentary only row
+                continue;
+            }
+
+            const RobotsTxtToken token = tokenFromString(row.token);
+
+            if (m_firstRow &&
+                token != RobotsTxtToken::TokenUserAgent &&
+                token != RobotsTxtToken::TokenSitemap &&
+                token != RobotsTxtToken::TokenHost)
+            {
+                // First token must be a user-agent or sitemap or host
+                m_invalidFirstRow = true;
+                return;
+            }
+
+            m_firstRow = false;
+
+            if (!row.hasDelimeter)
+            {
+                // invalid row
+                continue;
+            }
+
+            if (token == RobotsTxtToken::TokenUserAgent)
+            {
+                addGroupUserAgent(row.value);
+                continue;
+            }
+
+            if (token == RobotsTxtToken::TokenSitemap)
+            {
+                m_sitemapUrl = StringHelpers::asciiLowercased(row.value);
+                continue;
+            }
+
+            addDirective(token, row.value);
         }
+    }
 
-        const std::string token = StringHelpers::trimmed(
-            StringHelpers::toLower(row.substr(0, tokenPartStringDelimeterPosition)));
+    // scans the row starting at the passed position and moves the position to the beginning of the next row
+    // CR, LF and any their combination are treated as row delimeters, empty rows between them are skipped by the caller
+    static TokenizedRow nextRow(std::string_view content, std::size_t& position) noexcept
+    {
+        const std::size_t rowBegin = position;
+        std::size_t delimeterPosition = std::string_view::npos;
+        std::size_t commentaryPosition = std::string_view::npos;
 
-        const std::string tokenValue = StringHelpers::trimmed(
-            StringHelpers::toLower(row.substr(tokenPartStringDelimeterPosition + 1, row.size())));
+        for (; position < content.size(); ++position)
+        {
+            const char ch = content[position];
+
+            if (ch == '\n' || ch == '\r')
+            {
+                break;
+            }
+
+            if (ch == '#' && commentaryPosition == std::string_view::npos)
+            {
+                commentaryPosition = position;
+            }
+            else if (ch == ':' && delimeterPosition == std::string_view::npos && commentaryPosition == std::string_view::npos)
+            {
+                delimeterPosition = position;
+            }
+        }
+
+        const std::size_t rowEnd = commentaryPosition == std::string_view::npos ? position : commentaryPosition;
 
-        return std::make_pair(token, tokenValue);
+        // skip the row delimeter
+        ++position;
+
+        if (delimeterPosition == std::string_view::npos)
+        {
+            return TokenizedRow{ StringHelpers::trimmedView(content.substr(rowBegin, rowEnd - rowBegin)), std::string_view(), false };
+        }
+
+        return TokenizedRow
+        {
+            StringHelpers::trimmedView(content.substr(rowBegin, delimeterPosition - rowBegin)),
+            StringHelpers::trimmedView(content.substr(delimeterPosition + 1, rowEnd - delimeterPosition - 1)),
+            true
+        };
     }
 
 private:
-    using Tokens = std::multimap<RobotsTxtToken, std::string>;
+    static constexpr std::uint32_t s_noUserAgent = UserAgentRegistry::npos;
+    static constexpr std::uint32_t s_noGroup = static_cast<std::uint32_t>(-1);
 
     std::string m_sitemapUrl;
     std::string m_originalHostMirrorUrl;
-    std::map<std::string, Tokens> m_userAgentTokens;
+
+    // the user agents which have directives in the order of their first record, the ids are used in the directive table
+    UserAgentRegistry m_userAgents;
+
+    // the user agent ids of every group with directives are m_groupUserAgents[m_groupUserAgentOffsets[group], m_groupUserAgentOffsets[group + 1])
+    std::vector<std::uint32_t> m_groupUserAgents;
+    std::vector<std::uint32_t> m_groupUserAgentOffsets = std::vector<std::uint32_t>(1, 0);
+
+    // the directive table in the order of appearance, one column per field:
+    // the group index, the token and the range of the lowercased value in m_values
+    std::vector<std::uint32_t> m_directiveGroups;
+    std::vector<RobotsTxtToken> m_directiveTokens;
+    std::vector<std::uint32_t> m_valueOffsets;
+    std::vector<std::uint32_t> m_valueLengths;
+    std::string m_values;
+
+    // the incremental parsing state
+    std::string m_pendingRow;
+    std::size_t m_maxContentSize;
+    std::size_t m_contentSize;
+    // the names of the user agents of the current group (see userAgentName), the rows before the first User-agent belong to "*"
+    std::vector<std::string> m_groupUserAgentNames;
+    // the index of the current group once it has directives
+    std::uint32_t m_currentGroup;
+    // the next User-agent row starts the new group
+    bool m_groupHasDirectives;
+    bool m_firstRow;
+    bool m_feeding;
+    bool m_invalidFirstRow;
+    bool m_truncated;
+    bool m_lastRowCut;
+
     bool m_validRobotsTxt;
 };
 
 //////////////////////////////////////////////////////////////////////////
 
-RobotsTxtTokenizer::RobotsTxtTokenizer(const std::string& robotsTxtContent)
+RobotsTxtTokenizer::RobotsTxtTokenizer(std::string_view robotsTxtContent)
     : RobotsTxtTokenizer()
 {
     tokenize(robotsTxtContent);
@@ -228,11 +525,31 @@ bool RobotsTxtTokenizer::isValid() const noexcept
     return m_impl->isValid();
 }
 
-void RobotsTxtTokenizer::tokenize(const std::string& robotsTxtContent)
+void RobotsTxtTokenizer::tokenize(std::string_view robotsTxtContent)
 {
     m_impl->tokenize(robotsTxtContent);
 }
 
+void RobotsTxtTokenizer::feed(std::string_view chunk)
+{
+    m_impl->feed(chunk);
+}
+
+void RobotsTxtTokenizer::finish()
+{
+    m_impl->finish();
+}
+
+void RobotsTxtTokenizer::setMaxContentSize(std::size_t maxContentSize) noexcept
+{
+    m_impl->setMaxContentSize(maxContentSize);
+}
+
+bool RobotsTxtTokenizer::isTruncated() const noexcept
+{
+    return m_impl->isTruncated();
+}
+
 std::vector<std::string> RobotsTxtTokenizer::tokenValues(WellKnownUserAgent userAgentType, RobotsTxtToken token) const
 {
     return m_impl->tokenValues(userAgentType, token);
@@ -253,6 +570,26 @@ const std::string& RobotsTxtTokenizer::originalHostMirrorUrl() const noexcept
     return m_impl->originalHostMirrorUrl();
 }
 
+const UserAgentRegistry& RobotsTxtTokenizer::userAgents() const noexcept
+{
+    return m_impl->userAgents();
+}
+
+void RobotsTxtTokenizer::forEachDirective(const std::function<void(std::uint32_t, RobotsTxtToken, std::string_view)>& visitor) const
+{
+    m_impl->forEachDirective(visitor);
+}
+
+std::string_view RobotsTxtTokenizer::directiveValues() const noexcept
+{
+    return m_impl->directiveValues();
+}
+
+std::size_t RobotsTxtTokenizer::memoryUsage() const noexcept
+{
+    return m_impl->memoryUsage();
+}
+
 bool RobotsTxtTokenizer::hasUserAgentRecord(WellKnownUserAgent userAgentType) const
 {
     return m_impl->hasUserAgentRecord(userAgentType);
@@ -263,4 +600,4 @@ bool RobotsTxtTokenizer::hasUserAgentRecord(const std::string& userAgent) const
     return m_impl->hasUserAgentRecord(userAgent);
 }
 
-}
+}
\ No newline at end of file
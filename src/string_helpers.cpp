@@ -1,32 +1,20 @@
 ﻿#include "string_helpers.h"
-
-namespace
-{
-
-auto toLowerLambdaHelper()
-{
-    return [](char ch)
-    {
-        return static_cast<char>(std::tolower(ch));
-    };
-}
-
-}
+#include "ascii_kernels.h"
 
 namespace cpprobotparser
 {
 
 void StringHelpers::toLower(std::string& source)
 {
-    std::transform(source.begin(), source.end(), source.begin(), toLowerLambdaHelper());
+    AsciiKernels::toLower(source.data(), source.size());
 }
 
 std::string StringHelpers::toLower(const std::string& source)
 {
-    std::string result;
-    std::transform(source.begin(), source.end(), std::inserter(result, result.end()), toLowerLambdaHelper());
+    std::string result(source);
+    toLower(result);
 
-    return std::move(result);
+    return result;
 }
 
 std::string StringHelpers::removeAllFrom(const std::string& source, const std::string& substring)
@@ -214,4 +202,70 @@ bool StringHelpers::endsWithHelper(const std::string& source, const std::string&
     return source.rfind(substring) == source.size() - substring.size();
 }
 
+char StringHelpers::asciiToLower(char ch) noexcept
+{
+    return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+bool StringHelpers::startsWithLowercase(std::string_view source, std::string_view lowercaseSubstring) noexcept
+{
+    return lowercaseSubstring.size() <= source.size() &&
+        AsciiKernels::equalsLowercase(source.data(), lowercaseSubstring.data(), lowercaseSubstring.size());
+}
+
+bool StringHelpers::endsWithLowercase(std::string_view source, std::string_view lowercaseSubstring) noexcept
+{
+    if (lowercaseSubstring.size() > source.size())
+    {
+        return false;
+    }
+
+    return startsWithLowercase(source.substr(source.size() - lowercaseSubstring.size()), lowercaseSubstring);
+}
+
+std::size_t StringHelpers::findLowercase(std::string_view source, std::string_view lowercaseSubstring, std::size_t from) noexcept
+{
+    if (from > source.size())
+    {
+        return std::string_view::npos;
+    }
+
+    const std::size_t position = AsciiKernels::findLowercase(source.substr(from), lowercaseSubstring);
+
+    return position == std::string_view::npos ? position : from + position;
+}
+
+bool StringHelpers::equalsLowercase(std::string_view source, std::string_view lowercaseString) noexcept
+{
+    return source.size() == lowercaseString.size() && startsWithLowercase(source, lowercaseString);
+}
+
+std::string StringHelpers::asciiLowercased(std::string_view source)
+{
+    std::string result(source);
+    AsciiKernels::toLower(result.data(), result.size());
+
+    return result;
+}
+
+std::string_view StringHelpers::trimmedView(std::string_view source) noexcept
+{
+    const auto isSpace = [](char ch)
+    {
+        return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+    };
+
+    while (!source.empty() && isSpace(source.front()))
+    {
+        source.remove_prefix(1);
+    }
+
+    while (!source.empty() && isSpace(source.back()))
+    {
+        source.remove_suffix(1);
+    }
+
+    return source;
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+﻿#include "url_helpers.h"
+#include "string_helpers.h"
+
+namespace cpprobotparser
+{
+
+std::string_view UrlHelpers::pathAndQuery(std::string_view url) noexcept
+{
+    url = url.substr(0, url.find('#'));
+
+    const std::size_t schemeEnd = url.find("://");
+
+    // the URL without the scheme starts with the authority as for origin, e.g. "example.com/a", unless it's the path itself
+    std::size_t authorityBegin = 0;
+
+    if (schemeEnd != std::string_view::npos && url.find_first_of("/?") > schemeEnd)
+    {
+        authorityBegin = schemeEnd + 3;
+    }
+    else if (url.substr(0, 2) == "//")
+    {
+        authorityBegin = 2;
+    }
+    else if (url.empty() || url.front() == '/' || url.front() == '?')
+    {
+        return url;
+    }
+
+    const std::size_t authorityEnd = url.find_first_of("/?", authorityBegin);
+
+    return authorityEnd == std::string_view::npos ? std::string_view() : url.substr(authorityEnd);
+}
+
+std::string_view UrlHelpers::rulesPath(std::string_view url, std::string& buffer)
+{
+    const std::string_view path = pathAndQuery(url);
+
+    if (path.empty() || path.front() != '?')
+    {
+        return path;
+    }
+
+    buffer.assign(1, '/');
+    buffer.append(path);
+
+    return buffer;
+}
+
+std::string UrlHelpers::origin(std::string_view url)
+{
+    std::string_view scheme = "http";
+    const std::size_t schemeEnd = url.find("://");
+
+    if (schemeEnd != std::string_view::npos && url.find_first_of("/?#") > schemeEnd)
+    {
+        scheme = url.substr(0, schemeEnd);
+        url.remove_prefix(schemeEnd + 3);
+    }
+    else if (url.substr(0, 2) == "//")
+    {
+        url.remove_prefix(2);
+    }
+
+    std::string_view authority = url.substr(0, url.find_first_of("/?#"));
+    const std::size_t userInfoEnd = authority.rfind('@');
+
+    if (userInfoEnd != std::string_view::npos)
+    {
+        authority.remove_prefix(userInfoEnd + 1);
+    }
+
+    // the closing bracket of an IPv6 address goes before the port
+    const std::size_t portDelimeter = authority.rfind(':');
+    const bool hasPort = portDelimeter != std::string_view::npos && authority.find(']', portDelimeter) == std::string_view::npos;
+
+    const std::string_view host = hasPort ? authority.substr(0, portDelimeter) : authority;
+    std::string_view port = hasPort ? authority.substr(portDelimeter + 1) : std::string_view();
+
+    std::string result = StringHelpers::asciiLowercased(scheme);
+
+    if (port.empty())
+    {
+        port = result == "https" ? "443" : result == "http" ? "80" : "";
+    }
+
+    result += "://";
+    result += StringHelpers::asciiLowercased(host);
+
+    if (!port.empty())
+    {
+        result += ':';
+        result.append(port.data(), port.size());
+    }
+
+    return result;
+}
+
+}
\ No newline at end of file
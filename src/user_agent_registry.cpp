@@ -0,0 +1,242 @@
+﻿#include "user_agent_registry.h"
+#include "string_helpers.h"
+
+namespace
+{
+
+// the characters of the product tokens, e.g. "mail.ru" or "googlebot-image"
+bool isProductTokenChar(char ch) noexcept
+{
+    return (ch >= 'a' && ch <= 'z') ||
+        (ch >= 'A' && ch <= 'Z') ||
+        (ch >= '0' && ch <= '9') ||
+        ch == '-' || ch == '_' || ch == '.';
+}
+
+}
+
+namespace cpprobotparser
+{
+
+class UserAgentRegistry::UserAgentRegistryImpl final
+{
+public:
+    std::uint32_t intern(std::string_view productToken)
+    {
+        if ((m_names.size() + 1) * 2 > m_slots.size())
+        {
+            rehash(m_slots.size() * 2);
+        }
+
+        const std::size_t slot = findSlot(productToken);
+
+        if (m_slots[slot] == npos)
+        {
+            m_slots[slot] = static_cast<std::uint32_t>(m_names.size());
+            m_names.push_back(StringHelpers::asciiLowercased(productToken));
+        }
+
+        return m_slots[slot];
+    }
+
+    std::uint32_t find(std::string_view productToken) const noexcept
+    {
+        return m_slots[findSlot(productToken)];
+    }
+
+    std::uint32_t match(std::string_view userAgentHeader) const noexcept
+    {
+        std::uint32_t bestId = npos;
+        std::size_t bestLength = 0;
+        std::size_t position = 0;
+
+        while (position < userAgentHeader.size())
+        {
+            if (!isProductTokenChar(userAgentHeader[position]))
+            {
+                ++position;
+                continue;
+            }
+
+            const std::size_t tokenBegin = position;
+
+            while (position < userAgentHeader.size() && isProductTokenChar(userAgentHeader[position]))
+            {
+                ++position;
+            }
+
+            if (tokenBegin > 0 && userAgentHeader[tokenBegin - 1] == '/')
+            {
+                // the version of the product, e.g. "5.0" in "Mozilla/5.0"
+                continue;
+            }
+
+            std::string_view token = userAgentHeader.substr(tokenBegin, position - tokenBegin);
+
+            while (token.size() > bestLength)
+            {
+                const std::uint32_t id = find(token);
+
+                if (id != npos)
+                {
+                    bestId = id;
+                    bestLength = token.size();
+                    break;
+                }
+
+                const std::size_t dashPosition = token.rfind('-');
+
+                if (dashPosition == std::string_view::npos || dashPosition == 0)
+                {
+                    break;
+                }
+
+                token = token.substr(0, dashPosition);
+            }
+        }
+
+        return bestId;
+    }
+
+    const std::string& name(std::uint32_t id) const
+    {
+        return m_names.at(id);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_names.size();
+    }
+
+    void clear() noexcept
+    {
+        m_names.clear();
+        std::fill(m_slots.begin(), m_slots.end(), npos);
+    }
+
+    std::size_t memoryUsage() const noexcept
+    {
+        std::size_t bytes = sizeof(*this) +
+            m_names.capacity() * sizeof(std::string) +
+            m_slots.capacity() * sizeof(std::uint32_t);
+
+        for (const std::string& name : m_names)
+        {
+            bytes += name.capacity();
+        }
+
+        return bytes;
+    }
+
+private:
+    // FNV-1a of the lowercased token
+    static std::size_t hash(std::string_view productToken) noexcept
+    {
+        std::uint32_t result = 2166136261u;
+
+        for (const char ch : productToken)
+        {
+            result = (result ^ static_cast<unsigned char>(StringHelpers::asciiToLower(ch))) * 16777619u;
+        }
+
+        return result;
+    }
+
+    // returns the slot of the token or the empty slot where it should be placed
+    std::size_t findSlot(std::string_view productToken) const noexcept
+    {
+        const std::size_t mask = m_slots.size() - 1;
+        std::size_t slot = hash(productToken) & mask;
+
+        while (m_slots[slot] != npos && !StringHelpers::equalsLowercase(productToken, m_names[m_slots[slot]]))
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        return slot;
+    }
+
+    void rehash(std::size_t slotCount)
+    {
+        m_slots.assign(slotCount, npos);
+
+        for (std::uint32_t id = 0; id < m_names.size(); ++id)
+        {
+            m_slots[findSlot(m_names[id])] = id;
+        }
+    }
+
+private:
+    static constexpr std::size_t s_initialSlotCount = 16;
+
+    // the lowercased tokens by id
+    std::vector<std::string> m_names;
+
+    // the open addressing table of the ids, the power of two size, at most half full
+    std::vector<std::uint32_t> m_slots = std::vector<std::uint32_t>(s_initialSlotCount, npos);
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+UserAgentRegistry::UserAgentRegistry() = default;
+UserAgentRegistry::UserAgentRegistry(const UserAgentRegistry& other) = default;
+UserAgentRegistry::UserAgentRegistry(UserAgentRegistry&& other) = default;
+UserAgentRegistry::~UserAgentRegistry() = default;
+UserAgentRegistry& UserAgentRegistry::operator=(const UserAgentRegistry& other) = default;
+UserAgentRegistry& UserAgentRegistry::operator=(UserAgentRegistry&& other) = default;
+
+std::uint32_t UserAgentRegistry::intern(std::string_view productToken)
+{
+    return m_impl->intern(productToken);
+}
+
+std::uint32_t UserAgentRegistry::find(std::string_view productToken) const noexcept
+{
+    return m_impl->find(productToken);
+}
+
+std::uint32_t UserAgentRegistry::match(std::string_view userAgentHeader) const noexcept
+{
+    return m_impl->match(userAgentHeader);
+}
+
+const std::string& UserAgentRegistry::name(std::uint32_t id) const
+{
+    return m_impl->name(id);
+}
+
+std::size_t UserAgentRegistry::size() const noexcept
+{
+    return m_impl->size();
+}
+
+void UserAgentRegistry::clear() noexcept
+{
+    m_impl->clear();
+}
+
+std::size_t UserAgentRegistry::memoryUsage() const noexcept
+{
+    return sizeof(*this) + m_impl->memoryUsage();
+}
+
+std::string_view UserAgentRegistry::productToken(std::string_view userAgentValue) noexcept
+{
+    const std::string_view value = StringHelpers::trimmedView(userAgentValue);
+
+    if (!value.empty() && value.front() == '*')
+    {
+        return value.substr(0, 1);
+    }
+
+    std::size_t length = 0;
+
+    while (length < value.size() && isProductTokenChar(value[length]))
+    {
+        ++length;
+    }
+
+    return value.substr(0, length);
+}
+
+}
\ No newline at end of file
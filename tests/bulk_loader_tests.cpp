@@ -0,0 +1,256 @@
+﻿#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "robots_txt_bulk_loader.h"
+#include "robots_txt_cache.h"
+#include "robots_txt_rules.h"
+#include "temporary_path.h"
+#include "url_helpers.h"
+#include "well_known_user_agent.h"
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+std::string warcRecord(const std::string& type, const std::string& targetUri, const std::string& block)
+{
+    return
+        "WARC/1.0\r\n"
+        "WARC-Type: " + type + "\r\n"
+        "WARC-Target-URI: " + targetUri + "\r\n"
+        "Content-Length: " + std::to_string(block.size()) + "\r\n"
+        "\r\n" +
+        block +
+        "\r\n\r\n";
+}
+
+std::string httpResponse(const std::string& statusLine, const std::string& body)
+{
+    return statusLine + "\r\nContent-Type: text/plain\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+//! collects the rules passed by the parsing threads
+struct CollectedRules
+{
+    std::mutex mutex;
+    std::map<std::string, RobotsTxtRulesSnapshot> rules;
+    std::vector<std::uint64_t> recordNumbers;
+
+    RobotsTxtBulkLoader::Consumer consumer()
+    {
+        return [this](const std::string& key, RobotsTxtRulesSnapshot snapshot, std::uint64_t recordNumber)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            rules[key] = std::move(snapshot);
+            recordNumbers.push_back(recordNumber);
+        };
+    }
+};
+
+}
+
+TEST(BulkLoaderTests, ArchiveRecords)
+{
+    TemporaryPath archive("bulk_loader_archive.warc");
+
+    writeFile(archive.path(),
+        warcRecord("warcinfo", "", "software: test\r\n") +
+        warcRecord("request", "http://example.com/robots.txt", "GET /robots.txt HTTP/1.1\r\nHost: example.com\r\n\r\n") +
+        warcRecord("response", "http://example.com/robots.txt", httpResponse("HTTP/1.1 200 OK", "User-agent: *\r\nDisallow: /private\r\n")) +
+        warcRecord("response", "https://Missing.com:8443/robots.txt", httpResponse("HTTP/1.1 404 Not Found", "User-agent: *\nDisallow: /\n")) +
+        warcRecord("response", "http://unavailable.com/robots.txt", httpResponse("HTTP/1.1 503 Service Unavailable", "")) +
+        "garbage between the records\r\n" +
+        warcRecord("resource", "<http://resource.com/robots.txt>", "User-agent: Googlebot\nDisallow: /\n")
+    );
+
+    RobotsTxtBulkLoader::Settings settings;
+    settings.threadCount = 4;
+    settings.maxPendingRecords = 1;
+
+    CollectedRules collected;
+    const RobotsTxtBulkLoader::Statistics statistics = RobotsTxtBulkLoader(settings).load(archive.path().string(), collected.consumer());
+
+    EXPECT_EQ(statistics.records, 3);
+    EXPECT_EQ(statistics.skippedRecords, 2);
+    ASSERT_EQ(collected.rules.size(), 3);
+
+    const RobotsTxtRules& example = *collected.rules.at("http://example.com:80");
+    EXPECT_EQ(example.isUrlAllowed("http://example.com/private/1", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(example.isUrlAllowed("http://example.com/public", WellKnownUserAgent::GoogleBot), true);
+
+    // the body of 404 response is not parsed
+    const RobotsTxtRules& missing = *collected.rules.at("https://missing.com:8443");
+    EXPECT_EQ(missing.isUrlAllowed("https://missing.com:8443/page", WellKnownUserAgent::GoogleBot), true);
+
+    const RobotsTxtRules& resource = *collected.rules.at("http://resource.com:80");
+    EXPECT_EQ(resource.isUrlAllowed("http://resource.com/page", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(resource.isUrlAllowed("http://resource.com/page", WellKnownUserAgent::YandexBot), true);
+}
+
+TEST(BulkLoaderTests, RecrawledRecords)
+{
+    TemporaryPath archive("bulk_loader_recrawls.warc");
+
+    // every crawl disallows its own directory, the batches of the crawls are parsed by the threads in any order
+    constexpr int recordCount = 1000;
+    std::string content;
+
+    for (int i = 0; i < recordCount; ++i)
+    {
+        content += warcRecord("resource", "http://example.com/robots.txt", "User-agent: *\nDisallow: /" + std::to_string(i) + "/\n");
+    }
+
+    writeFile(archive.path(), content);
+
+    RobotsTxtBulkLoader::Settings settings;
+    settings.threadCount = 4;
+    settings.maxPendingRecords = 256;
+
+    const RobotsTxtBulkLoader loader(settings);
+
+    CollectedRules collected;
+    loader.load(archive.path().string(), collected.consumer());
+
+    // every record has its own number in the order of the archive
+    std::sort(collected.recordNumbers.begin(), collected.recordNumbers.end());
+    ASSERT_EQ(collected.recordNumbers.size(), recordCount);
+
+    for (int i = 0; i < recordCount; ++i)
+    {
+        EXPECT_EQ(collected.recordNumbers[i], i);
+    }
+
+    // the cache gets the latest crawl whichever thread parses it last
+    RobotsTxtCache cache;
+    loader.load(archive.path().string(), cache, std::chrono::hours(1));
+
+    const RobotsTxtRulesSnapshot rules = cache.find("http://example.com:80");
+    ASSERT_NE(rules, nullptr);
+    EXPECT_EQ(rules->isUrlAllowed("http://example.com/" + std::to_string(recordCount - 1) + "/", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules->isUrlAllowed("http://example.com/" + std::to_string(recordCount - 2) + "/", WellKnownUserAgent::GoogleBot), true);
+}
+
+TEST(BulkLoaderTests, DirectoryFiles)
+{
+    TemporaryPath directory("bulk_loader_directory");
+    std::filesystem::create_directories(directory.path() / "shard");
+
+    constexpr int fileCount = 300;
+
+    for (int i = 0; i < fileCount; ++i)
+    {
+        const std::filesystem::path path = i % 2 == 0 ? directory.path() : directory.path() / "shard";
+        writeFile(path / ("Host" + std::to_string(i) + ".com.txt"), "User-agent: *\nDisallow: /" + std::to_string(i) + "/\n");
+    }
+
+    RobotsTxtBulkLoader::Settings settings;
+    settings.threadCount = 3;
+    settings.maxPendingRecords = 100;
+
+    const RobotsTxtBulkLoader loader(settings);
+
+    CollectedRules collected;
+    const RobotsTxtBulkLoader::Statistics statistics = loader.load(directory.path().string(), collected.consumer());
+
+    EXPECT_EQ(statistics.records, fileCount);
+    EXPECT_EQ(statistics.skippedRecords, 0);
+    EXPECT_EQ(statistics.failedFiles, 0);
+    ASSERT_EQ(collected.rules.size(), fileCount);
+
+    for (int i = 0; i < fileCount; ++i)
+    {
+        // the file names are the hosts, the keys are their origins as for the archive records
+        const std::string host = "host" + std::to_string(i) + ".com";
+        const RobotsTxtRules& rules = *collected.rules.at("http://" + host + ":80");
+
+        EXPECT_EQ(rules.isUrlAllowed("http://" + host + "/" + std::to_string(i) + "/page", WellKnownUserAgent::GoogleBot), false) << host;
+        EXPECT_EQ(rules.isUrlAllowed("http://" + host + "/" + std::to_string(i + 1) + "/page", WellKnownUserAgent::GoogleBot), true) << host;
+    }
+
+    RobotsTxtCache cache;
+    loader.load(directory.path().string(), cache, std::chrono::hours(1));
+
+    EXPECT_EQ(cache.size(), fileCount);
+    ASSERT_NE(cache.find(UrlHelpers::origin("http://host7.com/7/")), nullptr);
+    EXPECT_EQ(cache.find(UrlHelpers::origin("http://Host7.com/7/"))->isUrlAllowed("http://host7.com/7/", WellKnownUserAgent::GoogleBot), false);
+}
+
+TEST(BulkLoaderTests, Failures)
+{
+    const RobotsTxtBulkLoader loader;
+
+    EXPECT_THROW(loader.load("no_such_bulk_loader_input.warc", [](const std::string&, RobotsTxtRulesSnapshot, std::uint64_t) {}), std::runtime_error);
+
+    TemporaryPath directory("bulk_loader_failures");
+    std::filesystem::create_directories(directory.path());
+
+    for (int i = 0; i < 500; ++i)
+    {
+        writeFile(directory.path() / ("host" + std::to_string(i) + ".com.txt"), "User-agent: *\nDisallow: /\n");
+    }
+
+    RobotsTxtBulkLoader::Settings settings;
+    settings.threadCount = 2;
+    settings.maxPendingRecords = 64;
+
+    // the exception of the consumer stops the loading
+    EXPECT_THROW(RobotsTxtBulkLoader(settings).load(directory.path().string(), [](const std::string& key, RobotsTxtRulesSnapshot, std::uint64_t)
+    {
+        if (key == "http://host42.com:80")
+        {
+            throw std::logic_error("consumer failure");
+        }
+    }), std::logic_error);
+}
+
+TEST(BulkLoaderTests, UnreadableFiles)
+{
+    TemporaryPath directory("bulk_loader_unreadable");
+    std::filesystem::create_directories(directory.path());
+
+    constexpr int fileCount = 10;
+
+    for (int i = 0; i < fileCount; ++i)
+    {
+        writeFile(directory.path() / ("host" + std::to_string(i) + ".com.txt"), "User-agent: *\nDisallow: /\n");
+    }
+
+    RobotsTxtBulkLoader::Settings settings;
+    settings.threadCount = 1;
+
+    // the files are listed before the parsing starts, the first parsed file removes the rest of them,
+    // so they can't be read anymore and the loading goes on without them
+    std::vector<std::string> keys;
+
+    const RobotsTxtBulkLoader::Statistics statistics = RobotsTxtBulkLoader(settings).load(directory.path().string(),
+        [&directory, &keys](const std::string& key, RobotsTxtRulesSnapshot, std::uint64_t)
+        {
+            keys.push_back(key);
+
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory.path()))
+            {
+                if (UrlHelpers::origin(entry.path().stem().string()) != key)
+                {
+                    std::filesystem::remove(entry.path());
+                }
+            }
+        });
+
+    EXPECT_EQ(statistics.records, 1);
+    EXPECT_EQ(statistics.failedFiles, fileCount - 1);
+    EXPECT_EQ(keys.size(), 1);
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+﻿#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "robots_txt_metrics.h"
+#include "robots_txt_rules.h"
+#include "well_known_user_agent.h"
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+//! Enables the metrics for the test and clears the global ones before and after it
+class MetricsScope final
+{
+public:
+    MetricsScope()
+    {
+        RobotsTxtMetrics::reset();
+        RobotsTxtMetrics::setEnabled(true);
+    }
+
+    ~MetricsScope()
+    {
+        RobotsTxtMetrics::setEnabled(false);
+        RobotsTxtMetrics::reset();
+    }
+};
+
+}
+
+TEST(MetricsTests, Counters)
+{
+    if (!RobotsTxtMetrics::isAvailable())
+    {
+        GTEST_SKIP() << "the library is built without the metrics";
+    }
+
+    RobotsTxtRules disabledRules("User-agent: *\nDisallow: /private\n");
+    disabledRules.setCountersEnabled(true);
+    EXPECT_EQ(disabledRules.isUrlAllowed("http://example.com/private", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(disabledRules.counters().evaluations, 0);
+
+    const MetricsScope metricsScope;
+
+    RobotsTxtRules rules;
+    rules.setCountersEnabled(true);
+    rules.parse(
+        "User-agent: *\n"
+        "Disallow: /private\n"
+        "Allow: /private/open\n"
+        "\n"
+        "User-agent: Yandex\n"
+        "Disallow: /*.pdf$\n"
+        "Disallow: /*/print\n"
+    );
+
+    EXPECT_EQ(rules.isUrlAllowed("http://example.com/private/1", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isUrlAllowed("http://example.com/private/open", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isUrlAllowed("http://example.com/public", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isUrlAllowed("http://example.com/doc.pdf", WellKnownUserAgent::YandexBot), false);
+
+    std::vector<bool> verdicts;
+    rules.arePathsAllowed({ "/a", "/b" }, rules.resolveGroup(WellKnownUserAgent::YandexBot), verdicts);
+
+    EXPECT_EQ(rules.tryCrawlDelay(WellKnownUserAgent::GoogleBot).has_value(), false);
+
+    const RobotsTxtCounters counters = rules.counters();
+
+    EXPECT_EQ(counters.evaluations, 6);
+    EXPECT_EQ(counters.disallowMatches, 2);
+    EXPECT_EQ(counters.allowMatches, 1);
+    EXPECT_EQ(counters.noMatches, 3);
+    // googlebot has no own group, the resolutions of its checks and of tryCrawlDelay fall back to "*"
+    EXPECT_EQ(counters.fallbacks, 4);
+    // the longer "/*/print" is tried before "/*.pdf$" by every check of yandex
+    EXPECT_EQ(counters.rulesScanned, 6);
+    EXPECT_EQ(counters.exceptionsAvoided, 1);
+    EXPECT_GT(counters.parseNanoseconds, 0);
+
+    // the copies get the current values
+    EXPECT_EQ(RobotsTxtRules(rules).counters().evaluations, 6);
+
+    // the global counters sum all objects, the ones without their own counters too
+    const RobotsTxtRules otherRules("User-agent: *\nDisallow: /\n");
+    EXPECT_EQ(otherRules.isPathAllowed("/page", WellKnownUserAgent::AllRobots), false);
+    EXPECT_EQ(otherRules.counters().evaluations, 0);
+
+    const RobotsTxtMetrics::Snapshot snapshot = RobotsTxtMetrics::snapshot();
+
+    EXPECT_EQ(snapshot.counters.evaluations, 7);
+    EXPECT_EQ(snapshot.counters.disallowMatches, 3);
+    EXPECT_EQ(snapshot.parseNanoseconds.count, 2);
+    EXPECT_EQ(snapshot.evaluateNanoseconds.count, 7);
+    EXPECT_EQ(snapshot.rulesScannedPerCheck.count, 7);
+    EXPECT_EQ(snapshot.rulesScannedPerCheck.sum, 6);
+    EXPECT_EQ(snapshot.rulesScannedPerCheck.quantile(1.0), 2);
+}
+
+TEST(MetricsTests, HistogramBuckets)
+{
+    if (!RobotsTxtMetrics::isAvailable())
+    {
+        GTEST_SKIP() << "the library is built without the metrics";
+    }
+
+    const MetricsScope metricsScope;
+
+    // the feeds and the finish are measured as one parse
+    RobotsTxtRules rules;
+    rules.setCountersEnabled(true);
+    rules.feed("User-agent: *\nDisa");
+    rules.feed("llow: /private\n");
+    rules.finish();
+
+    const RobotsTxtMetrics::Snapshot snapshot = RobotsTxtMetrics::snapshot();
+
+    ASSERT_EQ(snapshot.parseNanoseconds.count, 1);
+    ASSERT_EQ(snapshot.parseNanoseconds.buckets.size(), 1);
+
+    // the bucket is within 12.5% of the value
+    const MetricsHistogram::Bucket& bucket = snapshot.parseNanoseconds.buckets.front();
+    EXPECT_LE(bucket.lowerBound, snapshot.parseNanoseconds.sum);
+    EXPECT_GE(bucket.upperBound, snapshot.parseNanoseconds.sum);
+    EXPECT_LE(bucket.upperBound - bucket.lowerBound, bucket.lowerBound / 8);
+    EXPECT_EQ(snapshot.parseNanoseconds.sum, rules.counters().parseNanoseconds);
+}
+
+TEST(MetricsTests, HistogramRecordAndMerge)
+{
+    MetricsHistogram histogram;
+    histogram.record(1000);
+    histogram.record(3);
+    histogram.record(1001);
+
+    MetricsHistogram otherHistogram;
+    otherHistogram.record(100);
+    otherHistogram.record(3);
+
+    histogram.merge(otherHistogram);
+
+    ASSERT_EQ(histogram.buckets.size(), 3);
+    EXPECT_EQ(histogram.count, 5);
+    EXPECT_EQ(histogram.sum, 2107);
+
+    // the buckets stay sorted and the equal values share one
+    EXPECT_EQ(histogram.buckets[0].lowerBound, 3);
+    EXPECT_EQ(histogram.buckets[0].count, 2);
+    EXPECT_EQ(histogram.buckets[1].lowerBound, 96);
+    EXPECT_EQ(histogram.buckets[1].upperBound, 103);
+    EXPECT_EQ(histogram.buckets[2].lowerBound, 960);
+    EXPECT_EQ(histogram.buckets[2].upperBound, 1023);
+    EXPECT_EQ(histogram.buckets[2].count, 2);
+
+    EXPECT_EQ(histogram.quantile(0.4), 3);
+    EXPECT_EQ(histogram.quantile(0.6), 103);
+    EXPECT_EQ(histogram.quantile(1.0), 1023);
+}
+
+TEST(MetricsTests, Export)
+{
+    RobotsTxtMetrics::Snapshot snapshot;
+    snapshot.counters.evaluations = 3;
+    snapshot.counters.allowMatches = 1;
+    snapshot.counters.disallowMatches = 2;
+    snapshot.rulesScannedPerCheck.buckets = { { 0, 0, 1 }, { 2, 2, 1 }, { 16, 17, 1 } };
+    snapshot.rulesScannedPerCheck.count = 3;
+    snapshot.rulesScannedPerCheck.sum = 19;
+
+    const std::string prometheus = RobotsTxtMetrics::toPrometheus(snapshot);
+
+    EXPECT_NE(prometheus.find("# TYPE cpprobotparser_evaluations_total counter\ncpprobotparser_evaluations_total 3\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_matches_total{rule=\"disallow\"} 2\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_rules_scanned_per_check_bucket{le=\"0\"} 1\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_rules_scanned_per_check_bucket{le=\"3\"} 2\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_rules_scanned_per_check_bucket{le=\"15\"} 2\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_rules_scanned_per_check_bucket{le=\"31\"} 3\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_rules_scanned_per_check_bucket{le=\"+Inf\"} 3\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_rules_scanned_per_check_sum 19\n"), std::string::npos);
+    EXPECT_NE(prometheus.find("cpprobotparser_parse_duration_seconds_count 0\n"), std::string::npos);
+
+    const std::string json = RobotsTxtMetrics::toJson(snapshot);
+
+    EXPECT_NE(json.find("\"evaluations\":3,\"allow_matches\":1,\"disallow_matches\":2"), std::string::npos);
+    EXPECT_NE(json.find("\"rules_scanned_per_check\":{\"count\":3,\"sum\":19,\"p50\":2,\"p99\":17,\"p999\":17,\"buckets\":[[0,0,1],[2,2,1],[16,17,1]]}"), std::string::npos);
+}
\ No newline at end of file
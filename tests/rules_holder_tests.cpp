@@ -0,0 +1,75 @@
+﻿#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "robots_txt_rules_holder.h"
+#include "well_known_user_agent.h"
+
+using namespace cpprobotparser;
+
+TEST(RulesHolderTests, Reload)
+{
+    RobotsTxtRulesHolder holder;
+
+    const RobotsTxtRulesSnapshot emptySnapshot = holder.snapshot();
+
+    GTEST_ASSERT_NE(emptySnapshot, nullptr);
+    EXPECT_EQ(emptySnapshot->isPathAllowed("/private", WellKnownUserAgent::GoogleBot), true);
+
+    holder.reload("User-agent: *\nDisallow: /private");
+
+    const RobotsTxtRulesSnapshot snapshot = holder.snapshot();
+
+    EXPECT_EQ(snapshot->isPathAllowed("/private", WellKnownUserAgent::GoogleBot), false);
+
+    // the snapshot taken before the reload is not changed
+    EXPECT_EQ(emptySnapshot->isPathAllowed("/private", WellKnownUserAgent::GoogleBot), true);
+
+    holder.publish(nullptr);
+    EXPECT_EQ(holder.snapshot()->isPathAllowed("/private", WellKnownUserAgent::GoogleBot), true);
+}
+
+TEST(RulesHolderTests, ConcurrentReload)
+{
+    const std::string disallowFirst = "User-agent: *\nDisallow: /first\nAllow: /second";
+    const std::string disallowSecond = "User-agent: *\nDisallow: /second\nAllow: /first";
+
+    RobotsTxtRulesHolder holder(std::make_shared<const RobotsTxtRules>(disallowFirst));
+    std::atomic<bool> stopped(false);
+    std::atomic<int> inconsistentChecks(0);
+    std::vector<std::thread> readers;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back([&]
+        {
+            while (!stopped.load())
+            {
+                // exactly one of the paths is disallowed by every published snapshot
+                const RobotsTxtRulesSnapshot snapshot = holder.snapshot();
+                const bool firstAllowed = snapshot->isPathAllowed("/first", WellKnownUserAgent::GoogleBot);
+                const bool secondAllowed = snapshot->isPathAllowed("/second", WellKnownUserAgent::GoogleBot);
+
+                if (firstAllowed == secondAllowed)
+                {
+                    ++inconsistentChecks;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; ++i)
+    {
+        holder.reload(i % 2 ? disallowFirst : disallowSecond);
+    }
+
+    stopped = true;
+
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_EQ(inconsistentChecks.load(), 0);
+}
\ No newline at end of file
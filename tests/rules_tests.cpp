@@ -4,8 +4,15 @@
 #include <string>
 #include <locale>
 #include <codecvt>
+#include <random>
+#include <chrono>
+#include <memory>
 #include "robots_txt_rules.h"
+#include "robots_txt_pattern.h"
+#include "compiled_user_agent_group.h"
+#include "meta_robots_helpers.h"
 #include "well_known_user_agent.h"
+#include "url_helpers.h"
 
 using namespace cpprobotparser;
 
@@ -142,14 +149,16 @@ TEST(RulesTests, RegularExpressionsRobotsTxt)
     EXPECT_EQ(rules.isUrlAllowed("http://a.com/ext", WellKnownUserAgent::GoogleBot), true); // Disallow : */api/*/ext$
 
 
-    EXPECT_EQ(rules.isUrlAllowed("http://a.com/a/api/a/b/js.html", WellKnownUserAgent::GoogleBot), false); // Disallow : /api*html
-    EXPECT_EQ(rules.isUrlAllowed("http://a.com/a/api/a/b/html/a/b/c/d.css", WellKnownUserAgent::GoogleBot), false); // Disallow : /api*html
-    EXPECT_EQ(rules.isUrlAllowed("http://a.com/a/api/a/b/js.htmlext", WellKnownUserAgent::GoogleBot), false); // Disallow : /api*html
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/api/a/b/js.html", WellKnownUserAgent::GoogleBot), false); // Disallow : /api*html
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/api/a/b/html/a/b/c/d.css", WellKnownUserAgent::GoogleBot), false); // Disallow : /api*html
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/api/a/b/js.htmlext", WellKnownUserAgent::GoogleBot), false); // Disallow : /api*html
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/a/api/a/b/js.html", WellKnownUserAgent::GoogleBot), true); // Disallow : /api*html, the pattern matches from the path start
     EXPECT_EQ(rules.isUrlAllowed("http://a.com/a/a/b/js.htmlext", WellKnownUserAgent::GoogleBot), true); // Disallow : /api*html
     EXPECT_EQ(rules.isUrlAllowed("http://a.com/index.html", WellKnownUserAgent::GoogleBot), true); // Disallow : /api*html
 
-    EXPECT_EQ(rules.isUrlAllowed("http://a.com/example/index.html", WellKnownUserAgent::GoogleBot), true); // Disallow: /example*$
-    EXPECT_EQ(rules.isUrlAllowed("http://a.com/example", WellKnownUserAgent::GoogleBot), true); // Disallow: /example*$
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/example/index.html", WellKnownUserAgent::GoogleBot), false); // Disallow: /example*$
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/example", WellKnownUserAgent::GoogleBot), false); // Disallow: /example*$
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/an/example", WellKnownUserAgent::GoogleBot), true); // Disallow: /example*$
 }
 
 TEST(RulesTests, DifferentLineSeparatorsRobotsTxt)
@@ -230,3 +239,791 @@ TEST(RulesTests, NonAsciiSymbolsRobotsTxt)
     //EXPECT_EQ(rules.isUrlAllowed(L"http://a.com/ъР№чшэр", WellKnownUserAgent::GoogleBot), true);
     */
 }
+
+
+TEST(RulesTests, PathOnlyRobotsTxt)
+{
+    const std::string robotsTxt = R"(
+        User-agent: *
+        Disallow: /search?q=*&page=
+        Disallow: /private
+        Allow: /private/public)";
+
+    RobotsTxtRules rules(robotsTxt);
+
+    EXPECT_EQ(rules.isPathAllowed("/private", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/Private/page.html", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/private/public/page.html", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/search?q=robots&page=2", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/search?q=robots", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isPathAllowed("", WellKnownUserAgent::GoogleBot), true);
+
+    // query separators must be kept when the path is taken from the full URL
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/search?q=robots&page=2#fragment", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/private/public?a=1&b=2", WellKnownUserAgent::GoogleBot), true);
+}
+
+TEST(RulesTests, UrlWithoutSchemeRobotsTxt)
+{
+    const RobotsTxtRules rules("User-agent: *\nDisallow: /\nAllow: /public\n");
+
+    // the URL without the scheme starts with the host as for the origin it's looked up by
+    EXPECT_EQ(UrlHelpers::origin("example.com/a"), "http://example.com:80");
+    EXPECT_EQ(UrlHelpers::pathAndQuery("example.com/a?b#c"), "/a?b");
+    EXPECT_EQ(UrlHelpers::pathAndQuery("example.com?b"), "?b");
+    EXPECT_EQ(UrlHelpers::pathAndQuery("example.com"), "");
+    EXPECT_EQ(UrlHelpers::pathAndQuery("/a?b"), "/a?b");
+
+    EXPECT_EQ(rules.isUrlAllowed("example.com/a", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isUrlAllowed("example.com/public/a", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isUrlAllowed("example.com?q=1", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isUrlAllowed("example.com", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isUrlAllowed("/a", WellKnownUserAgent::GoogleBot), false);
+}
+
+TEST(RulesTests, BatchRobotsTxt)
+{
+    const std::string robotsTxt = R"(
+        User-agent: *
+        Disallow: /
+
+        User-agent: Googlebot
+        Disallow: /private
+        Allow: /private/public
+        Disallow: /*?sort=)";
+
+    RobotsTxtRules rules(robotsTxt);
+
+    const std::vector<std::string> urls
+    {
+        "http://a.com/",
+        "http://a.com/private/page.html",
+        "http://a.com/private/public/page.html",
+        "http://a.com/catalog?sort=price",
+        "http://a.com?sort=price",
+        "http://a.com"
+    };
+
+    std::vector<bool> verdicts;
+    rules.areUrlsAllowed(urls, WellKnownUserAgent::GoogleBot, verdicts);
+
+    GTEST_ASSERT_EQ(verdicts.size(), urls.size());
+
+    for (std::size_t i = 0; i < urls.size(); ++i)
+    {
+        EXPECT_EQ(verdicts[i], rules.isUrlAllowed(urls[i], WellKnownUserAgent::GoogleBot)) << urls[i];
+    }
+
+    const std::vector<std::string_view> paths{ "/", "/private", "/private/public", "/catalog?sort=price" };
+    const std::vector<bool> expectedForGoogle{ true, false, true, false };
+
+    rules.arePathsAllowed(paths, WellKnownUserAgent::GoogleBot, verdicts);
+    EXPECT_EQ(verdicts, expectedForGoogle);
+
+    // Yandex has no own rules, the rules for all robots are used
+    rules.arePathsAllowed(paths, WellKnownUserAgent::YandexBot, verdicts);
+    EXPECT_EQ(verdicts, std::vector<bool>(paths.size(), false));
+
+    rules.arePathsAllowed({}, WellKnownUserAgent::GoogleBot, verdicts);
+    EXPECT_EQ(verdicts.empty(), true);
+}
+
+TEST(RulesTests, ResolvedGroupRobotsTxt)
+{
+    const std::string robotsTxt = R"(
+        User-agent: *
+        Disallow: /private
+
+        User-agent: Yandex
+        Crawl-delay: 2.5
+        Clean-param: ref /some_dir/get_book.pl
+
+        User-agent: Googlebot
+        Disallow: /
+        Allow: /public)";
+
+    RobotsTxtRules rules(robotsTxt);
+
+    const UserAgentGroup yandexGroup = rules.resolveGroup(WellKnownUserAgent::YandexBot);
+    const UserAgentGroup googleGroup = rules.resolveGroup("googlebot");
+    const UserAgentGroup msnGroup = rules.resolveGroup(WellKnownUserAgent::MsnBot);
+
+    EXPECT_EQ(yandexGroup.hasOwnRecord(), true);
+    EXPECT_EQ(googleGroup.hasOwnRecord(), true);
+    EXPECT_EQ(msnGroup.hasOwnRecord(), false);
+
+    // Yandex has no own Allow/Disallow rules, the rules for all robots are applied
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/private/page.html", yandexGroup), false);
+    EXPECT_EQ(rules.isUrlAllowed("http://a.com/page.html", yandexGroup), true);
+    EXPECT_EQ(rules.isPathAllowed("/private", msnGroup), false);
+    EXPECT_EQ(rules.isPathAllowed("/public/page.html", googleGroup), true);
+    EXPECT_EQ(rules.isPathAllowed("/page.html", googleGroup), false);
+
+    EXPECT_EQ(rules.crawlDelay(yandexGroup), 2.5);
+    EXPECT_THROW(rules.crawlDelay(googleGroup), std::runtime_error);
+    EXPECT_THROW(rules.crawlDelay(msnGroup), std::runtime_error);
+
+    GTEST_ASSERT_EQ(rules.cleanParam(yandexGroup).size(), 1);
+    EXPECT_EQ(rules.cleanParam(yandexGroup).front(), "ref /some_dir/get_book.pl");
+    EXPECT_EQ(rules.cleanParam(msnGroup).empty(), true);
+
+    // the handle created by default allows everything
+    EXPECT_EQ(rules.isPathAllowed("/private", UserAgentGroup()), true);
+}
+
+TEST(RulesTests, ManyLiteralRulesRobotsTxt)
+{
+    std::string robotsTxt = "User-agent: *\n";
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        const std::string folder = "/folder" + std::to_string(i);
+
+        robotsTxt += "Disallow: " + folder + "\n";
+        robotsTxt += "Allow: " + folder + "/public\n";
+    }
+
+    robotsTxt += "Disallow: /*/public/secret\n";
+    robotsTxt += "Allow: /folder1/public/secret/open\n";
+    robotsTxt += "Disallow: /Folder7/Public\n";
+
+    RobotsTxtRules rules(robotsTxt);
+
+    EXPECT_EQ(rules.isPathAllowed("/", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/folder", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/folder0", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/folder4999/page.html", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/FOLDER4999/PUBLIC/page.html", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/folders", WellKnownUserAgent::GoogleBot), true);
+
+    // the prefix of a longer rule doesn't match by itself
+    EXPECT_EQ(rules.isPathAllowed("/folder12/pub", WellKnownUserAgent::GoogleBot), false);
+
+    // wildcard rules compete with the literal ones
+    EXPECT_EQ(rules.isPathAllowed("/folder2/public/secret", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/folder1/public/secret/open", WellKnownUserAgent::GoogleBot), true);
+
+    // on equal length the Allow rule wins
+    EXPECT_EQ(rules.isPathAllowed("/folder7/public/page.html", WellKnownUserAgent::GoogleBot), true);
+}
+
+TEST(RulesTests, IncrementalRobotsTxt)
+{
+    RobotsTxtRules rules;
+
+    rules.feed("User-agent: *\r");
+    rules.feed("\nDisallow: /priv");
+    rules.feed("ate\r\nAllow: /private/public");
+    rules.finish();
+
+    EXPECT_EQ(rules.isTruncated(), false);
+    EXPECT_EQ(rules.isPathAllowed("/private/page.html", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/private/public/page.html", WellKnownUserAgent::GoogleBot), true);
+}
+
+TEST(RulesTests, CopiedRulesRobotsTxt)
+{
+    // the compiled patterns are the views of the tokenized values of their own object
+    std::unique_ptr<RobotsTxtRules> original = std::make_unique<RobotsTxtRules>("User-agent: *\nDisallow: /private\nAllow: /private/*.html$\n");
+    RobotsTxtRules copy(*original);
+    RobotsTxtRules assigned;
+    assigned = *original;
+    original.reset();
+
+    for (const RobotsTxtRules* rules : { &copy, &assigned })
+    {
+        EXPECT_EQ(rules->isPathAllowed("/private/data", WellKnownUserAgent::GoogleBot), false);
+        EXPECT_EQ(rules->isPathAllowed("/private/page.html", WellKnownUserAgent::GoogleBot), true);
+    }
+
+    // the first chunk of the new content drops the previous rules, the copy of the partially fed rules has no rules too
+    copy.feed("User-agent: *\nDisallow: /pub");
+    const RobotsTxtRules partialCopy(copy);
+    copy.feed("lic\n");
+    copy.finish();
+
+    EXPECT_EQ(partialCopy.isPathAllowed("/private/data", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(partialCopy.isPathAllowed("/public", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(copy.isPathAllowed("/private/data", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(copy.isPathAllowed("/public", WellKnownUserAgent::GoogleBot), false);
+}
+
+TEST(RulesTests, GroupLookupRobotsTxt)
+{
+    RobotsTxtRules rules(
+        "User-agent: Yandex\n"
+        "Disallow: /yandex\n"
+        "\n"
+        "User-agent: Slurp\n"
+        "Crawl-delay: 2\n"
+        "\n"
+        "User-agent: *\n"
+        "Disallow: /all\n"
+    );
+
+    EXPECT_EQ(rules.hasRulesFor(WellKnownUserAgent::YandexBot), true);
+    EXPECT_EQ(rules.hasRulesFor(WellKnownUserAgent::YahooBot), true);
+    EXPECT_EQ(rules.hasRulesFor(WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.hasRulesFor("yandex"), true);
+    EXPECT_EQ(rules.hasRulesFor("*"), true);
+    EXPECT_EQ(rules.hasRulesFor("googlebot"), false);
+
+    // the lookups by the enum and by the name resolve the same groups
+    EXPECT_EQ(rules.isPathAllowed("/all", WellKnownUserAgent::YandexBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/all", "yandex"), true);
+    EXPECT_EQ(rules.isPathAllowed("/all", WellKnownUserAgent::YahooBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/all", "slurp"), false);
+    EXPECT_EQ(rules.crawlDelay("slurp"), 2.0);
+
+    // the user agents without the name are rejected as before
+    EXPECT_THROW(rules.isPathAllowed("/all", WellKnownUserAgent::AltaVistaBot), std::runtime_error);
+
+    rules.parse("User-agent: Googlebot\nDisallow: /google\n");
+
+    EXPECT_EQ(rules.hasRulesFor(WellKnownUserAgent::YandexBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/google", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/all", WellKnownUserAgent::YahooBot), true);
+}
+
+// the examples of RFC 9309 sections 2.2.2 and 5, the user agents are replaced with the well known ones
+TEST(RulesTests, Rfc9309RobotsTxt)
+{
+    const RobotsTxtRules simpleExample(
+        "User-Agent: *\n"
+        "Disallow: *.gif$\n"
+        "Disallow: /example/\n"
+        "Allow: /publications/\n"
+        "\n"
+        "User-Agent: Googlebot\n"
+        "Disallow:/\n"
+        "Allow:/example/page.html\n"
+        "Allow:/example/allowed.gif\n"
+        "\n"
+        "User-Agent: Yandex\n"
+        "Disallow: /example/page.html\n"
+    );
+
+    EXPECT_EQ(simpleExample.isPathAllowed("/example/page.html", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(simpleExample.isPathAllowed("/example/allowed.gif", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(simpleExample.isPathAllowed("/example/disallowed.gif", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(simpleExample.isPathAllowed("/publications/", WellKnownUserAgent::GoogleBot), false);
+
+    EXPECT_EQ(simpleExample.isPathAllowed("/example/page.html", WellKnownUserAgent::YandexBot), false);
+    EXPECT_EQ(simpleExample.isPathAllowed("/example/other.html", WellKnownUserAgent::YandexBot), true);
+
+    EXPECT_EQ(simpleExample.isPathAllowed("/publications/", WellKnownUserAgent::MsnBot), true);
+    EXPECT_EQ(simpleExample.isPathAllowed("/example/", WellKnownUserAgent::MsnBot), false);
+    EXPECT_EQ(simpleExample.isPathAllowed("/image.gif", WellKnownUserAgent::MsnBot), false);
+    EXPECT_EQ(simpleExample.isPathAllowed("/publications/image.gif", WellKnownUserAgent::MsnBot), true);
+    EXPECT_EQ(simpleExample.isPathAllowed("/image.gif?size=1", WellKnownUserAgent::MsnBot), true);
+
+    // the longest match wins regardless of the rule order and type
+    const RobotsTxtRules longestMatchExample(
+        "User-Agent: *\n"
+        "Allow: /example/page/\n"
+        "Disallow: /example/page/disallowed.gif\n"
+    );
+
+    EXPECT_EQ(longestMatchExample.isPathAllowed("/example/page/", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(longestMatchExample.isPathAllowed("/example/page/allowed.gif", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(longestMatchExample.isPathAllowed("/example/page/disallowed.gif", WellKnownUserAgent::GoogleBot), false);
+
+    // the length is counted in octets, not in path segments
+    const RobotsTxtRules octetsExample(
+        "User-Agent: *\n"
+        "Disallow: /a/b/c\n"
+        "Allow: /a/b/c-long-name\n"
+        "Disallow: /*.php\n"
+        "Allow: /scripts/\n"
+    );
+
+    EXPECT_EQ(octetsExample.isPathAllowed("/a/b/c-long-name", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(octetsExample.isPathAllowed("/a/b/c-short", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(octetsExample.isPathAllowed("/scripts/index.php", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(octetsExample.isPathAllowed("/index.php", WellKnownUserAgent::GoogleBot), false);
+
+    // equivalent Allow and Disallow rules: Allow is used
+    const RobotsTxtRules equivalentExample(
+        "User-Agent: *\n"
+        "Disallow: /page\n"
+        "Allow: /page\n"
+        "Disallow: /*.html\n"
+        "Allow: /*.html\n"
+    );
+
+    EXPECT_EQ(equivalentExample.isPathAllowed("/page", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(equivalentExample.isPathAllowed("/index.html", WellKnownUserAgent::GoogleBot), true);
+
+    // an empty rule value matches nothing and the robots.txt itself is always allowed
+    const RobotsTxtRules emptyRuleExample(
+        "User-Agent: Googlebot\n"
+        "Disallow:\n"
+        "\n"
+        "User-Agent: *\n"
+        "Disallow: /\n"
+    );
+
+    EXPECT_EQ(emptyRuleExample.isPathAllowed("/page", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(emptyRuleExample.isPathAllowed("/page", WellKnownUserAgent::YandexBot), false);
+    EXPECT_EQ(emptyRuleExample.isPathAllowed("/robots.txt", WellKnownUserAgent::YandexBot), true);
+}
+
+namespace
+{
+
+// straightforward backtracking matcher used as the reference for the wildcard engine
+bool referenceMatches(const std::string& pattern, std::size_t patternIndex, const std::string& path, std::size_t pathIndex)
+{
+    if (patternIndex == pattern.size())
+    {
+        return true;
+    }
+
+    if (pattern[patternIndex] == '$')
+    {
+        return patternIndex + 1 == pattern.size() && pathIndex == path.size();
+    }
+
+    if (pattern[patternIndex] == '*')
+    {
+        for (std::size_t i = pathIndex; i <= path.size(); ++i)
+        {
+            if (referenceMatches(pattern, patternIndex + 1, path, i))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    return pathIndex < path.size() &&
+        std::tolower(static_cast<unsigned char>(path[pathIndex])) == std::tolower(static_cast<unsigned char>(pattern[patternIndex])) &&
+        referenceMatches(pattern, patternIndex + 1, path, pathIndex + 1);
+}
+
+}
+
+TEST(RulesTests, WildcardMatcherRobotsTxt)
+{
+    // the cases the previous matcher got wrong
+    EXPECT_EQ(RobotsTxtPattern("/a*b").matches("/x/a/b"), false); // the first segment is a prefix
+    EXPECT_EQ(RobotsTxtPattern("/a*b").matches("/a/b"), true);
+    EXPECT_EQ(RobotsTxtPattern("*b*a").matches("/ab"), false); // the segments are matched in order
+    EXPECT_EQ(RobotsTxtPattern("*b*a").matches("/ba"), true);
+    EXPECT_EQ(RobotsTxtPattern("/a*b$").matches("/ab"), true);
+    EXPECT_EQ(RobotsTxtPattern("/a*b$").matches("/axxxb"), true);
+    EXPECT_EQ(RobotsTxtPattern("/a*b$").matches("/x/ab"), false);
+    EXPECT_EQ(RobotsTxtPattern("/ab*b$").matches("/ab"), false); // the anchored segment can't overlap the previous ones
+    EXPECT_EQ(RobotsTxtPattern("/a$").matches("/a"), true);
+    EXPECT_EQ(RobotsTxtPattern("/a$").matches("/b/a"), false);
+    EXPECT_EQ(RobotsTxtPattern("/a*$").matches("/abc"), true);
+
+    // the long segments are found by their last bytes and fall back to the Two-Way search on the repeated candidates
+    const std::string longSegment = "/" + std::string(40, 'a') + "b";
+    EXPECT_EQ(RobotsTxtPattern("*" + longSegment).matches("/x" + std::string(100, 'a') + longSegment), true);
+    EXPECT_EQ(RobotsTxtPattern("*" + longSegment).matches("/x" + longSegment.substr(0, 30) + longSegment.substr(31)), false);
+    EXPECT_EQ(RobotsTxtPattern("*/abababababababababababc*").matches("/abababababababababababab/ABABABABABABABABABABABC"), true);
+
+    const std::string repeatedTail = std::string(40, 'a') + "b" + std::string(16, 'a');
+    EXPECT_EQ(RobotsTxtPattern("/*" + repeatedTail).matches("/" + std::string(300, 'a') + repeatedTail), true);
+    EXPECT_EQ(RobotsTxtPattern("/*" + repeatedTail).matches("/" + std::string(300, 'a') + repeatedTail.substr(1)), true);
+    EXPECT_EQ(RobotsTxtPattern("/*" + repeatedTail).matches("/" + std::string(300, 'a')), false);
+
+    std::mt19937 generator(20231017);
+    const std::string patternAlphabet = "ab*";
+    const std::string pathAlphabet = "abAB";
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string pattern;
+        std::string path;
+
+        const std::size_t patternSize = generator() % 40;
+        const std::size_t pathSize = generator() % 80;
+
+        for (std::size_t j = 0; j < patternSize; ++j)
+        {
+            // the long runs without wildcards produce the segments for the Two-Way search
+            pattern += patternAlphabet[generator() % (j % 30 < 26 ? 2 : 3)];
+        }
+
+        if (generator() % 4 == 0)
+        {
+            pattern += '$';
+        }
+
+        for (std::size_t j = 0; j < pathSize; ++j)
+        {
+            path += pathAlphabet[generator() % pathAlphabet.size()];
+        }
+
+        EXPECT_EQ(RobotsTxtPattern(pattern).matches(path), referenceMatches(pattern, 0, path, 0)) << pattern << " " << path;
+    }
+}
+
+TEST(RulesTests, UserAgentVerdictsRobotsTxt)
+{
+    const RobotsTxtRules rules(
+        "User-agent: *\n"
+        "Disallow: /private\n"
+        "Disallow: /*.php$\n"
+        "Allow: /private/public\n"
+        "\n"
+        "User-agent: Googlebot\n"
+        "Disallow: /private\n"
+        "Disallow: /*.php$\n"
+        "Allow: /*/index.php$\n"
+        "Disallow: /search\n"
+        "\n"
+        "User-agent: Yandex\n"
+        "Crawl-delay: 2\n"
+        "\n"
+        "User-agent: msnbot\n"
+        "Disallow: /\n"
+    );
+
+    const std::vector<std::string> urls
+    {
+        "http://a.com/",
+        "http://a.com/private/page.html",
+        "http://a.com/private/public/page.html",
+        "http://a.com/catalog/index.php",
+        "http://a.com/catalog/page.php",
+        "http://a.com/search?q=1",
+        "http://a.com/?q=1",
+        "http://a.com/robots.txt"
+    };
+
+    // the one-pass verdicts agree with the verdicts for every user agent one by one
+    for (const std::string& url : urls)
+    {
+        const UserAgentVerdicts verdicts = rules.urlVerdicts(url);
+
+        for (WellKnownUserAgent userAgent : MetaRobotsHelpers::wellKnownUserAgents())
+        {
+            EXPECT_EQ(verdicts.isAllowed(userAgent), rules.isUrlAllowed(url, userAgent)) << url << " " << static_cast<int>(userAgent);
+        }
+
+        EXPECT_EQ(verdicts.isAllowed(WellKnownUserAgent::Unknown), false);
+        EXPECT_EQ(verdicts, rules.pathVerdicts(url.substr(std::string("http://a.com").size())));
+    }
+
+    const UserAgentVerdicts catalogVerdicts = rules.urlVerdicts("http://a.com/catalog/index.php");
+    EXPECT_EQ(catalogVerdicts.isAllowed(WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(catalogVerdicts.isAllowed(WellKnownUserAgent::YandexBot), false);
+    EXPECT_EQ(catalogVerdicts.isAllowed(WellKnownUserAgent::AllRobots), false);
+    EXPECT_EQ(catalogVerdicts.isAllowed(WellKnownUserAgent::MsnBot), false);
+
+    // without any rules every user agent may crawl everything
+    const UserAgentVerdicts emptyVerdicts = RobotsTxtRules("").urlVerdicts("http://a.com/page");
+
+    for (WellKnownUserAgent userAgent : MetaRobotsHelpers::wellKnownUserAgents())
+    {
+        EXPECT_EQ(emptyVerdicts.isAllowed(userAgent), true);
+        EXPECT_NE(emptyVerdicts.mask() & UserAgentVerdicts::bit(userAgent), 0u);
+    }
+}
+
+TEST(RulesTests, CanonicalizeRobotsTxt)
+{
+    const RobotsTxtRules rules(
+        "User-agent: Yandex\n"
+        "Disallow: /private\n"
+        "Clean-param: ref /some_dir/get_book.pl\n"
+        "Clean-param: sid&sort /forum/*.php\n"
+        "Clean-param: s /forum/\n"
+        "Clean-param: utm_Source&utm_medium\n"
+        "Clean-param: from /forum/\n"
+        "\n"
+        "User-agent: *\n"
+        "Disallow: /admin\n"
+    );
+
+    std::string buffer;
+
+    const auto canonicalize = [&rules, &buffer](std::string_view url)
+    {
+        return std::string(rules.canonicalize(url, WellKnownUserAgent::YandexBot, buffer));
+    };
+
+    EXPECT_EQ(canonicalize("http://a.com/some_dir/get_book.pl?ref=site_1&book_id=123"), "http://a.com/some_dir/get_book.pl?book_id=123");
+    EXPECT_EQ(canonicalize("http://a.com/some_dir/get_book.pl?book_id=123&ref=site_2"), "http://a.com/some_dir/get_book.pl?book_id=123");
+    EXPECT_EQ(canonicalize("http://a.com/some_dir/get_book.pl?ref=site_3"), "http://a.com/some_dir/get_book.pl");
+    EXPECT_EQ(canonicalize("http://a.com/other/get_book.pl?ref=site_1&book_id=123"), "http://a.com/other/get_book.pl?ref=site_1&book_id=123");
+
+    // the wildcard in the path, several parameters in one directive and the directives with the same path merged
+    EXPECT_EQ(canonicalize("http://a.com/forum/showthread.php?s=1&t=2&sid=3&sort=4#post"), "http://a.com/forum/showthread.php?t=2#post");
+    EXPECT_EQ(canonicalize("http://a.com/forum/index.html?from=main&sid=3"), "http://a.com/forum/index.html?sid=3");
+
+    // the directive without a path is applied to every URL
+    EXPECT_EQ(canonicalize("http://a.com/?utm_source=x&utm_medium=y&id=1"), "http://a.com/?id=1");
+    EXPECT_EQ(canonicalize("http://a.com?utm_source=x"), "http://a.com");
+    EXPECT_EQ(canonicalize("/page?id=1&&utm_source=x&"), "/page?id=1");
+    EXPECT_EQ(canonicalize("/page?&utm_source=x&id=1"), "/page?id=1");
+
+    // the parameter names are compared case insensitively and the fragment isn't a query
+    EXPECT_EQ(canonicalize("http://a.com/page?UTM_Source=x&utm_mediums=y"), "http://a.com/page?utm_mediums=y");
+    EXPECT_EQ(canonicalize("http://a.com/page#?utm_source=x"), "http://a.com/page#?utm_source=x");
+
+    // the URL is returned as is if nothing is removed
+    const std::string url = "http://a.com/some_dir/get_book.pl?book_id=123";
+    EXPECT_EQ(rules.canonicalize(url, WellKnownUserAgent::YandexBot, buffer).data(), url.data());
+
+    // Clean-param is taken only from the own record of the user agent
+    EXPECT_EQ(rules.canonicalize("http://a.com/?utm_source=x", WellKnownUserAgent::GoogleBot, buffer), "http://a.com/?utm_source=x");
+    EXPECT_EQ(rules.canonicalize("http://a.com/?utm_source=x", rules.resolveGroup("yandex"), buffer), "http://a.com/");
+}
+
+TEST(RulesTests, DirectiveValuesRobotsTxt)
+{
+    using namespace std::chrono_literals;
+
+    const RobotsTxtRules rules(
+        "User-agent: Yandex\n"
+        "Crawl-delay: fast\n"
+        "Crawl-delay: 0.5\n"
+        "Crawl-delay: 3\n"
+        "Request-rate: 1/5\n"
+        "Request-rate: 10/1m 2300-0130\n"
+        "Request-rate: 0/5\n"
+        "Request-rate: 1/5w\n"
+        "Visit-time: 0600-0845\n"
+        "\n"
+        "User-agent: Googlebot\n"
+        "Disallow: /private\n"
+        "Visit-time: 2500-0100\n"
+        "\n"
+        "User-agent: *\n"
+        "Crawl-delay: -1\n"
+    );
+
+    // the first valid value is taken, nothing is thrown for the absent or malformed values
+    EXPECT_EQ(rules.tryCrawlDelay(WellKnownUserAgent::YandexBot), 0.5);
+    EXPECT_EQ(rules.crawlDelay("yandex"), 0.5);
+    EXPECT_EQ(rules.tryCrawlDelay(WellKnownUserAgent::GoogleBot), std::nullopt);
+    EXPECT_EQ(rules.tryCrawlDelay("*"), std::nullopt);
+    EXPECT_EQ(rules.tryCrawlDelay(rules.resolveGroup(WellKnownUserAgent::MsnBot)), std::nullopt);
+    EXPECT_THROW(rules.crawlDelay(WellKnownUserAgent::AllRobots), std::runtime_error);
+
+    const std::vector<RequestRate> requestRates = rules.requestRates(WellKnownUserAgent::YandexBot);
+    GTEST_ASSERT_EQ(requestRates.size(), 2);
+    EXPECT_EQ(requestRates[0], (RequestRate{ 1, 5s, std::nullopt }));
+    EXPECT_EQ(requestRates[1], (RequestRate{ 10, 60s, VisitTime{ 23h, 1h + 30min } }));
+    EXPECT_EQ(requestRates[1].interval(), 6s);
+    EXPECT_EQ(requestRates[1].visitTime->contains(0min), true);
+    EXPECT_EQ(requestRates[1].visitTime->contains(12h), false);
+    EXPECT_EQ(rules.requestRates(WellKnownUserAgent::GoogleBot).empty(), true);
+
+    EXPECT_EQ(rules.visitTime(WellKnownUserAgent::YandexBot), (VisitTime{ 6h, 8h + 45min }));
+    EXPECT_EQ(rules.visitTime("googlebot"), std::nullopt);
+    EXPECT_EQ(rules.fetchInterval(WellKnownUserAgent::YandexBot), 6s);
+
+    // the malformed values are reported in the order of appearance
+    const std::vector<ParseDiagnostic>& parseDiagnostics = rules.parseDiagnostics();
+    std::vector<std::pair<std::string, std::string>> malformedValues;
+
+    for (const ParseDiagnostic& parseDiagnostic : parseDiagnostics)
+    {
+        EXPECT_EQ(parseDiagnostic.message.empty(), false);
+        malformedValues.emplace_back(parseDiagnostic.userAgent, parseDiagnostic.value);
+    }
+
+    EXPECT_EQ(malformedValues, (std::vector<std::pair<std::string, std::string>>
+    {
+        { "yandex", "fast" },
+        { "yandex", "0/5" },
+        { "yandex", "1/5w" },
+        { "googlebot", "2500-0100" },
+        { "*", "-1" }
+    }));
+
+    EXPECT_EQ(parseDiagnostics.front().token, RobotsTxtToken::TokenCrawlDelay);
+    EXPECT_EQ(parseDiagnostics[3].token, RobotsTxtToken::TokenVisitTime);
+
+    RobotsTxtRules validRules("User-agent: *\nCrawl-delay: 1\n");
+    EXPECT_EQ(validRules.parseDiagnostics().empty(), true);
+}
+
+TEST(RulesTests, LenientCrawlDelayRobotsTxt)
+{
+    // the decimal values accepted by std::stod are still accepted, the characters after the number are ignored,
+    // the hexadecimal ones are reported instead of taking their leading zero
+    const std::vector<std::pair<std::string, std::optional<double>>> crawlDelays
+    {
+        { "3", 3 },
+        { "2.5s", 2.5 },
+        { "2,5", 2 },
+        { "+4", 4 },
+        { "\v3", 3 },
+        { "1e1", 10 },
+        { ".5", 0.5 },
+        { "10 seconds", 10 },
+        { "0", 0 },
+        { "s2", std::nullopt },
+        { "-1", std::nullopt },
+        { "inf", std::nullopt },
+        { "nan", std::nullopt },
+        { "1e7", std::nullopt },
+        { "0x10", std::nullopt },
+        { "-0X10", std::nullopt },
+        { "0x1p3", std::nullopt }
+    };
+
+    for (const auto& [value, crawlDelay] : crawlDelays)
+    {
+        const RobotsTxtRules rules("User-agent: *\nCrawl-delay: " + value + "\n");
+
+        EXPECT_EQ(rules.tryCrawlDelay(WellKnownUserAgent::AllRobots), crawlDelay) << value;
+        EXPECT_EQ(rules.parseDiagnostics().empty(), crawlDelay.has_value()) << value;
+    }
+}
+
+TEST(RulesTests, ArbitraryUserAgentsRobotsTxt)
+{
+    const RobotsTxtRules rules(
+        "User-agent: OurBot\n"
+        "Disallow: /private\n"
+        "Crawl-delay: 4\n"
+        "\n"
+        "User-agent: Googlebot-Image\n"
+        "Disallow: /images\n"
+        "\n"
+        "User-agent: Googlebot\n"
+        "Disallow: /nogoogle\n"
+        "\n"
+        "User-agent: *\n"
+        "Disallow: /all\n"
+    );
+
+    // the records of any user agent are kept and looked up case insensitively
+    EXPECT_EQ(rules.userAgents().size(), 4);
+    EXPECT_EQ(rules.hasRulesFor("ourbot"), true);
+    EXPECT_EQ(rules.isPathAllowed("/private", "OurBot"), false);
+    EXPECT_EQ(rules.isPathAllowed("/all", "ourbot"), true);
+    EXPECT_EQ(rules.crawlDelay("OURBOT"), 4);
+    EXPECT_EQ(rules.isPathAllowed("/nogoogle", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/images", WellKnownUserAgent::GoogleBot), true);
+
+    const auto isAllowed = [&rules](std::string_view path, std::string_view userAgentHeader)
+    {
+        return rules.isPathAllowed(path, rules.resolveGroupFromHeader(userAgentHeader));
+    };
+
+    EXPECT_EQ(isAllowed("/private", "Mozilla/5.0 (compatible; OurBot/2.1; +https://our.site/bot)"), false);
+    EXPECT_EQ(rules.resolveGroupFromHeader("Mozilla/5.0 (compatible; OurBot/2.1)").hasOwnRecord(), true);
+    EXPECT_EQ(isAllowed("/images/a.png", "Googlebot-Image/1.0"), false);
+    EXPECT_EQ(isAllowed("/nogoogle", "Googlebot-Image/1.0"), true);
+
+    // the token without a record falls back to its prefix before '-', the unknown robots get the rules for all robots
+    EXPECT_EQ(isAllowed("/nogoogle", "Mozilla/5.0 (compatible; Googlebot-News)"), false);
+    EXPECT_EQ(isAllowed("/nogoogle", "Mozilla/5.0 (compatible; Googlebot/2.1; +http://www.google.com/bot.html)"), false);
+    EXPECT_EQ(isAllowed("/all", "curl/8.0"), false);
+    EXPECT_EQ(rules.resolveGroupFromHeader("curl/8.0").hasOwnRecord(), false);
+}
+
+TEST(RulesTests, MultiAgentGroupRobotsTxt)
+{
+    const RobotsTxtRules rules(
+        "User-agent: OurBot\n"
+        "User-agent: Googlebot\n"
+        "Disallow: /a\n"
+        "Crawl-delay: 2\n"
+        "\n"
+        "User-agent: *\n"
+        "Disallow: /b\n"
+    );
+
+    // every user agent of the group gets its rules
+    EXPECT_EQ(rules.hasRulesFor("ourbot"), true);
+    EXPECT_EQ(rules.isPathAllowed("/a", "OurBot"), false);
+    EXPECT_EQ(rules.isPathAllowed("/b", "OurBot"), true);
+    EXPECT_EQ(rules.crawlDelay("ourbot"), 2);
+    EXPECT_EQ(rules.isPathAllowed("/a", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/b", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.crawlDelay(WellKnownUserAgent::GoogleBot), 2);
+    EXPECT_EQ(rules.isPathAllowed("/a", WellKnownUserAgent::YandexBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/b", WellKnownUserAgent::YandexBot), false);
+}
+
+TEST(RulesTests, PathPrefilterRobotsTxt)
+{
+    const auto prefilter = [](const std::vector<std::string>& disallowPatterns, const std::vector<std::string>& allowPatterns = {})
+    {
+        std::vector<CompiledRule> rules;
+
+        for (const std::string& pattern : disallowPatterns)
+        {
+            rules.emplace_back(RobotsTxtToken::TokenDisallow, pattern);
+        }
+        for (const std::string& pattern : allowPatterns)
+        {
+            rules.emplace_back(RobotsTxtToken::TokenAllow, pattern);
+        }
+
+        return RobotsTxtPathPrefilter(rules);
+    };
+
+    // the first two characters after '/' are compared case insensitively
+    const RobotsTxtPathPrefilter literals = prefilter({ "/Admin", "/search", "/p*.pdf", "/q$" });
+    EXPECT_EQ(literals.mayMatch("/admin/users"), true);
+    EXPECT_EQ(literals.mayMatch("/ADMIN"), true);
+    EXPECT_EQ(literals.mayMatch("/se"), true);
+    EXPECT_EQ(literals.mayMatch("/products/1"), true);
+    EXPECT_EQ(literals.mayMatch("/q"), true);
+    EXPECT_EQ(literals.mayMatch("/catalog"), false);
+    EXPECT_EQ(literals.mayMatch("/a"), false);
+    EXPECT_EQ(literals.mayMatch("/"), true);
+    EXPECT_EQ(literals.mayMatch("catalog"), true);
+    EXPECT_EQ(literals.verdict("/catalog"), RobotsTxtPathPrefilter::VerdictAllowed);
+    EXPECT_EQ(literals.verdict("/admin"), RobotsTxtPathPrefilter::VerdictUnknown);
+
+    // the patterns which can match any path turn the filter off
+    EXPECT_EQ(prefilter({ "/admin", "/*.pdf" }).mayMatch("/catalog"), true);
+    EXPECT_EQ(prefilter({ "/admin", "*.pdf" }).mayMatch("/catalog"), true);
+    EXPECT_EQ(prefilter({ "/admin", "/" }, { "/public" }).mayMatch("/catalog"), true);
+
+    EXPECT_EQ(prefilter({}).verdict("/admin"), RobotsTxtPathPrefilter::VerdictAllowed);
+    EXPECT_EQ(prefilter({ "" }, { "/admin" }).verdict("/admin"), RobotsTxtPathPrefilter::VerdictAllowed);
+    EXPECT_EQ(prefilter({ "/" }).verdict("/admin"), RobotsTxtPathPrefilter::VerdictDisallowed);
+    EXPECT_EQ(prefilter({ "*", "/admin" }).verdict("/"), RobotsTxtPathPrefilter::VerdictDisallowed);
+    EXPECT_EQ(prefilter({ "/*" }).verdict("admin"), RobotsTxtPathPrefilter::VerdictUnknown);
+    EXPECT_EQ(prefilter({ "/" }, { "/public" }).verdict("/admin"), RobotsTxtPathPrefilter::VerdictUnknown);
+
+    // the verdicts taken from the prefilters agree with the rules
+    const RobotsTxtRules rules(
+        "User-agent: *\n"
+        "Disallow: /Admin\n"
+        "Disallow: /s\n"
+        "\n"
+        "User-agent: Googlebot\n"
+        "Disallow: /\n"
+        "\n"
+        "User-agent: Yandex\n"
+        "Allow: /\n"
+        "\n"
+        "User-agent: msnbot\n"
+        "Disallow: /\n"
+        "Allow: /public\n"
+    );
+
+    EXPECT_EQ(rules.isPathAllowed("/catalog", WellKnownUserAgent::AllRobots), true);
+    EXPECT_EQ(rules.isPathAllowed("/aDMIN/users", WellKnownUserAgent::AllRobots), false);
+    EXPECT_EQ(rules.isPathAllowed("/S", WellKnownUserAgent::AllRobots), false);
+    EXPECT_EQ(rules.isPathAllowed("/catalog", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/robots.txt", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/catalog", WellKnownUserAgent::YandexBot), true);
+    EXPECT_EQ(rules.isPathAllowed("/catalog", WellKnownUserAgent::MsnBot), false);
+    EXPECT_EQ(rules.isPathAllowed("/public/page", WellKnownUserAgent::MsnBot), true);
+
+    for (const std::string path : { "/", "/catalog", "/admin", "/s", "/public", "/robots.txt" })
+    {
+        const UserAgentVerdicts verdicts = rules.pathVerdicts(path);
+
+        for (WellKnownUserAgent userAgent : MetaRobotsHelpers::wellKnownUserAgents())
+        {
+            EXPECT_EQ(verdicts.isAllowed(userAgent), rules.isPathAllowed(path, userAgent)) << path << " " << static_cast<int>(userAgent);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,213 @@
+﻿#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "politeness_scheduler.h"
+#include "robots_txt_rules.h"
+#include "well_known_user_agent.h"
+
+using namespace cpprobotparser;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+//! the clock moved by the test
+struct ManualClock
+{
+    PolitenessScheduler::Clock::time_point time = PolitenessScheduler::Clock::time_point(1h);
+
+    std::function<PolitenessScheduler::Clock::time_point()> function()
+    {
+        return [this] { return time; };
+    }
+};
+
+std::vector<std::string> takeReadyHosts(PolitenessScheduler& scheduler, std::size_t maxHosts = 100)
+{
+    std::vector<std::string> hosts;
+    scheduler.readyHosts(hosts, maxHosts);
+    std::sort(hosts.begin(), hosts.end());
+
+    return hosts;
+}
+
+}
+
+TEST(SchedulerTests, FetchInterval)
+{
+    const RobotsTxtRules rules(
+        "User-agent: Googlebot\n"
+        "Crawl-delay: 2.5\n"
+        "\n"
+        "User-agent: Yandex\n"
+        "Crawl-delay: 1\n"
+        "Request-rate: 10/1m\n"
+        "\n"
+        "User-agent: msnbot\n"
+        "Request-rate: 1/5\n"
+        "Request-rate: 3/1h 0600-0845\n"
+        "\n"
+        "User-agent: slurp\n"
+        "Crawl-delay: soon\n"
+        "Request-rate: 0/5\n"
+        "\n"
+        "User-agent: *\n"
+        "Disallow: /private\n"
+    );
+
+    EXPECT_EQ(rules.fetchInterval(WellKnownUserAgent::GoogleBot), 2500ms);
+    EXPECT_EQ(rules.fetchInterval(WellKnownUserAgent::YandexBot), 6000ms);
+    EXPECT_EQ(rules.fetchInterval(WellKnownUserAgent::MsnBot), 1200s);
+    EXPECT_EQ(rules.fetchInterval(WellKnownUserAgent::YahooBot), 0ms);
+    EXPECT_EQ(rules.fetchInterval(WellKnownUserAgent::MailRuBot), 0ms);
+    EXPECT_EQ(rules.fetchInterval("googlebot"), 2500ms);
+}
+
+TEST(SchedulerTests, ReadyHosts)
+{
+    ManualClock clock;
+
+    PolitenessScheduler::Settings settings;
+    settings.minDelay = 1s;
+    settings.tickDuration = 10ms;
+    settings.wheelSize = 16;
+    settings.shardCount = 4;
+    settings.now = clock.function();
+
+    PolitenessScheduler scheduler(settings);
+
+    const RobotsTxtRules rules("User-agent: *\nCrawl-delay: 3\n");
+    scheduler.setDelay("http://a.com:80", rules, rules.resolveGroup(WellKnownUserAgent::AllRobots));
+    scheduler.schedule("http://a.com:80");
+    scheduler.schedule("http://b.com:80");
+    scheduler.schedule("http://b.com:80");
+
+    EXPECT_EQ(scheduler.size(), 2);
+
+    // the new hosts may be fetched right away, every host is returned once per fetch
+    EXPECT_EQ(takeReadyHosts(scheduler), std::vector<std::string>({ "http://a.com:80", "http://b.com:80" }));
+    EXPECT_EQ(takeReadyHosts(scheduler).empty(), true);
+
+    scheduler.schedule("http://a.com:80");
+    scheduler.schedule("http://b.com:80");
+
+    EXPECT_EQ(scheduler.nextFetchTime("http://a.com:80"), clock.time + 3s);
+    EXPECT_EQ(scheduler.nextFetchTime("http://b.com:80"), clock.time + 1s);
+    EXPECT_EQ(scheduler.nextFetchTime("http://unknown.com:80"), clock.time);
+
+    clock.time += 999ms;
+    EXPECT_EQ(takeReadyHosts(scheduler).empty(), true);
+
+    clock.time += 1ms;
+    EXPECT_EQ(takeReadyHosts(scheduler), std::vector<std::string>({ "http://b.com:80" }));
+
+    // the delay of a.com is longer than the wheel turn
+    clock.time += 1999ms;
+    EXPECT_EQ(takeReadyHosts(scheduler).empty(), true);
+
+    clock.time += 1ms;
+    EXPECT_EQ(takeReadyHosts(scheduler), std::vector<std::string>({ "http://a.com:80" }));
+
+    // the scheduler isn't called for many wheel turns
+    scheduler.schedule("http://a.com:80");
+    scheduler.schedule("http://b.com:80");
+    clock.time += 1h;
+
+    EXPECT_EQ(takeReadyHosts(scheduler, 1).size(), 1);
+    EXPECT_EQ(takeReadyHosts(scheduler, 1).size(), 1);
+    EXPECT_EQ(takeReadyHosts(scheduler, 1).empty(), true);
+}
+
+TEST(SchedulerTests, EraseHosts)
+{
+    ManualClock clock;
+
+    PolitenessScheduler::Settings settings;
+    settings.shardCount = 1;
+    settings.now = clock.function();
+
+    PolitenessScheduler scheduler(settings);
+
+    scheduler.setDelay("waiting.com", 1h);
+    scheduler.schedule("ready.com");
+    scheduler.schedule("waiting.com");
+    takeReadyHosts(scheduler);
+
+    scheduler.schedule("ready.com");
+    scheduler.schedule("waiting.com");
+    scheduler.schedule("idle.com");
+    clock.time += 1s;
+
+    // idle.com is taken, ready.com stays in the ready queue, waiting.com stays on the wheel
+    EXPECT_EQ(takeReadyHosts(scheduler, 1), std::vector<std::string>({ "idle.com" }));
+
+    scheduler.erase("ready.com");
+    scheduler.erase("waiting.com");
+    scheduler.erase("idle.com");
+    scheduler.erase("unknown.com");
+
+    EXPECT_EQ(scheduler.size(), 0);
+
+    clock.time += 1h;
+    EXPECT_EQ(takeReadyHosts(scheduler).empty(), true);
+
+    // the erased host is a new one
+    scheduler.schedule("waiting.com");
+    EXPECT_EQ(takeReadyHosts(scheduler), std::vector<std::string>({ "waiting.com" }));
+}
+
+TEST(SchedulerTests, NeverEarly)
+{
+    ManualClock clock;
+
+    PolitenessScheduler::Settings settings;
+    settings.minDelay = 0ms;
+    settings.tickDuration = 10ms;
+    settings.wheelSize = 64;
+    settings.now = clock.function();
+
+    PolitenessScheduler scheduler(settings);
+    std::mt19937 generator(2024);
+    std::unordered_map<std::string, PolitenessScheduler::Clock::time_point> lastFetchTimes;
+    std::unordered_map<std::string, PolitenessScheduler::Clock::duration> delays;
+
+    for (int i = 0; i < 200; ++i)
+    {
+        const std::string host = "host" + std::to_string(i) + ".com";
+        const PolitenessScheduler::Clock::duration delay = std::chrono::milliseconds(generator() % 3000);
+
+        delays[host] = delay;
+        scheduler.setDelay(host, delay);
+        scheduler.schedule(host);
+    }
+
+    for (int step = 0; step < 1000; ++step)
+    {
+        clock.time += std::chrono::milliseconds(1 + generator() % 15);
+
+        std::vector<std::string> hosts;
+        scheduler.readyHosts(hosts, 1000);
+
+        for (const std::string& host : hosts)
+        {
+            const auto lastFetchIterator = lastFetchTimes.find(host);
+
+            if (lastFetchIterator != lastFetchTimes.end())
+            {
+                // polled at most 15ms apart: not earlier than allowed and at most a tick and a poll late
+                EXPECT_GE(clock.time - lastFetchIterator->second, delays[host]) << host;
+                EXPECT_LT(clock.time - lastFetchIterator->second, delays[host] + 25ms) << host;
+            }
+
+            lastFetchTimes[host] = clock.time;
+            scheduler.schedule(host);
+        }
+    }
+
+    EXPECT_EQ(lastFetchTimes.size(), 200);
+}
\ No newline at end of file
@@ -0,0 +1,237 @@
+﻿#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "robots_txt_rules.h"
+#include "robots_txt_store.h"
+#include "temporary_path.h"
+#include "well_known_user_agent.h"
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+const char* const s_words[] = { "a", "b", "folder", "page", "images", "search", "id", "Tmp", "html", "php" };
+
+std::string randomPath(std::mt19937& random)
+{
+    std::string path;
+    const std::size_t depth = 1 + random() % 4;
+
+    for (std::size_t i = 0; i < depth; ++i)
+    {
+        path += "/";
+        path += s_words[random() % std::size(s_words)];
+    }
+
+    if (random() % 3 == 0)
+    {
+        path += random() % 2 ? ".html" : "/?id=1";
+    }
+
+    return path;
+}
+
+std::string randomRobotsTxt(std::mt19937& random)
+{
+    const char* const userAgents[] = { "*", "Googlebot", "Yandex", "MSNBot", "OurBot/2.1" };
+    const char* const suffixes[] = { "", "", "*", "$", "*.php", "*/", "*?id=" };
+    std::string robotsTxt;
+
+    for (const char* userAgent : userAgents)
+    {
+        if (random() % 4 == 0)
+        {
+            continue;
+        }
+
+        robotsTxt += std::string("User-agent: ") + userAgent + "\n";
+
+        for (std::size_t i = random() % 12; i > 0; --i)
+        {
+            robotsTxt += random() % 2 ? "Allow: " : "Disallow: ";
+            robotsTxt += randomPath(random) + suffixes[random() % std::size(suffixes)] + "\n";
+        }
+
+        robotsTxt += "Crawl-delay: 1\n\n";
+    }
+
+    return robotsTxt;
+}
+
+}
+
+TEST(StoreTests, StoredRobotsTxt)
+{
+    const RobotsTxtRules rules(
+        "User-agent: *\n"
+        "Disallow: /private\n"
+        "Allow: /private/public$\n"
+        "Disallow: /*.php\n"
+        "\n"
+        "User-agent: Googlebot\n"
+        "Crawl-delay: 5\n"
+        "\n"
+        "User-agent: Yandex\n"
+        "Disallow: /\n"
+        "Allow: /yandex\n"
+    );
+
+    RobotsTxtStoreWriter writer;
+    writer.add("http://example.com:80", RobotsTxtRules("User-agent: *\nDisallow: /"));
+    writer.add("http://example.com:80", rules);
+    writer.add("http://empty.com:80", RobotsTxtRules());
+
+    EXPECT_EQ(writer.size(), 2);
+
+    const TemporaryPath file("stored_robots_txt.store");
+    writer.write(file.path().string());
+
+    const RobotsTxtStore store(file.path().string());
+    const RobotsTxtStoredRules storedRules = store.find("http://example.com:80");
+
+    EXPECT_EQ(store.size(), 2);
+    EXPECT_EQ(static_cast<bool>(storedRules), true);
+    EXPECT_EQ(static_cast<bool>(store.find("http://example.org:80")), false);
+    EXPECT_EQ(static_cast<bool>(store.find("http://empty.com:80")), true);
+
+    // Googlebot has no own Allow/Disallow rules, so the rules for all robots are applied
+    EXPECT_EQ(storedRules.isUrlAllowed("http://example.com/private", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(storedRules.isUrlAllowed("http://example.com/private/public", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(storedRules.isUrlAllowed("http://example.com/private/public/1", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(storedRules.isUrlAllowed("http://example.com/index.php?a=1", WellKnownUserAgent::GoogleBot), false);
+    EXPECT_EQ(storedRules.isUrlAllowed("http://example.com/index.html", WellKnownUserAgent::GoogleBot), true);
+
+    EXPECT_EQ(storedRules.isPathAllowed("/index.html", WellKnownUserAgent::YandexBot), false);
+    EXPECT_EQ(storedRules.isPathAllowed("/yandex/page", WellKnownUserAgent::YandexBot), true);
+
+    EXPECT_EQ(store.find("http://empty.com:80").isPathAllowed("/private", WellKnownUserAgent::GoogleBot), true);
+    EXPECT_EQ(RobotsTxtStoredRules().isPathAllowed("/private", WellKnownUserAgent::GoogleBot), true);
+}
+
+TEST(StoreTests, StoredVerdictsRobotsTxt)
+{
+    const WellKnownUserAgent userAgents[] =
+    {
+        WellKnownUserAgent::AllRobots,
+        WellKnownUserAgent::GoogleBot,
+        WellKnownUserAgent::YandexBot,
+        WellKnownUserAgent::MsnBot,
+        WellKnownUserAgent::YahooBot
+    };
+
+    // the user agent names are matched by the product token case insensitively
+    const std::string customUserAgents[] = { "OurBot", "OURBOT", "ourbot/3.0", "OtherBot", "GOOGLEBOT", "*" };
+
+    constexpr std::size_t hostCount = 300;
+
+    std::mt19937 random(2018);
+    std::vector<RobotsTxtRules> hostRules;
+    RobotsTxtStoreWriter writer;
+
+    for (std::size_t i = 0; i < hostCount; ++i)
+    {
+        hostRules.emplace_back(randomRobotsTxt(random));
+        writer.add("http://host" + std::to_string(i) + ".com:80", hostRules.back());
+    }
+
+    const TemporaryPath file("stored_verdicts_robots_txt.store");
+    writer.write(file.path().string());
+
+    RobotsTxtStore store(file.path().string());
+    const RobotsTxtStore movedStore(std::move(store));
+
+    for (std::size_t i = 0; i < hostCount; ++i)
+    {
+        const RobotsTxtStoredRules storedRules = movedStore.find("http://host" + std::to_string(i) + ".com:80");
+
+        GTEST_ASSERT_EQ(static_cast<bool>(storedRules), true);
+
+        for (std::size_t j = 0; j < 50; ++j)
+        {
+            const std::string path = randomPath(random);
+            const WellKnownUserAgent userAgent = userAgents[random() % std::size(userAgents)];
+            const std::string& customUserAgent = customUserAgents[random() % std::size(customUserAgents)];
+
+            EXPECT_EQ(storedRules.isPathAllowed(path, userAgent), hostRules[i].isPathAllowed(path, userAgent)) << path;
+            EXPECT_EQ(storedRules.isPathAllowed(path, customUserAgent), hostRules[i].isPathAllowed(path, customUserAgent)) << path << " " << customUserAgent;
+        }
+    }
+}
+
+TEST(StoreTests, InvalidStoreRobotsTxt)
+{
+    EXPECT_THROW(RobotsTxtStore("missing.store"), std::runtime_error);
+
+    const TemporaryPath file("invalid_robots_txt.store");
+
+    {
+        std::ofstream invalidFile(file.path(), std::ios::binary);
+        invalidFile << "User-agent: *\nDisallow: /\n";
+    }
+
+    EXPECT_THROW(RobotsTxtStore(file.path().string()), std::runtime_error);
+}
+
+TEST(StoreTests, TruncatedStoreRobotsTxt)
+{
+    RobotsTxtStoreWriter writer;
+    writer.add("http://example.com:80", RobotsTxtRules("User-agent: *\nDisallow: /private\nAllow: /private/*.html$\n"));
+
+    const TemporaryPath file("truncated_robots_txt.store");
+    writer.write(file.path().string());
+
+    std::string content;
+
+    {
+        std::ifstream storeFile(file.path(), std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(storeFile), std::istreambuf_iterator<char>());
+    }
+
+    const auto writeStore = [&file](const std::string& storeContent)
+    {
+        std::ofstream storeFile(file.path(), std::ios::binary | std::ios::trunc);
+        storeFile.write(storeContent.data(), static_cast<std::streamsize>(storeContent.size()));
+    };
+
+    const auto patchedStore = [&content](std::size_t offset, std::uint64_t value, std::size_t size)
+    {
+        std::string patched = content;
+        std::memcpy(patched.data() + offset, &value, size);
+        return patched;
+    };
+
+    writeStore(content);
+    EXPECT_EQ(RobotsTxtStore(file.path().string()).size(), 1);
+
+    for (std::size_t size = 0; size < content.size(); size += 8)
+    {
+        writeStore(content.substr(0, size));
+        EXPECT_THROW(RobotsTxtStore(file.path().string()), std::runtime_error) << size;
+    }
+
+    // the host table ends the file, the origin record of the only host starts right after the 32 bytes header,
+    // the group records follow the 8 bytes header of the origin record
+    const std::size_t hostEntryOffset = content.size() - 32;
+    const std::size_t groupRecordOffset = 32 + 8;
+
+    // the origin offset, the origin record offset
+    writeStore(patchedStore(hostEntryOffset + 8, content.size(), 8));
+    EXPECT_THROW(RobotsTxtStore(file.path().string()), std::runtime_error);
+    writeStore(patchedStore(hostEntryOffset + 16, content.size() - 8, 8));
+    EXPECT_THROW(RobotsTxtStore(file.path().string()), std::runtime_error);
+
+    // the group count, the rule count and the node count of the group
+    writeStore(patchedStore(32, 1000, 4));
+    EXPECT_THROW(RobotsTxtStore(file.path().string()), std::runtime_error);
+    writeStore(patchedStore(groupRecordOffset + 12, 1000, 4));
+    EXPECT_THROW(RobotsTxtStore(file.path().string()), std::runtime_error);
+    writeStore(patchedStore(groupRecordOffset + 28, 1000, 4));
+    EXPECT_THROW(RobotsTxtStore(file.path().string()), std::runtime_error);
+}
\ No newline at end of file
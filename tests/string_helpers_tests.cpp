@@ -0,0 +1,88 @@
+﻿#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include "ascii_kernels.h"
+#include "string_helpers.h"
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+char referenceToLower(char ch)
+{
+    return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+std::string referenceLowercased(std::string_view source)
+{
+    std::string result(source);
+
+    for (char& ch : result)
+    {
+        ch = referenceToLower(ch);
+    }
+
+    return result;
+}
+
+std::size_t referenceFind(std::string_view source, std::string_view lowercaseSubstring, std::size_t from)
+{
+    return referenceLowercased(source).find(lowercaseSubstring, from);
+}
+
+// the small alphabet makes the partial matches frequent, the non-ASCII bytes must be kept as is
+std::string randomString(std::mt19937& random, std::size_t size)
+{
+    const char alphabet[] = { 'a', 'A', 'b', 'B', 'z', 'Z', '/', '@', '[', '`', '{', '\x80', '\xC1', '\xE1' };
+    std::string result;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        result += alphabet[random() % sizeof(alphabet)];
+    }
+
+    return result;
+}
+
+}
+
+TEST(StringHelpersTests, AsciiKernels)
+{
+    const AsciiKernels::InstructionSet detectedInstructionSet = AsciiKernels::instructionSet();
+
+    for (AsciiKernels::InstructionSet instructionSet : { AsciiKernels::InstructionSet::Scalar, AsciiKernels::InstructionSet::Sse2, AsciiKernels::InstructionSet::Avx2 })
+    {
+        if (!AsciiKernels::setInstructionSet(instructionSet))
+        {
+            EXPECT_EQ(AsciiKernels::isSupported(instructionSet), false);
+            continue;
+        }
+
+        std::mt19937 random(2018);
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            const std::string source = randomString(random, random() % 100);
+            const std::string substring = referenceLowercased(randomString(random, 1 + random() % 4));
+            const std::size_t from = random() % (source.size() + 2);
+
+            EXPECT_EQ(StringHelpers::asciiLowercased(source), referenceLowercased(source));
+            EXPECT_EQ(StringHelpers::findLowercase(source, substring, from), referenceFind(source, substring, from));
+            EXPECT_EQ(StringHelpers::equalsLowercase(source, referenceLowercased(source)), true);
+
+            const std::string prefix = referenceLowercased(source.substr(0, random() % (source.size() + 1)));
+            EXPECT_EQ(StringHelpers::startsWithLowercase(source, prefix), true);
+            EXPECT_EQ(StringHelpers::startsWithLowercase(source, prefix + "?"), referenceLowercased(source).find(prefix + "?") == 0);
+        }
+    }
+
+    AsciiKernels::setInstructionSet(detectedInstructionSet);
+
+    std::string mixedCase = "/Path/To/UPPER_case.HTML?Query=ÄÖ";
+    StringHelpers::toLower(mixedCase);
+
+    EXPECT_EQ(mixedCase, "/path/to/upper_case.html?query=ÄÖ");
+    EXPECT_EQ(StringHelpers::findLowercase("/A/b/C/d/E/f/G/h/I/j/K/l/M/n/O/p/Q/r/S/t/U/v/W/x/Y/z", "y/z"), 49);
+}
\ No newline at end of file
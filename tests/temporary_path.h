@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace cpprobotparser
+{
+
+//! Unique path in the temporary directory, removes the file or the directory with its files when the test ends
+class TemporaryPath final
+{
+public:
+    explicit TemporaryPath(const std::string& name)
+        : m_path(std::filesystem::temp_directory_path() / (name + "." + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+    {
+    }
+
+    ~TemporaryPath()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    TemporaryPath(const TemporaryPath&) = delete;
+    TemporaryPath& operator=(const TemporaryPath&) = delete;
+
+    const std::filesystem::path& path() const noexcept
+    {
+        return m_path;
+    }
+
+private:
+    std::filesystem::path m_path;
+};
+
+}
\ No newline at end of file
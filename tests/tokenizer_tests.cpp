@@ -3,6 +3,7 @@
 #include <vector>
 #include "robots_txt_token.h"
 #include "robots_txt_tokenizer.h"
+#include "user_agent_registry.h"
 #include "well_known_user_agent.h"
 
 using namespace cpprobotparser;
@@ -86,4 +87,237 @@ TEST(TokenizerTests, ParseAllowTokens)
     {
         EXPECT_NE(std::find(googleAllowTokens.begin(), googleAllowTokens.end(), allowToken), googleAllowTokens.end());
     }
+}
+
+TEST(TokenizerTests, ParseStringView)
+{
+    const std::string buffer =
+        "garbage before the file|"
+        "User-agent: Yandex # commentary\r\n"
+        "# commentary only row\n\r"
+        "   \r"
+        "DISALLOW : /Private#commentary\n"
+        "Allow:/private/public\r"
+        "|garbage after the file";
+
+    const std::size_t begin = buffer.find('|') + 1;
+    const std::size_t end = buffer.rfind('|');
+
+    RobotsTxtTokenizer tokenizer(std::string_view(buffer).substr(begin, end - begin));
+
+    const std::vector<std::string> disallowTokens =
+        tokenizer.tokenValues(WellKnownUserAgent::YandexBot, RobotsTxtToken::TokenDisallow);
+
+    const std::vector<std::string> allowTokens =
+        tokenizer.tokenValues(WellKnownUserAgent::YandexBot, RobotsTxtToken::TokenAllow);
+
+    EXPECT_EQ(tokenizer.isValid(), true);
+    GTEST_ASSERT_EQ(disallowTokens.size(), 1);
+    GTEST_ASSERT_EQ(allowTokens.size(), 1);
+    EXPECT_EQ(disallowTokens.front(), std::string_view("/private"));
+    EXPECT_EQ(allowTokens.front(), std::string_view("/private/public"));
+}
+
+TEST(TokenizerTests, RepeatedTokenize)
+{
+    RobotsTxtTokenizer tokenizer("Sitemap: http://a.com/sitemap.xml\nUser-agent: Yandex\nDisallow: /first");
+    tokenizer.tokenize("User-agent: Googlebot\nDisallow: /second");
+
+    EXPECT_EQ(tokenizer.isValid(), true);
+    EXPECT_EQ(tokenizer.hasUserAgentRecord(WellKnownUserAgent::YandexBot), false);
+    EXPECT_EQ(tokenizer.sitemapUrl().empty(), true);
+    EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::GoogleBot, RobotsTxtToken::TokenDisallow), std::vector<std::string>{ "/second" });
+}
+
+TEST(TokenizerTests, IncrementalTokenize)
+{
+    const std::string robotsTxt =
+        "Sitemap: http://a.com/sitemap.xml\r\n"
+        "User-agent: Yandex # commentary\n\r"
+        "Disallow: /private\r"
+        "\r\n"
+        "Allow: /private/public\n"
+        "User-agent: Googlebot\r\n"
+        "Disallow: /search";
+
+    const auto disallowTokens = [](const RobotsTxtTokenizer& tokenizer, WellKnownUserAgent userAgent)
+    {
+        return tokenizer.tokenValues(userAgent, RobotsTxtToken::TokenDisallow);
+    };
+
+    const RobotsTxtTokenizer expected(robotsTxt);
+
+    for (std::size_t chunkSize = 1; chunkSize <= robotsTxt.size(); ++chunkSize)
+    {
+        RobotsTxtTokenizer tokenizer;
+
+        for (std::size_t position = 0; position < robotsTxt.size(); position += chunkSize)
+        {
+            tokenizer.feed(std::string_view(robotsTxt).substr(position, chunkSize));
+        }
+
+        tokenizer.finish();
+
+        EXPECT_EQ(tokenizer.isValid(), true);
+        EXPECT_EQ(tokenizer.isTruncated(), false);
+        EXPECT_EQ(tokenizer.sitemapUrl(), expected.sitemapUrl());
+        EXPECT_EQ(disallowTokens(tokenizer, WellKnownUserAgent::YandexBot), disallowTokens(expected, WellKnownUserAgent::YandexBot));
+        EXPECT_EQ(disallowTokens(tokenizer, WellKnownUserAgent::GoogleBot), disallowTokens(expected, WellKnownUserAgent::GoogleBot));
+        EXPECT_EQ(
+            tokenizer.tokenValues(WellKnownUserAgent::YandexBot, RobotsTxtToken::TokenAllow),
+            expected.tokenValues(WellKnownUserAgent::YandexBot, RobotsTxtToken::TokenAllow)
+        );
+    }
+}
+
+TEST(TokenizerTests, MaxContentSize)
+{
+    const std::string robotsTxt = "User-agent: *\nDisallow: /first\nDisallow: /second\nDisallow: /third\n";
+
+    RobotsTxtTokenizer tokenizer;
+
+    // the limit falls in the middle of the "Disallow: /second" row
+    tokenizer.setMaxContentSize(robotsTxt.find("/second") + 3);
+    tokenizer.feed(std::string_view(robotsTxt).substr(0, 20));
+    tokenizer.feed(std::string_view(robotsTxt).substr(20));
+    tokenizer.feed("Disallow: /fourth\n");
+    tokenizer.finish();
+
+    EXPECT_EQ(tokenizer.isValid(), true);
+    EXPECT_EQ(tokenizer.isTruncated(), true);
+    EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::AllRobots, RobotsTxtToken::TokenDisallow), std::vector<std::string>{ "/first" });
+
+    // the limit falls right on the row delimeter
+    tokenizer.setMaxContentSize(robotsTxt.find("/second") + 7);
+    tokenizer.tokenize(robotsTxt);
+
+    EXPECT_EQ(tokenizer.isTruncated(), true);
+    EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::AllRobots, RobotsTxtToken::TokenDisallow), (std::vector<std::string>{ "/first", "/second" }));
+
+    tokenizer.setMaxContentSize(RobotsTxtTokenizer::rfc9309MaxContentSize);
+    tokenizer.tokenize(robotsTxt);
+
+    EXPECT_EQ(tokenizer.isTruncated(), false);
+    EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::AllRobots, RobotsTxtToken::TokenDisallow).size(), 3);
+}
+
+TEST(TokenizerTests, MemoryUsage)
+{
+    std::string robotsTxt = "User-agent: Googlebot\nUser-agent: *\n";
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        robotsTxt += "Disallow: /Folder" + std::to_string(i) + "/\n";
+    }
+
+    const RobotsTxtTokenizer emptyTokenizer;
+    const RobotsTxtTokenizer tokenizer(robotsTxt);
+    const std::vector<std::string> values = tokenizer.tokenValues(WellKnownUserAgent::AllRobots, RobotsTxtToken::TokenDisallow);
+
+    std::size_t valuesSize = 0;
+
+    for (const std::string& value : values)
+    {
+        valuesSize += value.size();
+    }
+
+    EXPECT_EQ(values.size(), 1000);
+    EXPECT_EQ(values.back(), "/folder999/");
+
+    // the values are kept in one arena and the directive table takes a few bytes per row
+    EXPECT_GT(tokenizer.memoryUsage(), emptyTokenizer.memoryUsage() + valuesSize);
+    EXPECT_LT(tokenizer.memoryUsage(), emptyTokenizer.memoryUsage() + 2 * robotsTxt.size());
+}
+
+TEST(TokenizerTests, UserAgentRegistry)
+{
+    UserAgentRegistry registry;
+
+    EXPECT_EQ(registry.intern("OurBot"), 0);
+    EXPECT_EQ(registry.intern("googlebot"), 1);
+    EXPECT_EQ(registry.intern("OURBOT"), 0);
+    EXPECT_EQ(registry.find("ourBot"), 0);
+    EXPECT_EQ(registry.find("ourbot2"), UserAgentRegistry::npos);
+    EXPECT_EQ(registry.name(0), "ourbot");
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        registry.intern("bot" + std::to_string(i));
+    }
+
+    EXPECT_EQ(registry.size(), 1002);
+    EXPECT_EQ(registry.find("BOT999"), 1001);
+    EXPECT_EQ(registry.find("googlebot"), 1);
+
+    // the versions are skipped, the longest token wins and the unknown tokens fall back to the prefix before '-'
+    EXPECT_EQ(registry.match("Mozilla/5.0 (compatible; OurBot/2.1; +https://our.site/bot)"), 0);
+    EXPECT_EQ(registry.match("Mozilla/5.0 (compatible; Googlebot-Image/1.0)"), 1);
+    EXPECT_EQ(registry.match("bot1/ourbot googlebot ourbot"), 1);
+    EXPECT_EQ(registry.match("curl/8.0"), UserAgentRegistry::npos);
+    EXPECT_EQ(registry.match(""), UserAgentRegistry::npos);
+
+    EXPECT_EQ(UserAgentRegistry::productToken(" OurBot/2.1 "), "OurBot");
+    EXPECT_EQ(UserAgentRegistry::productToken("*"), "*");
+    EXPECT_EQ(UserAgentRegistry::productToken("mail.ru"), "mail.ru");
+    EXPECT_EQ(UserAgentRegistry::productToken("/"), "");
+
+    registry.clear();
+    EXPECT_EQ(registry.size(), 0);
+    EXPECT_EQ(registry.find("ourbot"), UserAgentRegistry::npos);
+}
+
+TEST(TokenizerTests, ArbitraryUserAgents)
+{
+    const RobotsTxtTokenizer tokenizer(
+        "User-agent: OurBot/2.1\n"
+        "Disallow: /private\n"
+        "User-agent: robots\n"
+        "Disallow: /all\n"
+        "User-agent: /\n"
+        "Disallow: /nobody\n"
+    );
+
+    const UserAgentRegistry& userAgents = tokenizer.userAgents();
+
+    GTEST_ASSERT_EQ(userAgents.size(), 2);
+    EXPECT_EQ(userAgents.name(0), "ourbot");
+    EXPECT_EQ(userAgents.name(1), "*");
+    EXPECT_EQ(tokenizer.hasUserAgentRecord("ourbot"), true);
+    EXPECT_EQ(tokenizer.tokenValues("ourbot", RobotsTxtToken::TokenDisallow), std::vector<std::string>{ "/private" });
+    EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::AllRobots, RobotsTxtToken::TokenDisallow), std::vector<std::string>{ "/all" });
+}
+
+TEST(TokenizerTests, MultiAgentGroup)
+{
+    const std::string robotsTxt =
+        "Sitemap: http://a.com/sitemap.xml\n"
+        "User-agent: OurBot\n"
+        "User-agent: Googlebot\n"
+        "User-agent: ourbot/2.0\n"
+        "Disallow: /a\n"
+        "Sitemap: http://a.com/other.xml\n"
+        "Allow: /a/b\n"
+        "User-agent: Yandex\n"
+        "Disallow: /c\n";
+
+    // the consecutive User-agent rows form one group, the directives of the group belong to every user agent of it
+    for (std::size_t chunkSize = 1; chunkSize <= robotsTxt.size(); ++chunkSize)
+    {
+        RobotsTxtTokenizer tokenizer;
+
+        for (std::size_t position = 0; position < robotsTxt.size(); position += chunkSize)
+        {
+            tokenizer.feed(std::string_view(robotsTxt).substr(position, chunkSize));
+        }
+
+        tokenizer.finish();
+
+        GTEST_ASSERT_EQ(tokenizer.userAgents().size(), 3);
+        EXPECT_EQ(tokenizer.tokenValues("ourbot", RobotsTxtToken::TokenDisallow), std::vector<std::string>{ "/a" });
+        EXPECT_EQ(tokenizer.tokenValues("ourbot", RobotsTxtToken::TokenAllow), std::vector<std::string>{ "/a/b" });
+        EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::GoogleBot, RobotsTxtToken::TokenDisallow), std::vector<std::string>{ "/a" });
+        EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::GoogleBot, RobotsTxtToken::TokenAllow), std::vector<std::string>{ "/a/b" });
+        EXPECT_EQ(tokenizer.tokenValues(WellKnownUserAgent::YandexBot, RobotsTxtToken::TokenDisallow), std::vector<std::string>{ "/c" });
+        EXPECT_EQ(tokenizer.hasUserAgentRecord(WellKnownUserAgent::AllRobots), false);
+    }
 }
\ No newline at end of file
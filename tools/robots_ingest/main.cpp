@@ -0,0 +1,253 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "robots_txt_bulk_loader.h"
+#include "robots_txt_cache.h"
+#include "robots_txt_store.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+const char s_usage[] =
+    "Parses an archive or a directory of robots.txt files in parallel and reports the throughput.\n"
+    "\n"
+    "Usage: robots_ingest --input <file or directory> [options]\n"
+    "\n"
+    "  --input <path>           WARC-like archive of robots.txt responses or directory of files named after their hosts, e.g. example.com.txt\n"
+    "  --threads <n,n,...>      thread counts to parse with, 1,2,4,.. up to the number of cores by default\n"
+    "  --max-pending <n>        maximum number of records read but not parsed yet, 16384 by default\n"
+    "  --store <file>           writes the parsed rules into the store file read by RobotsTxtStore\n";
+
+struct Options
+{
+    std::string inputPath;
+    std::string storePath;
+    std::vector<unsigned> threadCounts;
+    std::size_t maxPendingRecords = RobotsTxtBulkLoader::Settings().maxPendingRecords;
+};
+
+unsigned parseUnsigned(const std::string& value)
+{
+    std::size_t end = 0;
+    const unsigned long result = std::stoul(value, &end);
+
+    if (end != value.size() || result == 0)
+    {
+        throw std::invalid_argument("Expected a positive number instead of '" + value + "'");
+    }
+
+    return static_cast<unsigned>(result);
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+
+        if (i + 1 == argc)
+        {
+            throw std::invalid_argument("No value for " + argument);
+        }
+
+        const std::string value = argv[++i];
+
+        if (argument == "--input")
+        {
+            options.inputPath = value;
+        }
+        else if (argument == "--store")
+        {
+            options.storePath = value;
+        }
+        else if (argument == "--max-pending")
+        {
+            options.maxPendingRecords = parseUnsigned(value);
+        }
+        else if (argument == "--threads")
+        {
+            std::size_t position = 0;
+
+            while (position <= value.size())
+            {
+                const std::size_t end = std::min(value.find(',', position), value.size());
+                options.threadCounts.push_back(parseUnsigned(value.substr(position, end - position)));
+                position = end + 1;
+            }
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown option " + argument);
+        }
+    }
+
+    if (options.inputPath.empty())
+    {
+        throw std::invalid_argument("--input is required");
+    }
+
+    if (options.threadCounts.empty())
+    {
+        const unsigned coreCount = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned threadCount = 1; threadCount < coreCount; threadCount *= 2)
+        {
+            options.threadCounts.push_back(threadCount);
+        }
+
+        options.threadCounts.push_back(coreCount);
+    }
+
+    return options;
+}
+
+// the peak resident set size of the process in bytes
+std::size_t peakResidentSetSize()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double toMiB(std::size_t bytes)
+{
+    return static_cast<double>(bytes) / (1024 * 1024);
+}
+
+RobotsTxtBulkLoader::Settings loaderSettings(const Options& options, unsigned threadCount)
+{
+    RobotsTxtBulkLoader::Settings settings;
+    settings.threadCount = threadCount;
+    settings.maxPendingRecords = options.maxPendingRecords;
+
+    return settings;
+}
+
+// every run parses into the empty cache, so the runs with the different thread counts do the same work
+// the speedup is relative to the first run
+void reportThroughput(const Options& options)
+{
+    std::printf("%8s %12s %12s %10s %10s %10s %10s %10s %12s\n", "threads", "files", "files/s", "MiB/s", "speedup", "skipped", "failed", "stolen", "rules MiB");
+
+    double firstRunSeconds = 0;
+
+    for (const unsigned threadCount : options.threadCounts)
+    {
+        RobotsTxtCache::Settings cacheSettings;
+        cacheSettings.maxEntries = std::numeric_limits<std::size_t>::max();
+        cacheSettings.maxBytes = std::numeric_limits<std::size_t>::max();
+
+        RobotsTxtCache cache(cacheSettings);
+        const RobotsTxtBulkLoader loader(loaderSettings(options, threadCount));
+
+        const auto start = std::chrono::steady_clock::now();
+        const RobotsTxtBulkLoader::Statistics statistics = loader.load(options.inputPath, cache, std::chrono::hours(24));
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        firstRunSeconds = firstRunSeconds == 0 ? seconds : firstRunSeconds;
+
+        std::printf("%8u %12zu %12.0f %10.1f %10.2f %10zu %10zu %10zu %12.1f\n",
+            threadCount,
+            statistics.records,
+            static_cast<double>(statistics.records) / seconds,
+            toMiB(statistics.bytes) / seconds,
+            firstRunSeconds / seconds,
+            statistics.skippedRecords,
+            statistics.failedFiles,
+            statistics.stolenBatches,
+            toMiB(cache.bytes()));
+    }
+}
+
+// the rules are added to the writer as they are parsed and dropped right after it,
+// so only the compiled rules of the writer stay in the memory and not the parsed content of every host
+// of the several records of one origin the latest one in the archive is written, whichever thread parses it
+void writeStore(const Options& options)
+{
+    std::mutex mutex;
+    std::unordered_map<std::string, std::uint64_t> latestRecordNumbers;
+    RobotsTxtStoreWriter writer;
+
+    const RobotsTxtBulkLoader loader(loaderSettings(options, options.threadCounts.back()));
+
+    loader.load(options.inputPath, [&mutex, &latestRecordNumbers, &writer](const std::string& key, RobotsTxtRulesSnapshot rules, std::uint64_t recordNumber)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto [latestRecordNumber, isFirstRecord] = latestRecordNumbers.emplace(key, recordNumber);
+
+        if (isFirstRecord || latestRecordNumber->second < recordNumber)
+        {
+            latestRecordNumber->second = recordNumber;
+            writer.add(key, *rules);
+        }
+    });
+
+    writer.write(options.storePath);
+
+    std::printf("wrote %zu origins into %s\n", writer.size(), options.storePath.c_str());
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 1 || (argc == 2 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")))
+    {
+        std::cout << s_usage;
+        return argc == 1 ? 1 : 0;
+    }
+
+    try
+    {
+        const Options options = parseOptions(argc, argv);
+
+        reportThroughput(options);
+
+        if (!options.storePath.empty())
+        {
+            writeStore(options);
+        }
+
+        std::printf("peak RSS: %.1f MiB\n", toMiB(peakResidentSetSize()));
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "robots_ingest: " << error.what() << "\n\n" << s_usage;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,355 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "replay_corpus.h"
+#include "robots_txt_metrics.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+
+const char s_usage[] =
+    "Replays the URL checks of a log against a directory of robots.txt files.\n"
+    "\n"
+    "Usage: robots_replay --robots-dir <directory> --log <file> [options]\n"
+    "\n"
+    "  --robots-dir <directory>  robots.txt files named after their hosts, e.g. example.com.txt\n"
+    "  --log <file>              <host>\\t<url>\\t<user agent> lines, e.g. example.com\\thttps://example.com/a\\tgooglebot\n"
+    "  --threads <n,n,...>       thread counts to replay with, 1,2,4,.. up to the number of cores by default\n"
+    "  --repeat <n>              number of times every thread count replays the whole log, 1 by default\n"
+    "  --parse-times <file>      writes the parse time of every robots.txt file as CSV\n";
+
+struct Options
+{
+    std::string robotsDirectory;
+    std::string logPath;
+    std::string parseTimesPath;
+    std::vector<unsigned> threadCounts;
+    unsigned repeat = 1;
+};
+
+struct ReplayResult
+{
+    std::chrono::nanoseconds duration;
+    cpprobotparser::MetricsHistogram latencies;
+    std::uint64_t maxLatency = 0;
+    std::uint64_t allowed = 0;
+};
+
+unsigned parseUnsigned(const std::string& value)
+{
+    std::size_t end = 0;
+    const unsigned long result = std::stoul(value, &end);
+
+    if (end != value.size() || result == 0)
+    {
+        throw std::invalid_argument("Expected a positive number instead of '" + value + "'");
+    }
+
+    return static_cast<unsigned>(result);
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+
+        if (i + 1 == argc)
+        {
+            throw std::invalid_argument("No value for " + argument);
+        }
+
+        const std::string value = argv[++i];
+
+        if (argument == "--robots-dir")
+        {
+            options.robotsDirectory = value;
+        }
+        else if (argument == "--log")
+        {
+            options.logPath = value;
+        }
+        else if (argument == "--parse-times")
+        {
+            options.parseTimesPath = value;
+        }
+        else if (argument == "--repeat")
+        {
+            options.repeat = parseUnsigned(value);
+        }
+        else if (argument == "--threads")
+        {
+            std::size_t position = 0;
+
+            while (position <= value.size())
+            {
+                const std::size_t end = std::min(value.find(',', position), value.size());
+                options.threadCounts.push_back(parseUnsigned(value.substr(position, end - position)));
+                position = end + 1;
+            }
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown option " + argument);
+        }
+    }
+
+    if (options.robotsDirectory.empty() || options.logPath.empty())
+    {
+        throw std::invalid_argument("Both --robots-dir and --log are required");
+    }
+
+    if (options.threadCounts.empty())
+    {
+        const unsigned coreCount = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned threadCount = 1; threadCount < coreCount; threadCount *= 2)
+        {
+            options.threadCounts.push_back(threadCount);
+        }
+
+        options.threadCounts.push_back(coreCount);
+    }
+
+    return options;
+}
+
+// the records are taken by the threads in blocks, so the threads finish at about the same time
+ReplayResult replay(const ReplayCorpus& corpus, unsigned threadCount, unsigned repeat)
+{
+    constexpr std::size_t blockSize = 256;
+
+    const std::vector<ReplayCorpus::Record>& records = corpus.records();
+    const std::size_t checkCount = records.size() * repeat;
+
+    std::atomic<std::size_t> nextRecord(0);
+    std::atomic<unsigned> readyThreads(0);
+    std::atomic<bool> started(false);
+    std::vector<cpprobotparser::MetricsHistogram> latencies(threadCount);
+    std::vector<std::uint64_t> maxLatencies(threadCount, 0);
+    std::vector<std::uint64_t> allowed(threadCount, 0);
+    std::vector<std::thread> threads;
+
+    for (unsigned threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        threads.emplace_back([&, threadIndex]
+        {
+            cpprobotparser::MetricsHistogram threadLatencies;
+            std::uint64_t threadMaxLatency = 0;
+            std::uint64_t threadAllowed = 0;
+
+            ++readyThreads;
+
+            while (!started.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            for (;;)
+            {
+                const std::size_t begin = nextRecord.fetch_add(blockSize, std::memory_order_relaxed);
+
+                if (begin >= checkCount)
+                {
+                    break;
+                }
+
+                const std::size_t end = std::min(begin + blockSize, checkCount);
+
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    const ReplayCorpus::Record& record = records[i % records.size()];
+
+                    const auto start = std::chrono::steady_clock::now();
+                    const bool isAllowed = corpus.rules(record.rulesIndex).isUrlAllowed(record.url, record.userAgent);
+                    const auto finish = std::chrono::steady_clock::now();
+
+                    const auto latency = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count());
+
+                    threadLatencies.record(latency);
+                    threadMaxLatency = std::max(threadMaxLatency, latency);
+                    threadAllowed += isAllowed ? 1 : 0;
+                }
+            }
+
+            latencies[threadIndex] = std::move(threadLatencies);
+            maxLatencies[threadIndex] = threadMaxLatency;
+            allowed[threadIndex] = threadAllowed;
+        });
+    }
+
+    while (readyThreads.load() != threadCount)
+    {
+        std::this_thread::yield();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    started.store(true, std::memory_order_release);
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    ReplayResult result;
+    result.duration = std::chrono::steady_clock::now() - start;
+
+    for (unsigned threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        result.latencies.merge(latencies[threadIndex]);
+        result.maxLatency = std::max(result.maxLatency, maxLatencies[threadIndex]);
+        result.allowed += allowed[threadIndex];
+    }
+
+    return result;
+}
+
+// the peak resident set size of the process in bytes
+std::size_t peakResidentSetSize()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double toMiB(std::size_t bytes)
+{
+    return static_cast<double>(bytes) / (1024 * 1024);
+}
+
+double toMicroseconds(std::chrono::nanoseconds duration)
+{
+    return static_cast<double>(duration.count()) / 1000;
+}
+
+void reportParsing(const ReplayCorpus& corpus, const std::string& parseTimesPath)
+{
+    const std::vector<ReplayCorpus::File>& files = corpus.files();
+
+    std::vector<std::chrono::nanoseconds> parseTimes;
+    std::chrono::nanoseconds totalParseTime(0);
+    std::size_t totalBytes = 0;
+    std::size_t totalMemoryUsage = 0;
+
+    for (const ReplayCorpus::File& file : files)
+    {
+        parseTimes.push_back(file.parseTime);
+        totalParseTime += file.parseTime;
+        totalBytes += file.bytes;
+        totalMemoryUsage += file.memoryUsage;
+    }
+
+    std::sort(parseTimes.begin(), parseTimes.end());
+
+    const auto parseTimeAt = [&parseTimes](double quantile)
+    {
+        return parseTimes.empty() ? 0.0 : toMicroseconds(parseTimes[static_cast<std::size_t>(quantile * static_cast<double>(parseTimes.size() - 1))]);
+    };
+
+    std::printf("parsed %zu robots.txt files, %.1f MiB in %.1f ms, %.1f MiB of rules\n",
+        files.size(), toMiB(totalBytes), toMicroseconds(totalParseTime) / 1000, toMiB(totalMemoryUsage));
+
+    std::printf("parse time per file: p50 %.1f us, p99 %.1f us, max %.1f us\n", parseTimeAt(0.5), parseTimeAt(0.99), parseTimeAt(1));
+
+    if (parseTimesPath.empty())
+    {
+        return;
+    }
+
+    std::ofstream parseTimesFile(parseTimesPath);
+
+    if (!parseTimesFile)
+    {
+        throw std::runtime_error("Can't write " + parseTimesPath);
+    }
+
+    parseTimesFile << "host,bytes,parse_ns,memory_bytes\n";
+
+    for (const ReplayCorpus::File& file : files)
+    {
+        parseTimesFile << file.host << ',' << file.bytes << ',' << file.parseTime.count() << ',' << file.memoryUsage << '\n';
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 1 || (argc == 2 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")))
+    {
+        std::cout << s_usage;
+        return argc == 1 ? 1 : 0;
+    }
+
+    try
+    {
+        const Options options = parseOptions(argc, argv);
+
+        ReplayCorpus corpus;
+        corpus.loadRobotsTxtDirectory(options.robotsDirectory);
+        corpus.loadLog(options.logPath);
+
+        reportParsing(corpus, options.parseTimesPath);
+
+        std::printf("replaying %zu records, %zu without robots.txt, %zu malformed lines skipped\n",
+            corpus.records().size(), corpus.recordsWithoutRobotsTxt(), corpus.malformedLines());
+
+        if (corpus.records().empty())
+        {
+            return 0;
+        }
+
+        std::printf("%8s %14s %10s %10s %10s %10s %12s\n", "threads", "checks/s", "p50 ns", "p99 ns", "p999 ns", "max ns", "allowed");
+
+        for (const unsigned threadCount : options.threadCounts)
+        {
+            const ReplayResult result = replay(corpus, threadCount, options.repeat);
+            const double seconds = std::chrono::duration<double>(result.duration).count();
+
+            std::printf("%8u %14.0f %10llu %10llu %10llu %10llu %12llu\n",
+                threadCount,
+                static_cast<double>(result.latencies.count) / seconds,
+                static_cast<unsigned long long>(result.latencies.quantile(0.5)),
+                static_cast<unsigned long long>(result.latencies.quantile(0.99)),
+                static_cast<unsigned long long>(result.latencies.quantile(0.999)),
+                static_cast<unsigned long long>(result.maxLatency),
+                static_cast<unsigned long long>(result.allowed));
+        }
+
+        std::printf("peak RSS: %.1f MiB\n", toMiB(peakResidentSetSize()));
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "robots_replay: " << error.what() << "\n\n" << s_usage;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+﻿#include "replay_corpus.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace cpprobotparser;
+
+namespace
+{
+
+std::string lowercased(std::string_view value)
+{
+    std::string result(value);
+
+    for (char& ch : result)
+    {
+        ch = ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+    }
+
+    return result;
+}
+
+std::string readFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file)
+    {
+        throw std::runtime_error("Can't read " + path.string());
+    }
+
+    std::ostringstream content;
+    content << file.rdbuf();
+
+    return content.str();
+}
+
+}
+
+ReplayCorpus::ReplayCorpus()
+    : m_rules(1)
+    , m_recordsWithoutRobotsTxt(0)
+    , m_malformedLines(0)
+{
+}
+
+void ReplayCorpus::loadRobotsTxtDirectory(const std::string& directoryPath)
+{
+    std::error_code error;
+    std::filesystem::directory_iterator directoryIterator(directoryPath, error);
+
+    if (error)
+    {
+        throw std::runtime_error("Can't read the directory " + directoryPath + ": " + error.message());
+    }
+
+    std::vector<std::filesystem::path> paths;
+
+    for (const std::filesystem::directory_entry& entry : directoryIterator)
+    {
+        if (entry.is_regular_file())
+        {
+            paths.push_back(entry.path());
+        }
+    }
+
+    // the same order on every run
+    std::sort(paths.begin(), paths.end());
+
+    // the empty rules stay the last ones
+    std::vector<RobotsTxtRules> rules(paths.size());
+
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        const std::filesystem::path& path = paths[i];
+        const std::string content = readFile(path);
+        const std::string host = lowercased(path.extension() == ".txt" ? path.stem().string() : path.filename().string());
+
+        const auto start = std::chrono::steady_clock::now();
+        rules[i].parse(content);
+        const auto parseTime = std::chrono::steady_clock::now() - start;
+
+        m_rulesIndexByHost[host] = static_cast<std::uint32_t>(i);
+        m_files.push_back(File{ host, content.size(), std::chrono::duration_cast<std::chrono::nanoseconds>(parseTime), rules[i].memoryUsage() });
+    }
+
+    rules.emplace_back();
+    m_rules = std::move(rules);
+}
+
+void ReplayCorpus::loadLog(const std::string& logPath)
+{
+    std::ifstream log(logPath, std::ios::binary);
+
+    if (!log)
+    {
+        throw std::runtime_error("Can't read " + logPath);
+    }
+
+    const std::uint32_t emptyRulesIndex = static_cast<std::uint32_t>(m_rules.size() - 1);
+    std::string line;
+
+    while (std::getline(log, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        if (line.empty() || line.front() == '#')
+        {
+            continue;
+        }
+
+        const std::size_t urlPosition = line.find('\t');
+        const std::size_t userAgentPosition = urlPosition == std::string::npos ? std::string::npos : line.find('\t', urlPosition + 1);
+
+        if (userAgentPosition == std::string::npos)
+        {
+            ++m_malformedLines;
+            continue;
+        }
+
+        const std::string host = lowercased(std::string_view(line).substr(0, urlPosition));
+        const auto rulesIterator = m_rulesIndexByHost.find(host);
+
+        if (rulesIterator == m_rulesIndexByHost.end())
+        {
+            ++m_recordsWithoutRobotsTxt;
+        }
+
+        m_records.push_back(Record
+        {
+            rulesIterator == m_rulesIndexByHost.end() ? emptyRulesIndex : rulesIterator->second,
+            line.substr(urlPosition + 1, userAgentPosition - urlPosition - 1),
+            line.substr(userAgentPosition + 1)
+        });
+    }
+}
+
+const std::vector<ReplayCorpus::File>& ReplayCorpus::files() const noexcept
+{
+    return m_files;
+}
+
+const std::vector<ReplayCorpus::Record>& ReplayCorpus::records() const noexcept
+{
+    return m_records;
+}
+
+const RobotsTxtRules& ReplayCorpus::rules(std::uint32_t rulesIndex) const noexcept
+{
+    return m_rules[rulesIndex];
+}
+
+std::size_t ReplayCorpus::recordsWithoutRobotsTxt() const noexcept
+{
+    return m_recordsWithoutRobotsTxt;
+}
+
+std::size_t ReplayCorpus::malformedLines() const noexcept
+{
+    return m_malformedLines;
+}
\ No newline at end of file
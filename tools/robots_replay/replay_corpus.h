@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "robots_txt_rules.h"
+
+//! The robots.txt files of many hosts and the log of the checks to replay against them.
+//! The hosts without a robots.txt file get the empty rules which allow everything,
+//! so every record of the log goes through RobotsTxtRules::isUrlAllowed.
+class ReplayCorpus final
+{
+public:
+    struct File
+    {
+        std::string host;
+        std::size_t bytes;
+        std::chrono::nanoseconds parseTime;
+        std::size_t memoryUsage;
+    };
+
+    struct Record
+    {
+        std::uint32_t rulesIndex;
+        std::string url;
+        std::string userAgent;
+    };
+
+    ReplayCorpus();
+
+    //! Parses every file of the directory, the file name without the ".txt" extension is the host, e.g. "example.com.txt".
+    //! Throws std::runtime_error if the directory can't be read.
+    void loadRobotsTxtDirectory(const std::string& directoryPath);
+
+    //! Reads the log of "<host>\t<url>\t<user agent>" lines, the empty lines and the ones starting with '#' are skipped.
+    //! Throws std::runtime_error if the file can't be read.
+    void loadLog(const std::string& logPath);
+
+    const std::vector<File>& files() const noexcept;
+    const std::vector<Record>& records() const noexcept;
+    const cpprobotparser::RobotsTxtRules& rules(std::uint32_t rulesIndex) const noexcept;
+
+    //! returns the number of the records which hosts have no robots.txt file
+    std::size_t recordsWithoutRobotsTxt() const noexcept;
+
+    //! returns the number of the log lines without three fields
+    std::size_t malformedLines() const noexcept;
+
+private:
+    // the last rules are the empty ones for the hosts without robots.txt
+    std::vector<cpprobotparser::RobotsTxtRules> m_rules;
+    std::unordered_map<std::string, std::uint32_t> m_rulesIndexByHost;
+
+    std::vector<File> m_files;
+    std::vector<Record> m_records;
+    std::size_t m_recordsWithoutRobotsTxt;
+    std::size_t m_malformedLines;
+};
\ No newline at end of file